@@ -21,6 +21,11 @@ endif()
 
 add_definitions(-DSPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_${CORC_LOGGING_LEVEL})
 
+#CAN frames capture to logs/CORC_can_capture.bin (see CO_canCapture.h)
+if(CAN_CAPTURE)
+    add_definitions(-DCO_LOG_CAN_MESSAGES)
+endif()
+
 #######################
 
 ## Compile as C++14
@@ -230,5 +235,10 @@ elseif(ROS EQUAL 2)
     ament_package()
 endif()
 
+## Standalone tools (benchmarks, CAN utilities)
+if(BUILD_TOOLS)
+    add_subdirectory(src/tools)
+endif()
+
 
 message("-----------------------------------------------\nBuilding application ${APP_NAME}\n-----------------------------------------------")
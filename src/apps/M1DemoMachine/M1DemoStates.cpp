@@ -32,13 +32,18 @@ void IdleState::exit(void) {
 void Calibration::entry(void) {
     spdlog::info("Starting Calibration: Position and Force Zeroing");
     robot->applyCalibration();
-    robot->initVelocityControl();
+    robot->switchControlMode(CM_VELOCITY_CONTROL);
     robot->calibrateForceSensors();
     cal_velocity = -20;   // degree per second
     stages = 1;
 }
 
 void Calibration::during(void) {
+    // Drives configured on the SDO worker thread: wait for the stage control mode
+    if(robot->switchControlMode(stages == 1 ? CM_VELOCITY_CONTROL : CM_POSITION_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
+
     // Two stage calibration
     if(stages == 1){
         // Stage 1: Position Homing (zeroing)
@@ -55,7 +60,7 @@ void Calibration::during(void) {
         if ((dq(0) <= 2) & (tau(0) >= 1.5)){
             cal_velocity = 0;
             robot->applyCalibration();
-            robot->initPositionControl();
+            robot->switchControlMode(CM_POSITION_CONTROL);
             stages = 2;
             spdlog::info("Position Homing Complete. Starting Force Sensor Calibration");
         }
@@ -130,6 +135,11 @@ void M1DemoState::duringCode(void) {
     if(iterations()%500==1) {
         robot->printJointStatus();
     }
+
+    // Drives configured on the SDO worker thread: wait for the demo mode control mode (failure logged, retried every second)
+    if(robot->switchControlMode(controlMode, 1.)!=CMT_DONE) {
+        return;
+    }
     counter = counter + 1;
 
     if(robot->status != R_SUCCESS){
@@ -184,27 +194,31 @@ void M1DemoState::initMode(int mode_t){
     switch(mode_t){
         case 1:
             std::cout << "Demo position tracking!" << std::endl;
-            robot->initPositionControl();
+            controlMode = CM_POSITION_CONTROL;
+            robot->switchControlMode(controlMode);
             freq = 0.5;
             counter = 1;
             magnitude = 20;
             break;
         case 2:
             std::cout << "Demo velocity tracking!" << std::endl;
-            robot->initVelocityControl();
+            controlMode = CM_VELOCITY_CONTROL;
+            robot->switchControlMode(controlMode);
             freq = 0.5;
             magnitude = 20;   // degree per second
             break;
         case 3:
             std::cout << "Demo torque tracking!" << std::endl;
-            robot->initTorqueControl();
+            controlMode = CM_TORQUE_CONTROL;
+            robot->switchControlMode(controlMode);
             freq = 0.5;
             magnitude = 1.0;   // torque magnitude
             step = 0.1;
             break;
         case 4:
             std::cout << "Demo admittance control!" << std::endl;
-            robot->initVelocityControl();
+            controlMode = CM_VELOCITY_CONTROL;
+            robot->switchControlMode(controlMode);
             robot->m1ForceSensor->calibrate();
             Ks = 0;
             B = 0.01;
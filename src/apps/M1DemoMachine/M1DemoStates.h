@@ -166,6 +166,7 @@ public:
     double counter;
     bool status = true;
     int mode = 1;   // 1 for position control; 2 for velocity control; 3 for torque control; 4 for admittance control
+    ControlMode controlMode = CM_POSITION_CONTROL;  // drives control mode of the current demo mode
     int sub_mode = 1;
     int cycle = 0;
     bool dir = true;
@@ -18,7 +18,8 @@ void MultiControllerState::entry(void) {
     f = boost::bind(&MultiControllerState::dynReconfCallback, this, _1, _2);
     server_.setCallback(f);
 
-    robot_->initTorqueControl();
+    controlMode_ = CM_TORQUE_CONTROL;
+    robot_->switchControlMode(controlMode_);
     robot_->applyCalibration();
     robot_->calibrateForceSensors();
     robot_->tau_spring[0] = 0;   // for ROS publish only
@@ -56,6 +57,11 @@ void MultiControllerState::during(void) {
     dt = now - lastTime;
     lastTime = now;
 
+    // Drives configured on the SDO worker thread: wait for the controller control mode
+    if(robot_->switchControlMode(controlMode_, 1.)!=CMT_DONE) {
+        return;
+    }
+
     tick_count = tick_count + 1;
     if(controller_mode_ == 0){  // Homing
         if(cali_stage == 1){
@@ -72,7 +78,8 @@ void MultiControllerState::during(void) {
             if ((dq(0) <= 2) & (tau(0) >= 2)){
                 cali_velocity = 0;
                 robot_->applyCalibration();
-                robot_->initPositionControl();
+                controlMode_ = CM_POSITION_CONTROL;
+                robot_->switchControlMode(controlMode_);
                 cali_stage = 2;
             }
             else {
@@ -238,16 +245,17 @@ void MultiControllerState::dynReconfCallback(CORC::dynamic_paramsConfig &config,
     if(controller_mode_!=config.controller_mode)
     {
         controller_mode_ = config.controller_mode;
+        // Drives control mode changed by during() (non-blocking)
         if(controller_mode_ == 0) {
-            robot_->initVelocityControl();
+            controlMode_ = CM_VELOCITY_CONTROL;
             cali_stage = 1;
             cali_velocity = -30;
         }
-        if(controller_mode_ == 1) robot_->initTorqueControl();
-        if(controller_mode_ == 2) robot_->initPositionControl();
-        if(controller_mode_ == 3) robot_->initTorqueControl();
-        if(controller_mode_ == 4) robot_->initTorqueControl();
-        if(controller_mode_ == 5) robot_->initTorqueControl();
+        if(controller_mode_ == 1) controlMode_ = CM_TORQUE_CONTROL;
+        if(controller_mode_ == 2) controlMode_ = CM_POSITION_CONTROL;
+        if(controller_mode_ == 3) controlMode_ = CM_TORQUE_CONTROL;
+        if(controller_mode_ == 4) controlMode_ = CM_TORQUE_CONTROL;
+        if(controller_mode_ == 5) controlMode_ = CM_TORQUE_CONTROL;
 
         if(controller_mode_ == 11) time0 = std::chrono::steady_clock::now();
         if(controller_mode_ == 11) robot_->setDigitalOut(0);
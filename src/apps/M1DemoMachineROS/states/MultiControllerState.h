@@ -47,6 +47,7 @@ public:
     double spk_;
     double ffRatio_;
     int controller_mode_;
+    ControlMode controlMode_;   // drives control mode of the controller mode (see switchControlMode())
 
     double control_freq;
     int current_mode;
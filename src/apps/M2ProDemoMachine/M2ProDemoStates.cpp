@@ -29,7 +29,7 @@ void M2DemoState::entryCode(void) {
     //robot->applyCalibration();
     //robot->initPositionControl();
     //robot->initVelocityControl();
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     qi=robot->getPosition();
     Xi=robot->getEndEffPosition();
     //robot->setJointVelocity(VM2::Zero());
@@ -38,6 +38,10 @@ void M2DemoState::entryCode(void) {
     tau = VM2::Zero();
 }
 void M2DemoState::duringCode(void) {
+    //Drives configured on the SDO worker thread: wait for torque control
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
     if(iterations()%100==1) {
         //std::cout << "Doing nothing for "<< elapsedTime << "s..." << std::endl;
         std::cout << running() << " ";
@@ -95,12 +99,17 @@ void M2CalibState::entryCode(void) {
         at_stop[i] = false;
     }
     robot->decalibrate();
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     robot->printJointStatus();
     std::cout << "Calibrating (keep clear)..." << std::flush;
 }
 //Move slowly on each joint until max force detected
 void M2CalibState::duringCode(void) {
+    //Wait for torque control (not moving until then: would be detected as a stop)
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
+
     VM2 tau(0, 0);
 
     //Apply constant torque (with damping) unless stop has been detected for more than 0.5s
@@ -143,9 +152,12 @@ void M2CalibState::exitCode(void) {
 
 
 void M2Transparent::entryCode(void) {
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
 }
 void M2Transparent::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Apply corresponding force
     robot->setEndEffForceWithCompensation(VM2::Zero(), true);
@@ -161,9 +173,12 @@ void M2Transparent::exitCode(void) {
 
 
 void M2EndEffDemo::entryCode(void) {
-    robot->initVelocityControl();
+    robot->switchControlMode(CM_VELOCITY_CONTROL);
 }
 void M2EndEffDemo::duringCode(void) {
+    if(robot->switchControlMode(CM_VELOCITY_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Joystick driven
     VM2 dXd = VM2::Zero();
@@ -185,11 +200,13 @@ void M2EndEffDemo::exitCode(void) {
 
 
 void M2DemoPathState::entryCode(void) {
-    robot->initTorqueControl();
-    robot->setEndEffForceWithCompensation(VM2::Zero(), false);
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     Xi=robot->getEndEffPosition();
 }
 void M2DemoPathState::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
     //TODO: TBD
 }
 void M2DemoPathState::exitCode(void) {
@@ -199,8 +216,7 @@ void M2DemoPathState::exitCode(void) {
 
 void M2DemoMinJerkPosition::entryCode(void) {
     //Setup velocity control for position over velocity loop
-    robot->initVelocityControl();
-    robot->setJointVelocity(VM2::Zero());
+    robot->switchControlMode(CM_VELOCITY_CONTROL);
     //Initialise to first target point
     TrajPtIdx=0;
     startTime=running();
@@ -210,6 +226,11 @@ void M2DemoMinJerkPosition::entryCode(void) {
     k_i=1.;
 }
 void M2DemoMinJerkPosition::duringCode(void) {
+    //Start the trajectory once in velocity control
+    if(robot->switchControlMode(CM_VELOCITY_CONTROL, 1.)!=CMT_DONE) {
+        startTime=running();
+        return;
+    }
 
     VM2 Xd, dXd;
     //Compute current desired interpolated point
@@ -35,12 +35,15 @@ void M3DemoState::entryCode(void) {
     //robot->setJointVelocity(VM3::Zero());
     //robot->setEndEffForceWithCompensation(VM3::Zero(), false);
     robot->printJointStatus();
-    robot->initTorqueControl();
-    robot->setJointTorque(VM3(0,0,0));
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     tau = VM3(0,0,0);
     lock = false;
 }
 void M3DemoState::duringCode(void) {
+    //Drives configured on the SDO worker thread: wait for torque control
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
     if(iterations()%1000==1) {
         //std::cout << "Doing nothing for "<< elapsedTime << "s..." << std::endl;
         std::cout << running() << " ";
@@ -136,12 +139,17 @@ void M3CalibState::entryCode(void) {
         at_stop[i] = false;
     }
     robot->decalibrate();
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     robot->printJointStatus();
     std::cout << "Calibrating (keep clear)..." << std::flush;
 }
 //Move slowly on each joint until max force detected
 void M3CalibState::duringCode(void) {
+    //Wait for torque control (not moving until then: would be detected as a stop)
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
+
     VM3 tau(0, 0, 0);
 
     //Apply constant torque (with damping) unless stop has been detected for more than 0.5s
@@ -183,10 +191,13 @@ void M3CalibState::exitCode(void) {
 
 
 void M3MassCompensation::entryCode(void) {
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     std::cout << "Press S to decrease mass (-100g), W to increase (+100g)." << std::endl;
 }
 void M3MassCompensation::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Smooth transition in case a mass is set at startup
     double settling_time = 3.0;
@@ -222,9 +233,12 @@ void M3MassCompensation::exitCode(void) {
 
 
 void M3EndEffDemo::entryCode(void) {
-    robot->initVelocityControl();
+    robot->switchControlMode(CM_VELOCITY_CONTROL);
 }
 void M3EndEffDemo::duringCode(void) {
+    if(robot->switchControlMode(CM_VELOCITY_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Joystick driven
     VM3 dXd(0,0,0);
@@ -247,11 +261,14 @@ void M3EndEffDemo::exitCode(void) {
 
 
 void M3DemoImpedanceState::entryCode(void) {
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     init=false;
     std::cout << "Press X to select reference point, S/W to tune K gain and A/D for D gain" << std::endl;
 }
 void M3DemoImpedanceState::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Select start point
     if(robot->keyboard->getX()) {
@@ -304,10 +321,13 @@ void M3DemoImpedanceState::exitCode(void) {
 
 
 void M3TeleopState::entryCode(void) {
-    robot->initTorqueControl();
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     Xi=robot->getEndEffPosition();
 }
 void M3TeleopState::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
 
     //Select start point
     std::vector<double> f_tmp(3);
@@ -333,11 +353,14 @@ void M3TeleopState::exitCode(void) {
 
 
 void M3DemoPathState::entryCode(void) {
-    robot->initTorqueControl();
-    robot->setEndEffForceWithCompensation(VM3::Zero(), false);
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     Xi=robot->getEndEffPosition();
 }
 void M3DemoPathState::duringCode(void) {
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)!=CMT_DONE) {
+        return;
+    }
+
     VM3 X=robot->getEndEffPosition();
     VM3 dX=robot->getEndEffVelocity();
     VM3 Xd=Xi;
@@ -401,13 +424,14 @@ void M3DemoPathState::exitCode(void) {
 
 
 void M3SamplingEstimationState::entryCode(void) {
-    robot->initTorqueControl();
-    robot->setEndEffForceWithCompensation(VM3::Zero());
+    robot->switchControlMode(CM_TORQUE_CONTROL);
     std::cout << "Move robot around while estimating time" << std::endl;
 }
 void M3SamplingEstimationState::duringCode(void) {
-    //Apply gravity compensation
-    robot->setEndEffForceWithCompensation(VM3::Zero());
+    //Apply gravity compensation (once in torque control, sampling goes on meanwhile)
+    if(robot->switchControlMode(CM_TORQUE_CONTROL, 1.)==CMT_DONE) {
+        robot->setEndEffForceWithCompensation(VM3::Zero());
+    }
 
     //Save dt
     if(iterations()>1 && iterations()<nb_samples+2) {
@@ -447,8 +471,7 @@ void M3SamplingEstimationState::exitCode(void) {
 
 void M3DemoMinJerkPosition::entryCode(void) {
     //Setup velocity control for position over velocity loop
-    robot->initVelocityControl();
-    robot->setJointVelocity(VM3::Zero());
+    robot->switchControlMode(CM_VELOCITY_CONTROL);
     //Initialise to first target point
     TrajPtIdx=0;
     startTime=running();
@@ -458,6 +481,11 @@ void M3DemoMinJerkPosition::entryCode(void) {
     k_i=1.;
 }
 void M3DemoMinJerkPosition::duringCode(void) {
+    //Start the trajectory once in velocity control
+    if(robot->switchControlMode(CM_VELOCITY_CONTROL, 1.)!=CMT_DONE) {
+        startTime=running();
+        return;
+    }
 
     VM3 Xd, dXd;
     //Compute current desired interpolated point
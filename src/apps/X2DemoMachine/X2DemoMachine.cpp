@@ -73,7 +73,12 @@ void X2DemoMachine::init() {
 }
 
 void X2DemoMachine::end() {
-    robot()->initTorqueControl();
+    // Control loop is over: wait for the torque control switch, through the SDO worker thread
+    // as the control mode changes of the state (completing a pending one first)
+    robot()->clearControlModeFailure();
+    while (robot()->switchControlMode(CM_TORQUE_CONTROL) == CMT_PENDING) {
+        usleep(1000);
+    }
     // setting 0 torque for safety.
     robot()->setTorque(Eigen::VectorXd::Zero(X2_NUM_JOINTS));
 }
@@ -108,10 +108,13 @@ ros::NodeHandle & X2DemoMachineROS::getNodeHandle() {
 
 bool X2DemoMachineROS::calibrateForceSensorsCallback(std_srvs::Trigger::Request &req, std_srvs::Trigger::Response &res) {
 
-    bool success = true;
+    // Internal calibration of all sensors at once (each one waits ~1.5s after its SDO)
+    std::vector<std::function<bool()>> sequences;
     for(int id = 0; id < X2_NUM_FORCE_SENSORS + X2_NUM_GRF_SENSORS; id++){
-        success = success & robot_->forceSensors[id]->sendInternalCalibrateSDOMessage();
+        FourierForceSensor *sensor = robot_->forceSensors[id];
+        sequences.push_back([sensor] { return sensor->sendInternalCalibrateSDOMessage(); });
     }
+    bool success = sdoRunParallel(sequences);
 
     success = success & robot_->calibrateForceSensors();
     res.success = success;
@@ -26,11 +26,27 @@ void X2DemoState::entry(void) {
 }
 
 void X2DemoState::during(void) {
-
+    // Control mode of the controller: velocity for 2 and 4, torque otherwise
+    ControlMode controlMode = (controller_mode_ == 2 || controller_mode_ == 4) ? CM_VELOCITY_CONTROL : CM_TORQUE_CONTROL;
 #ifndef SIM
     // GREEN BUTTON IS THE DEAD MAN SWITCH --> if it is not pressed, all motor torques are set to 0. Except controller 2 which sets 0 velocity
-    if(robot_->getButtonValue(ButtonColor::GREEN) == 0 && controller_mode_ !=2){
-        if(robot_->getControlMode()!=CM_TORQUE_CONTROL) robot_->initTorqueControl();
+    bool deadManReleased = robot_->getButtonValue(ButtonColor::GREEN) == 0 && controller_mode_ !=2;
+    if(deadManReleased) {
+        controlMode = CM_TORQUE_CONTROL;
+    }
+#endif
+
+    // Non-blocking control mode change (failure logged, retried every second): until all the drives are in the
+    // controller mode, commands of that mode are rejected, so hold 0 in the mode each joint is still in.
+    if(robot_->switchControlMode(controlMode, 1.)!=CMT_DONE) {
+        desiredJointTorques_ = Eigen::VectorXd::Zero(X2_NUM_JOINTS);
+        desiredJointVelocities_ = Eigen::VectorXd::Zero(X2_NUM_JOINTS);
+        robot_->setZeroCommand();
+        return;
+    }
+
+#ifndef SIM
+    if(deadManReleased) {
         desiredJointTorques_ = Eigen::VectorXd::Zero(X2_NUM_JOINTS);
         robot_->setTorque(desiredJointTorques_);
 
@@ -39,23 +55,14 @@ void X2DemoState::during(void) {
 #endif
 
     if(controller_mode_ == 1){ // zero torque mode
-
-        if(robot_->getControlMode()!=CM_TORQUE_CONTROL){
-            robot_->initTorqueControl();
-        }
-
         desiredJointTorques_ = Eigen::VectorXd::Zero(X2_NUM_JOINTS);
         robot_->setTorque(desiredJointTorques_);
 
     } else if(controller_mode_ == 2){ // zero velocity mode
-        if(robot_->getControlMode()!=CM_VELOCITY_CONTROL) robot_->initVelocityControl();
-
         desiredJointVelocities_ = Eigen::VectorXd::Zero(X2_NUM_JOINTS);
         robot_->setVelocity(desiredJointVelocities_);
 
     } else if(controller_mode_ == 3){ // " a very simple (and not ideal) transparent controller"
-        if(robot_->getControlMode()!=CM_TORQUE_CONTROL) robot_->initTorqueControl();
-
         std::cout<<"force: "<<robot_->getSmoothedInteractionForce()[2]<<std::endl;
         std::cout<<"multiplied: "<<kTransperancy_.asDiagonal()*robot_->getSmoothedInteractionForce()<<std::endl;
         desiredJointTorques_ = robot_->getPseudoInverseOfSelectionMatrixTranspose()*
@@ -67,8 +74,6 @@ void X2DemoState::during(void) {
         robot_->setTorque(desiredJointTorques_);
 
     } else if(controller_mode_ == 4){ // sin vel
-        if(robot_->getControlMode()!=CM_VELOCITY_CONTROL) robot_->initVelocityControl();
-
         double time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - time0).count()/1000.0;
         for(int joint = 0; joint < X2_NUM_JOINTS; joint++)
         {
@@ -78,8 +83,6 @@ void X2DemoState::during(void) {
         robot_->setVelocity(desiredJointVelocities_);
 
     } else if(controller_mode_ == 5){ // sin torque
-        if(robot_->getControlMode()!=CM_TORQUE_CONTROL) robot_->initTorqueControl();
-
         double time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - time0).count()/1000.0;
         for(int joint = 0; joint < X2_NUM_JOINTS; joint++)
         {
@@ -91,9 +94,8 @@ void X2DemoState::during(void) {
 }
 
 void X2DemoState::exit(void) {
-    robot_->initTorqueControl();
-    // setting 0 torque for safety.
-    robot_->setTorque(Eigen::VectorXd::Zero(X2_NUM_JOINTS));
+    // setting 0 command for safety (no blocking mode change here, see X2DemoMachine::end())
+    robot_->setZeroCommand();
     std::cout << "Example State Exited" << std::endl;
 }
 
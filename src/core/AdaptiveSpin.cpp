@@ -0,0 +1,66 @@
+#include "AdaptiveSpin.h"
+
+#include <string.h>
+
+AdaptiveSpin::AdaptiveSpin(long maxSpin_ns, bool adaptive, long minSpin_ns, long margin_ns, double percentile, unsigned int window)
+    : maxSpin(maxSpin_ns), minSpin(minSpin_ns < maxSpin_ns ? minSpin_ns : maxSpin_ns), margin(margin_ns), adaptive(adaptive),
+      percentile(percentile), window(window > 0 ? window : 1), spin(maxSpin_ns) {
+}
+
+unsigned int AdaptiveSpin::bin(long ns) {
+    long us = ns / 1000;
+    if (us < 0) {
+        return 0;
+    }
+    return us < ADAPTIVE_SPIN_HIST_BINS ? us : ADAPTIVE_SPIN_HIST_BINS - 1;
+}
+
+void AdaptiveSpin::sleepOvershoot(long overshoot_ns) {
+    if (!adaptive) {
+        return;
+    }
+    // Late wake-up: widen the window now rather than at the end of the window
+    if (overshoot_ns + margin > spin) {
+        spin = (overshoot_ns + margin < maxSpin) ? overshoot_ns + margin : maxSpin;
+    }
+
+    overshootHist[bin(overshoot_ns)]++;
+    if (++noOvershoots < window) {
+        return;
+    }
+    // End of window: spin window from the overshoots percentile (upper bound of its bin)
+    uint32_t target = (uint32_t)(percentile * noOvershoots);
+    uint32_t count = 0;
+    unsigned int b = 0;
+    for (; b < ADAPTIVE_SPIN_HIST_BINS - 1; b++) {
+        count += overshootHist[b];
+        if (count > target) {
+            break;
+        }
+    }
+    long newSpin = (b + 1) * 1000L + margin;
+    spin = newSpin < minSpin ? minSpin : (newSpin > maxSpin ? maxSpin : newSpin);
+    memset(overshootHist, 0, sizeof(overshootHist));
+    noOvershoots = 0;
+}
+
+void AdaptiveSpin::periodEnd(long spun_ns, long lateness_ns) {
+    noPeriods++;
+    spunTotal_ns += spun_ns > 0 ? spun_ns : 0;
+    latenessHist[bin(lateness_ns)]++;
+    if (lateness_ns > maxLateness_ns) {
+        maxLateness_ns = lateness_ns;
+    }
+}
+
+double AdaptiveSpin::latenessPercentile_us(double p) const {
+    uint64_t target = (uint64_t)(p * noPeriods);
+    uint64_t count = 0;
+    for (unsigned int b = 0; b < ADAPTIVE_SPIN_HIST_BINS; b++) {
+        count += latenessHist[b];
+        if (count > target) {
+            return b;
+        }
+    }
+    return ADAPTIVE_SPIN_HIST_BINS - 1;
+}
@@ -0,0 +1,80 @@
+/**
+ * \file AdaptiveSpin.h
+ * \brief Active wait (busy spin) window at the end of a periodic loop, sized online to the measured sleep
+ * wake-up overshoot.
+ *
+ * The loop sleeps until (end of period - spinTime()) and busy waits the rest of the period. The spin window only
+ * needs to cover the wake-up overshoot of the sleep: AdaptiveSpin keeps it to a high percentile of the overshoots
+ * of the last window of periods plus a margin, raised immediately on a larger overshoot. Not thread safe: used by
+ * the loop thread only.
+ *
+ * \version 0.1
+ *
+ */
+#ifndef ADAPTIVESPIN_H_INCLUDED
+#define ADAPTIVESPIN_H_INCLUDED
+
+#include <stdint.h>
+
+#define ADAPTIVE_SPIN_HIST_BINS 2000 /*!< Histograms resolution: 1us bins, larger values in the last one */
+
+class AdaptiveSpin {
+   public:
+    /**
+     * \param maxSpin_ns Maximum (and fixed if not adaptive) spin window
+     * \param adaptive false for a fixed spin window of maxSpin_ns
+     * \param minSpin_ns Minimum spin window
+     * \param margin_ns Added to the overshoot percentile
+     * \param percentile Overshoot percentile covered by the spin window (e.g. 0.999)
+     * \param window Number of periods over which the percentile is computed
+     */
+    AdaptiveSpin(long maxSpin_ns, bool adaptive = true, long minSpin_ns = 20000, long margin_ns = 20000,
+                 double percentile = 0.999, unsigned int window = 1000);
+
+    /**
+     * \brief Current spin window (ns): time before the end of the period at which the loop should wake up
+     */
+    long spinTime() const { return spin; }
+
+    /**
+     * \brief Records the wake-up overshoot of the sleep (ns, actual wake-up - requested wake-up)
+     *
+     * Only for actual sleeps: not after an overrun (requested wake-up already passed when going to sleep).
+     */
+    void sleepOvershoot(long overshoot_ns);
+
+    /**
+     * \brief Records the end of a period
+     *
+     * \param spun_ns Time spent busy waiting in this period
+     * \param lateness_ns End of the wait - end of the period (jitter of the period end)
+     */
+    void periodEnd(long spun_ns, long lateness_ns);
+
+    /**
+     * \brief Statistics since construction
+     */
+    uint64_t periods() const { return noPeriods; }
+    double averageSpin_us() const { return noPeriods > 0 ? spunTotal_ns / 1000. / noPeriods : 0; }
+    double latenessPercentile_us(double p) const;
+    double maxLateness_us() const { return maxLateness_ns / 1000.; }
+
+   private:
+    static unsigned int bin(long ns);
+
+    long maxSpin, minSpin, margin;
+    bool adaptive;
+    double percentile;
+    unsigned int window;
+    long spin;
+
+    uint32_t overshootHist[ADAPTIVE_SPIN_HIST_BINS] = {0};  // Current window
+    unsigned int noOvershoots = 0;
+
+    uint32_t latenessHist[ADAPTIVE_SPIN_HIST_BINS] = {0};
+    uint64_t noPeriods = 0;
+    uint64_t spunTotal_ns = 0;
+    long maxLateness_ns = 0;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "BusLoadPlanner.h"
+
+#include "logging.h"
+
+std::map<UNSIGNED32, UNSIGNED8> BusLoadPlanner::expectedTransmissionTypes;
+
+namespace {
+//Data length of a PDO, from its mapping parameter (lengths in bits)
+unsigned int payloadBytes(UNSIGNED8 numberOfMappedObjects, const UNSIGNED32 *mappedObjects) {
+    unsigned int bits = 0;
+    for (unsigned int i = 0; i < numberOfMappedObjects && i < 8; i++) {
+        bits += mappedObjects[i] & 0xFF;
+    }
+    return bits > 64 ? 8 : (bits + 7) / 8;
+}
+}  // namespace
+
+unsigned int BusLoadPlanner::frameBits(unsigned int payload) {
+    if (payload > 8) {
+        payload = 8;
+    }
+    //SOF, identifier, RTR, IDE, r0, DLC, data and CRC are stuffed (34 + 8n bits): at most one stuff bit every 4 bits
+    //after the first 5. Then CRC delimiter, ACK, EOF and interframe space (13 bits).
+    unsigned int stuffed = 34 + 8 * payload;
+    return stuffed + (stuffed - 1) / 4 + 13;
+}
+
+void BusLoadPlanner::setExpectedTransmissionType(UNSIGNED32 COB_ID, UNSIGNED8 transmissionType) {
+    expectedTransmissionTypes[COB_ID] = transmissionType;
+}
+
+BusLoadEstimate BusLoadPlanner::estimate(double bitrate_kbps, double SYNCPeriod_us, double controlLoopPeriod_ms) {
+    BusLoadEstimate e;
+    //Without SYNC, synchronous PDOs are counted at the control loop rate
+    double syncRate = SYNCPeriod_us > 0 ? 1e6 / SYNCPeriod_us : 1000. / controlLoopPeriod_ms;
+    double controlRate = 1000. / controlLoopPeriod_ms;
+
+    auto add = [&e](double rate, unsigned int payload) {
+        e.framesPerSecond += rate;
+        e.bitsPerSecond += rate * frameBits(payload);
+    };
+
+    if (SYNCPeriod_us > 0) {
+        add(syncRate, 0);
+    }
+    for (unsigned int i = 0; i < CO_noTPDO; i++) {
+        OD_TPDOCommunicationParameter_t *comm = OD_TPDOCommunicationParameter[i];
+        OD_TPDOMappingParameter_t *map = OD_TPDOMappingParameter[i];
+        if (comm->COB_IDUsedByTPDO & 0x80000000) {
+            continue;
+        }
+        unsigned int payload = payloadBytes(map->numberOfMappedObjects, &map->mappedObject1);
+        double rate = (comm->transmissionType >= 1 && comm->transmissionType <= 240) ? syncRate / comm->transmissionType
+                      : (comm->transmissionType == 0) ? syncRate : controlRate;
+        spdlog::debug("  TPDO 0x{:x}: {} bytes, {:.0f} frames/s", comm->COB_IDUsedByTPDO, payload, rate);
+        add(rate, payload);
+        e.PDOs++;
+    }
+    for (unsigned int i = 0; i < CO_noRPDO; i++) {
+        OD_RPDOCommunicationParameter_t *comm = OD_RPDOCommunicationParameter[i];
+        OD_RPDOMappingParameter_t *map = OD_RPDOMappingParameter[i];
+        if (comm->COB_IDUsedByRPDO & 0x80000000) {
+            continue;
+        }
+        unsigned int payload = payloadBytes(map->numberOfMappedObjects, &map->mappedObject1);
+        auto it = expectedTransmissionTypes.find(comm->COB_IDUsedByRPDO);
+        UNSIGNED8 type = (it != expectedTransmissionTypes.end()) ? it->second : 1;
+        if (type > 240) {
+            spdlog::debug("  RPDO 0x{:x}: {} bytes, event driven", comm->COB_IDUsedByRPDO, payload);
+            e.eventPDOs++;
+            continue;
+        }
+        double rate = syncRate / (type == 0 ? 1 : type);
+        spdlog::debug("  RPDO 0x{:x}: {} bytes, {:.0f} frames/s", comm->COB_IDUsedByRPDO, payload, rate);
+        add(rate, payload);
+        e.PDOs++;
+    }
+    e.load = 100. * e.bitsPerSecond / (bitrate_kbps * 1000.);
+    return e;
+}
+
+bool BusLoadPlanner::check(double bitrate_kbps, double SYNCPeriod_us, double controlLoopPeriod_ms, double budget) {
+    BusLoadEstimate e = estimate(bitrate_kbps, SYNCPeriod_us, controlLoopPeriod_ms);
+    spdlog::info("Expected CAN bus load: {:.1f}% of {}kbit/s ({} PDOs, {:.0f} frames/s, {:.0f} bit/s worst case), {} event driven RPDOs not counted.",
+                 e.load, bitrate_kbps, e.PDOs, e.framesPerSecond, e.bitsPerSecond, e.eventPDOs);
+    if (e.load > budget) {
+        spdlog::warn("Expected CAN bus load {:.1f}% over budget ({}%): reduce the PDOs (mapping, SYNC divider, packing) or the SYNC rate.", e.load, budget);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * \file BusLoadPlanner.h
+ * \brief Startup estimation of the CAN bus load from the PDOs registered in the (master) Object Dictionary.
+ *
+ * Each enabled PDO contributes its worst case frame length (CAN 2.0A standard frame, maximum bit stuffing) times its
+ * expected rate:
+ *  - TPDOs (commands sent by CORC): every N SYNC for synchronous ones (transmission type N), at most once per control
+ *    loop period for event driven ones (sent when changed).
+ *  - RPDOs (values received from the devices): rate of the remote TPDO, as declared with setExpectedTransmissionType()
+ *    (e.g. by Drive::configureMasterPDOs()), every SYNC if not declared. Event driven remote TPDOs are not accounted for.
+ *  - The SYNC message itself.
+ * Heartbeats, SDOs and emergencies are not accounted for: the budget should leave room for them.
+ *
+ * \version 0.1
+ *
+ */
+#ifndef BUSLOADPLANNER_H_INCLUDED
+#define BUSLOADPLANNER_H_INCLUDED
+
+#include <CANopen.h>
+
+#include <map>
+
+/**
+ * \brief Expected bus utilisation
+ *
+ */
+struct BusLoadEstimate {
+    double load = 0;              /*!< Expected bus load (%) */
+    double framesPerSecond = 0;   /*!< Expected frames rate (frames/s) */
+    double bitsPerSecond = 0;     /*!< Expected bits rate, worst case bit stuffing (bit/s) */
+    unsigned int PDOs = 0;        /*!< Number of enabled PDOs accounted for */
+    unsigned int eventPDOs = 0;   /*!< Number of RPDOs from event driven remote TPDOs (not accounted for) */
+};
+
+class BusLoadPlanner {
+   public:
+    /**
+     * \brief Worst case length of a CAN 2.0A (11 bits identifier) data frame, including the maximum bit stuffing
+     * and the interframe space
+     *
+     * \param payload Data length in bytes (0-8)
+     * \return Length in bits
+     */
+    static unsigned int frameBits(unsigned int payload);
+
+    /**
+     * \brief Declares the transmission type of the remote TPDO received by a (master) RPDO: 1-240 every N SYNC,
+     * 0xFE/0xFF event driven.
+     *
+     * \param COB_ID COB-ID of the PDO
+     * \param transmissionType Transmission type of the remote TPDO
+     */
+    static void setExpectedTransmissionType(UNSIGNED32 COB_ID, UNSIGNED8 transmissionType);
+
+    /**
+     * \brief Expected bus load of the PDOs registered in the Object Dictionary (to call after their creation, e.g.
+     * after app_communicationReset()) and of the SYNC
+     *
+     * \param bitrate_kbps CAN bitrate in kbit/s
+     * \param SYNCPeriod_us SYNC period in us (CO_OD_RAM.communicationCyclePeriod), 0 if no SYNC is produced
+     * \param controlLoopPeriod_ms Control loop period in ms: maximum rate of the event driven commands
+     */
+    static BusLoadEstimate estimate(double bitrate_kbps, double SYNCPeriod_us, double controlLoopPeriod_ms);
+
+    /**
+     * \brief Estimates the bus load (see estimate()) and logs it, with a warning if over budget
+     *
+     * \param budget Maximum bus load (%)
+     * \return false if the expected bus load is over budget
+     */
+    static bool check(double bitrate_kbps, double SYNCPeriod_us, double controlLoopPeriod_ms, double budget);
+
+   private:
+    static std::map<UNSIGNED32, UNSIGNED8> expectedTransmissionTypes;
+};
+
+#endif
@@ -56,6 +56,16 @@ static uint8_t comm_node_default = 0xFF; /* CANopen Node ID number is undefined
 static uint16_t SDOtimeoutTime = 500;    /* Timeout time for SDO transfer in milliseconds, if no response */
 static uint8_t blockTransferEnable = 0;  /* SDO block transfer enabled? */
 static volatile int endProgram = 0;
+
+/* Pool of SDO transfer buffers (CO_COMMAND_SDO_BUFFER_SIZE bytes each), allocated on first use and
+ * kept. Used for uploads and for downloads of strings/domains, so that no transfer buffer lives on
+ * the stack of the calling (possibly real-time) thread. Transfers are serialised by the SDO client. */
+static uint8_t *SDObufferPool[CO_COMMAND_SDO_BUFFER_POOL_SIZE];
+static uint8_t SDObufferUsed[CO_COMMAND_SDO_BUFFER_POOL_SIZE];
+static pthread_mutex_t SDObufferPool_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t SDObufferPool_cond = PTHREAD_COND_INITIALIZER;
+static uint8_t *SDObuffer_get(void);
+static void SDObuffer_put(uint8_t *buffer);
 /***/
 /* send CANopen generic emergency message */
 void CO_errorR(const uint32_t info) {
@@ -63,11 +73,63 @@ void CO_errorR(const uint32_t info) {
     fprintf(stderr, "canopend generic error: 0x%X\n", info);
 }
 
+/******************************************************************************/
+int CO_command_allocateBuffers(void) {
+    int i;
+    pthread_mutex_lock(&SDObufferPool_mtx);
+    for (i = 0; i < CO_COMMAND_SDO_BUFFER_POOL_SIZE; i++) {
+        if (SDObufferPool[i] == NULL) {
+            SDObufferPool[i] = (uint8_t *)malloc(CO_COMMAND_SDO_BUFFER_SIZE);
+            if (SDObufferPool[i] == NULL) {
+                pthread_mutex_unlock(&SDObufferPool_mtx);
+                return -1;
+            }
+            /* Touch the pages now rather than during a transfer */
+            memset(SDObufferPool[i], 0, CO_COMMAND_SDO_BUFFER_SIZE);
+        }
+    }
+    pthread_mutex_unlock(&SDObufferPool_mtx);
+    return 0;
+}
+
+static uint8_t *SDObuffer_get(void) {
+    int i;
+    if (SDObufferPool[CO_COMMAND_SDO_BUFFER_POOL_SIZE - 1] == NULL && CO_command_allocateBuffers() != 0) {
+        CO_errExit("CO_command - SDO buffer pool allocation failed");
+    }
+    pthread_mutex_lock(&SDObufferPool_mtx);
+    for (;;) {
+        for (i = 0; i < CO_COMMAND_SDO_BUFFER_POOL_SIZE; i++) {
+            if (SDObufferUsed[i] == 0) {
+                SDObufferUsed[i] = 1;
+                pthread_mutex_unlock(&SDObufferPool_mtx);
+                return SDObufferPool[i];
+            }
+        }
+        pthread_cond_wait(&SDObufferPool_cond, &SDObufferPool_mtx);
+    }
+}
+
+static void SDObuffer_put(uint8_t *buffer) {
+    int i;
+    if (buffer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&SDObufferPool_mtx);
+    for (i = 0; i < CO_COMMAND_SDO_BUFFER_POOL_SIZE; i++) {
+        if (SDObufferPool[i] == buffer) {
+            SDObufferUsed[i] = 0;
+        }
+    }
+    pthread_cond_signal(&SDObufferPool_cond);
+    pthread_mutex_unlock(&SDObufferPool_mtx);
+}
+
 /******************************************************************************/
 int CO_command_init(void) {
     struct sockaddr_un addr;
 
-    if (CO == NULL || CO->SDOclient == NULL) {
+    if (CO == NULL || CO->SDOclient[0] == NULL) {
         perror("CO_command_init - Wrong arguments");
         exit(EXIT_FAILURE);
     }
@@ -146,7 +208,7 @@ int CO_command_clear(void) {
 static void *command_thread(void *arg) {
     int fd;
     ssize_t n;
-    char buf[STRING_BUFFER_SIZE];
+    static char buf[STRING_BUFFER_SIZE]; /* only used by the command thread */
 
     /* Almost endless loop */
     while (endProgram == 0) {
@@ -184,7 +246,8 @@ static void command_process(int fd, char *command, size_t commandLength) {
     uint32_t ui[3];
     uint8_t comm_node = 0xFF; /* undefined */
 
-    char resp[STRING_BUFFER_SIZE];
+    static char resp[STRING_BUFFER_SIZE]; /* only used by the command thread */
+    const int respSize = sizeof(resp);
     int respLen = 0;
     respErrorCode_t respErrorCode = respErrorNone;
 
@@ -263,8 +326,8 @@ static void command_process(int fd, char *command, size_t commandLength) {
             int errDt = 0;
             uint32_t SDOabortCode = 1;
 
-            uint8_t dataRx[CO_COMMAND_SDO_BUFFER_SIZE]; /* SDO receive buffer */
-            uint32_t dataRxLen;                         /* Length of received data */
+            uint8_t *dataRx = NULL; /* SDO receive buffer (from the pool) */
+            uint32_t dataRxLen;     /* Length of received data */
 
             token = getTok(NULL, spaceDelim, &err);
             idx = (uint16_t)getU32(token, 0, 0xFFFF, &err);
@@ -293,13 +356,14 @@ static void command_process(int fd, char *command, size_t commandLength) {
 
             /* Make CANopen SDO transfer */
             if (err == 0) {
+                dataRx = SDObuffer_get();
                 err = sdoClientUpload(
-                    CO->SDOclient,
+                    sdoClientChannel(comm_node),
                     comm_node,
                     idx,
                     subidx,
                     dataRx,
-                    sizeof(dataRx),
+                    CO_COMMAND_SDO_BUFFER_SIZE,
                     &dataRxLen,
                     &SDOabortCode,
                     SDOtimeoutTime,
@@ -316,15 +380,16 @@ static void command_process(int fd, char *command, size_t commandLength) {
                     respLen = sprintf(resp, "[%d] ", sequence);
 
                     if (datatype == NULL || (datatype->length != 0 && datatype->length != dataRxLen)) {
-                        respLen += dtpHex(resp + respLen, sizeof(resp) - respLen, (char *)dataRx, dataRxLen);
+                        respLen += dtpHex(resp + respLen, respSize - respLen, (char *)dataRx, dataRxLen);
                     } else {
                         respLen += datatype->dataTypePrint(
-                            resp + respLen, sizeof(resp) - respLen, (char *)dataRx, dataRxLen);
+                            resp + respLen, respSize - respLen, (char *)dataRx, dataRxLen);
                     }
                 } else {
                     respLen = sprintf(resp, "[%d] ERROR: 0x%08X", sequence, SDOabortCode);
                 }
             }
+            SDObuffer_put(dataRx);
         }
 
         /* Download SDO command - w[rite] <index> <subindex> <datatype> <value> */
@@ -334,8 +399,9 @@ static void command_process(int fd, char *command, size_t commandLength) {
             const dataType_t *datatype;
             uint32_t SDOabortCode = 1;
 
-            uint8_t dataTx[CO_COMMAND_SDO_BUFFER_SIZE]; /* SDO transmit buffer */
-            uint32_t dataTxLen = 0;                     /* Length of data to transmit. */
+            uint8_t dataTxExpedited[8]; /* SDO transmit buffer for fixed size data types */
+            uint8_t *dataTx = NULL;     /* SDO transmit buffer */
+            uint32_t dataTxLen = 0;     /* Length of data to transmit. */
 
             token = getTok(NULL, spaceDelim, &err);
             idx = (uint16_t)getU32(token, 0, 0xFFFF, &err);
@@ -352,7 +418,14 @@ static void command_process(int fd, char *command, size_t commandLength) {
             }
 
             if (err == 0) {
-                dataTxLen = datatype->dataTypeScan((char *)dataTx, sizeof(dataTx), token);
+                /* Other data types (strings, domains) may need a whole transfer buffer */
+                if (datatype->length != 0 && datatype->length <= (int)sizeof(dataTxExpedited)) {
+                    dataTx = dataTxExpedited;
+                    dataTxLen = datatype->dataTypeScan((char *)dataTx, sizeof(dataTxExpedited), token);
+                } else {
+                    dataTx = SDObuffer_get();
+                    dataTxLen = datatype->dataTypeScan((char *)dataTx, CO_COMMAND_SDO_BUFFER_SIZE, token);
+                }
 
                 /* Length must match and must not be zero. */
                 if ((datatype->length != 0 && datatype->length != dataTxLen) || dataTxLen == 0) {
@@ -374,7 +447,7 @@ static void command_process(int fd, char *command, size_t commandLength) {
             /* Make CANopen SDO transfer */
             if (err == 0) {
                 err = sdoClientDownload(
-                    CO->SDOclient,
+                    sdoClientChannel(comm_node),
                     comm_node,
                     idx,
                     subidx,
@@ -397,6 +470,9 @@ static void command_process(int fd, char *command, size_t commandLength) {
                     respLen = sprintf(resp, "[%d] ERROR: 0x%08X", sequence, SDOabortCode);
                 }
             }
+            if (dataTx != dataTxExpedited) {
+                SDObuffer_put(dataTx);
+            }
         }
 
         /* NMT start node */
@@ -559,7 +635,8 @@ void cancomm_socketFree(char *command, char *ret) {
     uint32_t ui[3];
     uint8_t comm_node = 0xFF; /* undefined */
 
-    char resp[STRING_BUFFER_SIZE];
+    char *resp = ret; /* response is written directly to the caller buffer */
+    const int respSize = STRING_BUFFER_SIZE;
     int respLen = 0;
     respErrorCode_t respErrorCode = respErrorNone;
 
@@ -639,8 +716,8 @@ void cancomm_socketFree(char *command, char *ret) {
             int errDt = 0;
             uint32_t SDOabortCode = 1;
 
-            uint8_t dataRx[CO_COMMAND_SDO_BUFFER_SIZE]; /* SDO receive buffer */
-            uint32_t dataRxLen;                         /* Length of received data */
+            uint8_t *dataRx = NULL; /* SDO receive buffer (from the pool) */
+            uint32_t dataRxLen;     /* Length of received data */
 
             token = getTok(NULL, spaceDelim, &err);
             idx = (uint16_t)getU32(token, 0, 0xFFFF, &err);
@@ -669,13 +746,14 @@ void cancomm_socketFree(char *command, char *ret) {
 
             /* Make CANopen SDO transfer */
             if (err == 0) {
+                dataRx = SDObuffer_get();
                 err = sdoClientUpload(
-                    CO->SDOclient,
+                    sdoClientChannel(comm_node),
                     comm_node,
                     idx,
                     subidx,
                     dataRx,
-                    sizeof(dataRx),
+                    CO_COMMAND_SDO_BUFFER_SIZE,
                     &dataRxLen,
                     &SDOabortCode,
                     SDOtimeoutTime,
@@ -692,15 +770,16 @@ void cancomm_socketFree(char *command, char *ret) {
                     respLen = sprintf(resp, "[%d] ", sequence);
 
                     if (datatype == NULL || (datatype->length != 0 && datatype->length != dataRxLen)) {
-                        respLen += dtpHex(resp + respLen, sizeof(resp) - respLen, (char *)dataRx, dataRxLen);
+                        respLen += dtpHex(resp + respLen, respSize - respLen, (char *)dataRx, dataRxLen);
                     } else {
                         respLen += datatype->dataTypePrint(
-                            resp + respLen, sizeof(resp) - respLen, (char *)dataRx, dataRxLen);
+                            resp + respLen, respSize - respLen, (char *)dataRx, dataRxLen);
                     }
                 } else {
                     respLen = sprintf(resp, "[%d] ERROR: 0x%08X", sequence, SDOabortCode);
                 }
             }
+            SDObuffer_put(dataRx);
         }
 
         /* Download SDO command - w[rite] <index> <subindex> <datatype> <value> */
@@ -710,8 +789,9 @@ void cancomm_socketFree(char *command, char *ret) {
             const dataType_t *datatype;
             uint32_t SDOabortCode = 1;
 
-            uint8_t dataTx[CO_COMMAND_SDO_BUFFER_SIZE]; /* SDO transmit buffer */
-            uint32_t dataTxLen = 0;                     /* Length of data to transmit. */
+            uint8_t dataTxExpedited[8]; /* SDO transmit buffer for fixed size data types */
+            uint8_t *dataTx = NULL;     /* SDO transmit buffer */
+            uint32_t dataTxLen = 0;     /* Length of data to transmit. */
 
             token = getTok(NULL, spaceDelim, &err);
             idx = (uint16_t)getU32(token, 0, 0xFFFF, &err);
@@ -728,7 +808,14 @@ void cancomm_socketFree(char *command, char *ret) {
             }
 
             if (err == 0) {
-                dataTxLen = datatype->dataTypeScan((char *)dataTx, sizeof(dataTx), token);
+                /* Other data types (strings, domains) may need a whole transfer buffer */
+                if (datatype->length != 0 && datatype->length <= (int)sizeof(dataTxExpedited)) {
+                    dataTx = dataTxExpedited;
+                    dataTxLen = datatype->dataTypeScan((char *)dataTx, sizeof(dataTxExpedited), token);
+                } else {
+                    dataTx = SDObuffer_get();
+                    dataTxLen = datatype->dataTypeScan((char *)dataTx, CO_COMMAND_SDO_BUFFER_SIZE, token);
+                }
 
                 /* Length must match and must not be zero. */
                 if ((datatype->length != 0 && datatype->length != dataTxLen) || dataTxLen == 0) {
@@ -750,7 +837,7 @@ void cancomm_socketFree(char *command, char *ret) {
             /* Make CANopen SDO transfer */
             if (err == 0) {
                 err = sdoClientDownload(
-                    CO->SDOclient,
+                    sdoClientChannel(comm_node),
                     comm_node,
                     idx,
                     subidx,
@@ -773,6 +860,9 @@ void cancomm_socketFree(char *command, char *ret) {
                     respLen = sprintf(resp, "[%d] ERROR: 0x%08X", sequence, SDOabortCode);
                 }
             }
+            if (dataTx != dataTxExpedited) {
+                SDObuffer_put(dataTx);
+            }
         }
 
         /* NMT start node */
@@ -920,6 +1010,42 @@ void cancomm_socketFree(char *command, char *ret) {
     resp[respLen++] = '\r';
     resp[respLen++] = '\n';
     resp[respLen++] = '\0';
-    // Modify returnMessage
-    strncpy(ret, resp, STRING_BUFFER_SIZE);
+}
+/******************************************************************************/
+int cancomm_sdoWrite(uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                     uint8_t *dataTx, uint32_t dataTxLen, uint32_t *SDOabortCode) {
+    *SDOabortCode = 0;
+    if (nodeID < 1 || nodeID > 127 || dataTxLen == 0) {
+        return 1;
+    }
+    return sdoClientDownload(
+        sdoClientChannel(nodeID),
+        nodeID,
+        idx,
+        subidx,
+        dataTx,
+        dataTxLen,
+        SDOabortCode,
+        SDOtimeoutTime,
+        blockTransferEnable);
+}
+/******************************************************************************/
+int cancomm_sdoRead(uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                    uint8_t *dataRx, uint32_t dataRxSize, uint32_t *dataRxLen, uint32_t *SDOabortCode) {
+    *SDOabortCode = 0;
+    *dataRxLen = 0;
+    if (nodeID < 1 || nodeID > 127) {
+        return 1;
+    }
+    return sdoClientUpload(
+        sdoClientChannel(nodeID),
+        nodeID,
+        idx,
+        subidx,
+        dataRx,
+        dataRxSize,
+        dataRxLen,
+        SDOabortCode,
+        SDOtimeoutTime,
+        blockTransferEnable);
 }
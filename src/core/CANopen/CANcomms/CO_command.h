@@ -45,6 +45,11 @@ typedef unsigned char uint8_t;
 #define STRING_BUFFER_SIZE (CO_COMMAND_SDO_BUFFER_SIZE * 4 + 100)
 #endif
 
+/* Number of preallocated SDO transfer buffers (of CO_COMMAND_SDO_BUFFER_SIZE) shared by the text commands. */
+#ifndef CO_COMMAND_SDO_BUFFER_POOL_SIZE
+#define CO_COMMAND_SDO_BUFFER_POOL_SIZE 2
+#endif
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,13 +78,59 @@ int CO_command_init(void);
  * @return 0 on success.
  */
 int CO_command_clear(void);
+/**
+ * Allocate (and touch) the SDO transfer buffers used by the text commands.
+ *
+ * Optional: otherwise done on first use. Call before the real-time threads
+ * start to keep the allocation out of them.
+ *
+ * @return 0 on success.
+ */
+int CO_command_allocateBuffers(void);
 /**
  * Allow main thread to send SDO messages to nodes
  *
+ * The response is written directly to ret, which must hold STRING_BUFFER_SIZE
+ * characters. Transfer buffers are taken from the preallocated pool (or are small
+ * fixed buffers for fixed size data types): no large buffer is put on the stack.
+ *
  * @return message recieved on success
  * @return error on failure
  */
 void cancomm_socketFree(char *command, char *ret);
+/**
+ * Allow main thread to write an object of a node through SDO, without
+ * going through the text command parser.
+ *
+ * Uses the SDO timeout and block transfer settings of the command interface.
+ *
+ * @param nodeID Node-ID of the remote node (1 to 127).
+ * @param idx Index of object in object dictionary in remote node.
+ * @param subidx Subindex of object in object dictionary in remote node.
+ * @param dataTx Data to write, little endian (CANopen byte order).
+ * @param dataTxLen Length of data in dataTx.
+ * @param SDOabortCode Return variable - SDO abort code (0 if none).
+ *
+ * @return 0 on success.
+ */
+int cancomm_sdoWrite(uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                     uint8_t *dataTx, uint32_t dataTxLen, uint32_t *SDOabortCode);
+/**
+ * Allow main thread to read an object of a node through SDO, without
+ * going through the text command parser.
+ *
+ * @param nodeID Node-ID of the remote node (1 to 127).
+ * @param idx Index of object in object dictionary in remote node.
+ * @param subidx Subindex of object in object dictionary in remote node.
+ * @param dataRx Buffer into which received data will be written (little endian).
+ * @param dataRxSize Size of dataRx.
+ * @param dataRxLen Return variable - actual data length in dataRx.
+ * @param SDOabortCode Return variable - SDO abort code (0 if none).
+ *
+ * @return 0 on success.
+ */
+int cancomm_sdoRead(uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                    uint8_t *dataRx, uint32_t dataRxSize, uint32_t *dataRxLen, uint32_t *SDOabortCode);
 /**
  * Using cancomm_socketFree(const char* command, char* ret)
  * initialize nodes for PDO messaging
@@ -26,6 +26,188 @@
 
 
 #include "CO_master.h"
+#include "CANopen.h"
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+
+/* Maximum time to wait for a server response before the SDO client is
+ * processed again (for the SDO timeout) */
+#ifndef SDO_CLIENT_WAIT_MS
+#define SDO_CLIENT_WAIT_MS 10
+#endif
+
+
+/* SDO master channels ********************************************************/
+/* One channel per SDO client object (CO->SDOclient[i]). A channel is assigned
+ * to the first node it transfers with and keeps its COB-IDs, so transfers to
+ * different nodes run concurrently, each with its own response event. */
+static struct {
+    pthread_mutex_t     mtx;        /* held for a whole transfer */
+    volatile int        fdEvent;    /* eventfd signalled on server response */
+    uint8_t             nodeID;     /* node assigned to the channel, 0 if free */
+} sdoChannel[CO_NO_SDO_CLIENT];
+
+/* Protects channel assignment and the CAN receive/transmit buffer setup */
+static pthread_mutex_t sdoChannel_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t sdoChannel_once = PTHREAD_ONCE_INIT;
+
+
+static void sdoChannel_init(void) {
+    int i;
+
+    for(i = 0; i < CO_NO_SDO_CLIENT; i++) {
+        pthread_mutex_init(&sdoChannel[i].mtx, NULL);
+        sdoChannel[i].fdEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        sdoChannel[i].nodeID = 0;
+    }
+}
+
+
+/* Index of the channel of an SDO client object, -1 if none */
+static int sdoChannel_index(CO_SDOclient_t *SDOclient) {
+    int i;
+
+    if(CO == NULL || SDOclient == NULL) {
+        return -1;
+    }
+    for(i = 0; i < CO_NO_SDO_CLIENT; i++) {
+        if(CO->SDOclient[i] == SDOclient) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+CO_SDOclient_t *sdoClientChannel(uint8_t nodeID) {
+    int i, ch = -1;
+
+    if(CO == NULL) {
+        return NULL;
+    }
+    pthread_once(&sdoChannel_once, sdoChannel_init);
+
+    pthread_mutex_lock(&sdoChannel_mtx);
+    for(i = 0; i < CO_NO_SDO_CLIENT && ch < 0; i++) {
+        if(sdoChannel[i].nodeID == nodeID) {
+            ch = i;
+        }
+    }
+    for(i = 0; i < CO_NO_SDO_CLIENT && ch < 0; i++) {
+        if(sdoChannel[i].nodeID == 0) {
+            sdoChannel[i].nodeID = nodeID;
+            ch = i;
+        }
+    }
+    if(ch < 0) {
+        /* More nodes than channels: share */
+        ch = nodeID % CO_NO_SDO_CLIENT;
+    }
+    pthread_mutex_unlock(&sdoChannel_mtx);
+
+    return CO->SDOclient[ch];
+}
+
+
+/* SDO client response event **************************************************/
+void sdoClient_cbSignal(void) {
+    uint64_t u = 1;
+    int i;
+
+    if(CO == NULL) {
+        return;
+    }
+    pthread_once(&sdoChannel_once, sdoChannel_init);
+    /* Wake the channels which received a frame (one per call in practice) */
+    for(i = 0; i < CO_NO_SDO_CLIENT; i++) {
+        int fd = sdoChannel[i].fdEvent;
+
+        if(CO->SDOclient[i]->CANrxNew && fd >= 0 && write(fd, &u, sizeof(u)) == -1) {
+            /* Counter can only saturate: the waiting thread is woken anyway */
+        }
+    }
+}
+
+
+/* Drop responses signalled since the last wait (e.g. of a previous transfer) */
+static void sdoClient_eventClear(int ch) {
+    uint64_t u;
+
+    if(sdoChannel[ch].fdEvent >= 0 && read(sdoChannel[ch].fdEvent, &u, sizeof(u)) == -1) {
+        /* EAGAIN: no event pending */
+    }
+}
+
+
+/* Wait before the SDO client is processed again, depending on its state */
+static void sdoClient_wait(int ch, CO_SDOclient_return_t ret) {
+    struct timespec sleepTime;
+
+    if(sdoChannel[ch].fdEvent >= 0 && (ret == CO_SDOcli_waitingServerResponse ||
+                                       ret == CO_SDOcli_blockUploadInProgress))
+    {
+        /* Wait for the next frame from the server */
+        struct pollfd pfd;
+
+        pfd.fd = sdoChannel[ch].fdEvent;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if(poll(&pfd, 1, SDO_CLIENT_WAIT_MS) > 0) {
+            sdoClient_eventClear(ch);
+        }
+    }
+    else if(ret != CO_SDOcli_blockDownldInProgress) {
+        /* Transmit buffer full (or no event): let the CAN driver send */
+        sleepTime.tv_sec = 0;
+        sleepTime.tv_nsec = 1000000;
+        nanosleep(&sleepTime, NULL);
+    }
+    /* Block download in progress: next segments are sent right away */
+}
+
+
+/* Start a transfer on the channel of SDOclient: returns the channel index with
+ * the channel locked and the client set up for nodeID, or -1. CAN stays valid
+ * (CO_CAN_VALID_rwlock read locked) until sdoClient_end(). */
+static int sdoClient_begin(CO_SDOclient_t *SDOclient, uint8_t nodeID) {
+    CO_SDOclient_return_t ret;
+    int ch;
+
+    pthread_once(&sdoChannel_once, sdoChannel_init);
+    ch = sdoChannel_index(SDOclient);
+    if(ch < 0) {
+        return -1;
+    }
+
+    /* stay here, if CAN is not configured. Transfers share the lock: a
+     * communication reset waits for them to end before deleting the clients. */
+    pthread_rwlock_rdlock(&CO_CAN_VALID_rwlock);
+
+    pthread_mutex_lock(&sdoChannel[ch].mtx);
+    sdoClient_eventClear(ch);
+
+    /* Setup client. Reconfigures CAN buffers only if the node changed,
+     * CO_CANrxBufferInit then locks out the RT thread dispatch itself. */
+    pthread_mutex_lock(&sdoChannel_mtx);
+    ret = CO_SDOclient_setup(SDOclient, 0, 0, nodeID);
+    pthread_mutex_unlock(&sdoChannel_mtx);
+
+    if(ret != CO_SDOcli_ok_communicationEnd) {
+        pthread_mutex_unlock(&sdoChannel[ch].mtx);
+        pthread_rwlock_unlock(&CO_CAN_VALID_rwlock);
+        return -1;
+    }
+    return ch;
+}
+
+
+/* End a transfer started with sdoClient_begin(). */
+static void sdoClient_end(int ch) {
+    pthread_mutex_unlock(&sdoChannel[ch].mtx);
+    pthread_rwlock_unlock(&CO_CAN_VALID_rwlock);
+}
 
 
 /******************************************************************************/
@@ -42,34 +224,27 @@ int sdoClientUpload(
         uint8_t         blockTransferEnable)
 {
     int err = 0;
+    int ch;
 
-    /* stay here, if CAN is not configured */
-    pthread_mutex_lock(&CO_CAN_VALID_mtx);
-
-
-    /* Setup client. */
-    if(CO_SDOclient_setup(SDOclient, 0, 0, nodeID) != CO_SDOcli_ok_communicationEnd) {
-        err = 1;
+    /* Lock the channel and setup client. */
+    ch = sdoClient_begin(SDOclient, nodeID);
+    if(ch < 0) {
+        return 1;
     }
 
     /* Initiate upload. */
-    if(err == 0){
-        if(CO_SDOclientUploadInitiate(SDOclient, idx, subidx, dataRx,
-                dataRxSize, blockTransferEnable) != CO_SDOcli_ok_communicationEnd)
-        {
-            err = 1;
-        }
+    if(CO_SDOclientUploadInitiate(SDOclient, idx, subidx, dataRx,
+            dataRxSize, blockTransferEnable) != CO_SDOcli_ok_communicationEnd)
+    {
+        err = 1;
     }
 
-    /* Upload data. Loop in 10 ms intervals. */
+    /* Upload data. Wait for each response of the server. */
     if(err == 0){
         CO_SDOclient_return_t ret;
         uint16_t timer1msPrev;
-        struct timespec sleepTime;
 
         timer1msPrev = CO_timer1ms;
-        sleepTime.tv_sec = 0;
-        sleepTime.tv_nsec = 10000000;
 
         do {
             uint16_t timer1ms, timer1msDiff;
@@ -80,14 +255,16 @@ int sdoClientUpload(
             timer1msPrev = timer1ms;
 
             ret = CO_SDOclientUpload(SDOclient, timer1msDiff, SDOtimeoutTime, dataRxLen, SDOabortCode);
-            nanosleep(&sleepTime, NULL);
+            if(ret > 0) {
+                sdoClient_wait(ch, ret);
+            }
         } while(ret > 0);
 
         CO_SDOclientClose(SDOclient);
 
     }
 
-    pthread_mutex_unlock(&CO_CAN_VALID_mtx);
+    sdoClient_end(ch);
 
     return err;
 }
@@ -105,31 +282,27 @@ int sdoClientDownload(
         uint8_t         blockTransferEnable)
 {
     int err = 0;
+    int ch;
 
-    /* stay here, if CAN is not configured */
-    pthread_mutex_lock(&CO_CAN_VALID_mtx);
-
-    /* Setup client. */
-    if(CO_SDOclient_setup(SDOclient, 0, 0, nodeID) != CO_SDOcli_ok_communicationEnd) {
-        err = 1;
+    /* Lock the channel and setup client. */
+    ch = sdoClient_begin(SDOclient, nodeID);
+    if(ch < 0) {
+        return 1;
     }
+
     /* Initiate download. */
-    if(err == 0){
-        if(CO_SDOclientDownloadInitiate(SDOclient, idx, subidx, dataTx,
-                dataTxLen, blockTransferEnable) != CO_SDOcli_ok_communicationEnd)
-        {
-            err = 1;
-        }
+    if(CO_SDOclientDownloadInitiate(SDOclient, idx, subidx, dataTx,
+            dataTxLen, blockTransferEnable) != CO_SDOcli_ok_communicationEnd)
+    {
+        err = 1;
     }
-    /* Download data. Loop in 5 ms intervals. */
+
+    /* Download data. Wait for each response of the server. */
     if(err == 0){
         CO_SDOclient_return_t ret;
         uint16_t timer1msPrev;
-        struct timespec sleepTime;
 
         timer1msPrev = CO_timer1ms;
-        sleepTime.tv_sec = 0;
-        sleepTime.tv_nsec = 5000000;
 
         do {
             uint16_t timer1ms, timer1msDiff;
@@ -140,13 +313,16 @@ int sdoClientDownload(
             timer1msPrev = timer1ms;
 
             ret = CO_SDOclientDownload(SDOclient, timer1msDiff, SDOtimeoutTime, SDOabortCode);
-            nanosleep(&sleepTime, NULL);
+            if(ret > 0) {
+                sdoClient_wait(ch, ret);
+            }
         } while(ret > 0);
 
         CO_SDOclientClose(SDOclient);
 
     }
-    pthread_mutex_unlock(&CO_CAN_VALID_mtx);
+
+    sdoClient_end(ch);
 
     return err;
 }
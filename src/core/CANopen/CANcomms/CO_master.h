@@ -35,17 +35,46 @@
 #include <pthread.h>
 
 
-extern pthread_mutex_t CO_CAN_VALID_mtx; /* from main */
+extern pthread_rwlock_t CO_CAN_VALID_rwlock; /* from main */
 extern volatile uint32_t CO_timer1ms;    /* from main */
 
 
+/**
+ * SDO client channel for a node.
+ *
+ * Each SDO client object (CO->SDOclient[], CO_NO_SDO_CLIENT of them) is a
+ * channel, assigned to the first node requested. Transfers on different
+ * channels, so to different nodes, run concurrently; transfers on the same
+ * channel wait for each other. With more nodes than channels, nodes share
+ * channels.
+ *
+ * @param nodeID Node-ID of the remote node.
+ *
+ * @return SDO client to pass to sdoClientUpload() or sdoClientDownload(),
+ * NULL if CANopen is not initialised.
+ */
+CO_SDOclient_t *sdoClientChannel(uint8_t nodeID);
+
+
+/**
+ * Signal a response to the waiting SDO clients.
+ *
+ * To be registered with CO_SDOclient_initCallback() for all SDO clients, it is
+ * called from the CAN receive thread. It wakes sdoClientUpload() or
+ * sdoClientDownload() of the channels which received a frame (through an
+ * eventfd each), so the transfers continue as soon as the server responds
+ * instead of after a fixed polling interval.
+ */
+void sdoClient_cbSignal(void);
+
+
 /**
  * Sdo client upload.
  *
  * For further details see CANopenNode/stack/CO_master.h file.
  * This is blocking function.
  *
- * @param SDOclient Pointer to CANopen SDO client object.
+ * @param SDOclient Pointer to CANopen SDO client object (see sdoClientChannel()).
  * @param nodeID Node-ID of the remote node.
  * @param idx Index of object in object dictionary in remote node.
  * @param subidx Subindex of object in object dictionary in remote node.
@@ -77,7 +106,7 @@ int sdoClientUpload(
  * For further details see CANopenNode/stack/CO_master.h file.
  * This is blocking function.
  *
- * @param SDOclient Pointer to CANopen SDO client object.
+ * @param SDOclient Pointer to CANopen SDO client object (see sdoClientChannel()).
  * @param nodeID Node-ID of the remote node.
  * @param idx Index of object in object dictionary in remote node.
  * @param subidx Subindex of object in object dictionary in remote node.
@@ -59,12 +59,13 @@
 #ifndef CO_USE_GLOBALS
     #include <stdlib.h> /*  for malloc, free */
     static uint32_t CO_memoryUsed = 0; /* informative */
+    static uint16_t CO_noRPDOallocated = 0; /* PDO objects and CAN buffers allocated by the first CO_init() */
+    static uint16_t CO_noTPDOallocated = 0;
 #endif
 
     //test comment
 
 /* Global variables ***********************************************************/
-    extern const CO_OD_entry_t CO_OD[CO_OD_NoOfElements];  /* Object Dictionary array */
     static CO_t COO;
     CO_t *CO = NULL;
 
@@ -89,7 +90,7 @@
             || CO_NO_SYNC                                 != 1     \
             || CO_NO_EMERGENCY                            != 1     \
             || CO_NO_SDO_SERVER                           == 0     \
-            || (CO_NO_SDO_CLIENT != 0 && CO_NO_SDO_CLIENT != 1)    \
+            || CO_NO_SDO_CLIENT                          > 128    \
             || (CO_NO_RPDO < 1 || CO_NO_RPDO > 0x200)              \
             || (CO_NO_TPDO < 1 || CO_NO_TPDO > 0x200)              \
             || ODL_consumerHeartbeatTime_arrayLength      == 0     \
@@ -108,29 +109,31 @@
     #define CO_RXCAN_NMT       0                                      /*  index for NMT message */
     #define CO_RXCAN_SYNC      1                                      /*  index for SYNC message */
     #define CO_RXCAN_RPDO     (CO_RXCAN_SYNC+CO_NO_SYNC)              /*  start index for RPDO messages */
-    #define CO_RXCAN_SDO_SRV  (CO_RXCAN_RPDO+CO_NO_RPDO)              /*  start index for SDO server message (request) */
+    #define CO_RXCAN_SDO_SRV  (CO_RXCAN_RPDO+CO->noRPDO)              /*  start index for SDO server message (request) */
     #define CO_RXCAN_SDO_CLI  (CO_RXCAN_SDO_SRV+CO_NO_SDO_SERVER)     /*  start index for SDO client message (response) */
     #define CO_RXCAN_CONS_HB  (CO_RXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  start index for Heartbeat Consumer messages */
     /* total number of received CAN messages */
-    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO_NO_RPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
+    #define CO_RXCAN_NO_MSGS (1+CO_NO_SYNC+CO->noRPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
+    #define CO_RXCAN_MAX_MSGS (1+CO_NO_SYNC+CO_NO_RPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+CO_NO_HB_CONS)
 
     #define CO_TXCAN_NMT       0                                      /*  index for NMT master message */
     #define CO_TXCAN_SYNC      CO_TXCAN_NMT+CO_NO_NMT_MASTER          /*  index for SYNC message */
     #define CO_TXCAN_EMERG    (CO_TXCAN_SYNC+CO_NO_SYNC)              /*  index for Emergency message */
     #define CO_TXCAN_TPDO     (CO_TXCAN_EMERG+CO_NO_EMERGENCY)        /*  start index for TPDO messages */
-    #define CO_TXCAN_SDO_SRV  (CO_TXCAN_TPDO+CO_NO_TPDO)              /*  start index for SDO server message (response) */
+    #define CO_TXCAN_SDO_SRV  (CO_TXCAN_TPDO+CO->noTPDO)              /*  start index for SDO server message (response) */
     #define CO_TXCAN_SDO_CLI  (CO_TXCAN_SDO_SRV+CO_NO_SDO_SERVER)     /*  start index for SDO client message (request) */
     #define CO_TXCAN_HB       (CO_TXCAN_SDO_CLI+CO_NO_SDO_CLIENT)     /*  index for Heartbeat message */
     /* total number of transmitted CAN messages */
-    #define CO_TXCAN_NO_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
+    #define CO_TXCAN_NO_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO->noTPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
+    #define CO_TXCAN_MAX_MSGS (CO_NO_NMT_MASTER+CO_NO_SYNC+CO_NO_EMERGENCY+CO_NO_TPDO+CO_NO_SDO_SERVER+CO_NO_SDO_CLIENT+1)
 
 
 #ifdef CO_USE_GLOBALS
     static CO_CANmodule_t       COO_CANmodule;
-    static CO_CANrx_t           COO_CANmodule_rxArray0[CO_RXCAN_NO_MSGS];
-    static CO_CANtx_t           COO_CANmodule_txArray0[CO_TXCAN_NO_MSGS];
+    static CO_CANrx_t           COO_CANmodule_rxArray0[CO_RXCAN_MAX_MSGS];
+    static CO_CANtx_t           COO_CANmodule_txArray0[CO_TXCAN_MAX_MSGS];
     static CO_SDO_t             COO_SDO[CO_NO_SDO_SERVER];
-    static CO_OD_extension_t    COO_SDO_ODExtensions[CO_OD_NoOfElements];
+    static CO_OD_extension_t    COO_SDO_ODExtensions[CO_OD_MaxNoOfElements];
     static CO_EM_t              COO_EM;
     static CO_EMpr_t            COO_EMpr;
     static CO_NMT_t             COO_NMT;
@@ -139,8 +142,8 @@
     static CO_TPDO_t            COO_TPDO[CO_NO_TPDO];
     static CO_HBconsumer_t      COO_HBcons;
     static CO_HBconsNode_t      COO_HBcons_monitoredNodes[CO_NO_HB_CONS];
-#if CO_NO_SDO_CLIENT == 1
-    static CO_SDOclient_t       COO_SDOclient;
+#if CO_NO_SDO_CLIENT > 0
+    static CO_SDOclient_t       COO_SDOclient[CO_NO_SDO_CLIENT];
 #endif
 #if CO_NO_TRACE > 0
     static CO_trace_t           COO_trace[CO_NO_TRACE];
@@ -214,16 +217,23 @@ CO_ReturnError_t CO_init(
         return CO_ERROR_PARAMETERS;
     }
 
-#if CO_NO_SDO_CLIENT == 1
+#if CO_NO_SDO_CLIENT > 0
     if(sizeof(OD_SDOClientParameter_t) != sizeof(CO_SDOclientPar_t)){
         return CO_ERROR_PARAMETERS;
     }
     #endif
 
 
+    /* Build the object dictionary with the PDOs registered since CO_configure() */
+    if(!CO_OD_build()){
+        return CO_ERROR_OUT_OF_MEMORY;
+    }
+
     /* Initialize CANopen object */
 #ifdef CO_USE_GLOBALS
     CO = &COO;
+    CO->noRPDO                          = CO_noRPDO;
+    CO->noTPDO                          = CO_noTPDO;
 
     CO->CANmodule[0]                    = &COO_CANmodule;
     CO_CANmodule_rxArray0               = &COO_CANmodule_rxArray0[0];
@@ -241,8 +251,9 @@ CO_ReturnError_t CO_init(
         CO->TPDO[i]                     = &COO_TPDO[i];
     CO->HBcons                          = &COO_HBcons;
     CO_HBcons_monitoredNodes            = &COO_HBcons_monitoredNodes[0];
-  #if CO_NO_SDO_CLIENT == 1
-    CO->SDOclient                       = &COO_SDOclient;
+  #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++)
+        CO->SDOclient[i]                = &COO_SDOclient[i];
   #endif
   #if CO_NO_TRACE > 0
     for(i=0; i<CO_NO_TRACE; i++) {
@@ -255,6 +266,10 @@ CO_ReturnError_t CO_init(
 #else
     if(CO == NULL){    /* Use malloc only once */
         CO = &COO;
+        CO->noRPDO                          = CO_noRPDO;
+        CO->noTPDO                          = CO_noTPDO;
+        CO_noRPDOallocated                  = CO_noRPDO;
+        CO_noTPDOallocated                  = CO_noTPDO;
         CO->CANmodule[0]                    = (CO_CANmodule_t *)    calloc(1, sizeof(CO_CANmodule_t));
         CO_CANmodule_rxArray0               = (CO_CANrx_t *)        calloc(CO_RXCAN_NO_MSGS, sizeof(CO_CANrx_t));
         CO_CANmodule_txArray0               = (CO_CANtx_t *)        calloc(CO_TXCAN_NO_MSGS, sizeof(CO_CANtx_t));
@@ -266,16 +281,18 @@ CO_ReturnError_t CO_init(
         CO->emPr                            = (CO_EMpr_t *)         calloc(1, sizeof(CO_EMpr_t));
         CO->NMT                             = (CO_NMT_t *)          calloc(1, sizeof(CO_NMT_t));
         CO->SYNC                            = (CO_SYNC_t *)         calloc(1, sizeof(CO_SYNC_t));
-        for(i=0; i<CO_NO_RPDO; i++){
+        for(i=0; i<CO->noRPDO; i++){
             CO->RPDO[i]                     = (CO_RPDO_t *)         calloc(1, sizeof(CO_RPDO_t));
         }
-        for(i=0; i<CO_NO_TPDO; i++){
+        for(i=0; i<CO->noTPDO; i++){
             CO->TPDO[i]                     = (CO_TPDO_t *)         calloc(1, sizeof(CO_TPDO_t));
         }
         CO->HBcons                          = (CO_HBconsumer_t *)   calloc(1, sizeof(CO_HBconsumer_t));
         CO_HBcons_monitoredNodes            = (CO_HBconsNode_t *)   calloc(CO_NO_HB_CONS, sizeof(CO_HBconsNode_t));
-      #if CO_NO_SDO_CLIENT == 1
-        CO->SDOclient                       = (CO_SDOclient_t *)    calloc(1, sizeof(CO_SDOclient_t));
+      #if CO_NO_SDO_CLIENT > 0
+        for(i=0; i<CO_NO_SDO_CLIENT; i++){
+            CO->SDOclient[i]                = (CO_SDOclient_t *)    calloc(1, sizeof(CO_SDOclient_t));
+        }
       #endif
       #if CO_NO_TRACE > 0
         for(i=0; i<CO_NO_TRACE; i++) {
@@ -290,6 +307,14 @@ CO_ReturnError_t CO_init(
         }
       #endif
     }
+    else if(CO_noRPDO > CO_noRPDOallocated || CO_noTPDO > CO_noTPDOallocated){
+        /* More PDOs registered than at the first CO_init(): CO_delete() is required */
+        return CO_ERROR_PARAMETERS;
+    }
+    else{
+        CO->noRPDO                          = CO_noRPDO;
+        CO->noTPDO                          = CO_noTPDO;
+    }
 
     CO_memoryUsed = sizeof(CO_CANmodule_t)
                   + sizeof(CO_CANrx_t) * CO_RXCAN_NO_MSGS
@@ -300,12 +325,12 @@ CO_ReturnError_t CO_init(
                   + sizeof(CO_EMpr_t)
                   + sizeof(CO_NMT_t)
                   + sizeof(CO_SYNC_t)
-                  + sizeof(CO_RPDO_t) * CO_NO_RPDO
-                  + sizeof(CO_TPDO_t) * CO_NO_TPDO
+                  + sizeof(CO_RPDO_t) * CO->noRPDO
+                  + sizeof(CO_TPDO_t) * CO->noTPDO
                   + sizeof(CO_HBconsumer_t)
                   + sizeof(CO_HBconsNode_t) * CO_NO_HB_CONS
-  #if CO_NO_SDO_CLIENT == 1
-                  + sizeof(CO_SDOclient_t)
+  #if CO_NO_SDO_CLIENT > 0
+                  + sizeof(CO_SDOclient_t) * CO_NO_SDO_CLIENT
   #endif
                   + 0;
   #if CO_NO_TRACE > 0
@@ -327,16 +352,18 @@ CO_ReturnError_t CO_init(
     if(CO->emPr                         == NULL) errCnt++;
     if(CO->NMT                          == NULL) errCnt++;
     if(CO->SYNC                         == NULL) errCnt++;
-    for(i=0; i<CO_NO_RPDO; i++){
+    for(i=0; i<CO->noRPDO; i++){
         if(CO->RPDO[i]                  == NULL) errCnt++;
     }
-    for(i=0; i<CO_NO_TPDO; i++){
+    for(i=0; i<CO->noTPDO; i++){
         if(CO->TPDO[i]                  == NULL) errCnt++;
     }
     if(CO->HBcons                       == NULL) errCnt++;
     if(CO_HBcons_monitoredNodes         == NULL) errCnt++;
-  #if CO_NO_SDO_CLIENT == 1
-    if(CO->SDOclient                    == NULL) errCnt++;
+  #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        if(CO->SDOclient[i]             == NULL) errCnt++;
+    }
   #endif
   #if CO_NO_TRACE > 0
     for(i=0; i<CO_NO_TRACE; i++) {
@@ -459,7 +486,7 @@ CO_ReturnError_t CO_init(
 
     if(err){CO_delete(CANbaseAddress); return err;}
 
-    for(i=0; i<CO_NO_RPDO; i++){
+    for(i=0; i<CO->noRPDO; i++){
         CO_CANmodule_t *CANdevRx = CO->CANmodule[0];
         uint16_t CANdevRxIdx = CO_RXCAN_RPDO + i;
         err = CO_RPDO_init(
@@ -480,7 +507,7 @@ CO_ReturnError_t CO_init(
         if(err){CO_delete(CANbaseAddress); return err;}
     }
 
-    for(i=0; i<CO_NO_TPDO; i++){
+    for(i=0; i<CO->noTPDO; i++){
         err = CO_TPDO_init(
                 CO->TPDO[i],
                 CO->em,
@@ -513,17 +540,19 @@ CO_ReturnError_t CO_init(
     if(err){CO_delete(CANbaseAddress); return err;}
 
 
-#if CO_NO_SDO_CLIENT == 1
-    err = CO_SDOclient_init(
-            CO->SDOclient,
-            CO->SDO[0],
-            (CO_SDOclientPar_t*) &OD_SDOClientParameter[0],
-            CO->CANmodule[0],
-            CO_RXCAN_SDO_CLI,
-            CO->CANmodule[0],
-            CO_TXCAN_SDO_CLI);
+#if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        err = CO_SDOclient_init(
+                CO->SDOclient[i],
+                CO->SDO[0],
+                (CO_SDOclientPar_t*) &OD_SDOClientParameter[i],
+                CO->CANmodule[0],
+                CO_RXCAN_SDO_CLI+i,
+                CO->CANmodule[0],
+                CO_TXCAN_SDO_CLI+i);
 
-    if(err){CO_delete(CANbaseAddress); return err;}
+        if(err){CO_delete(CANbaseAddress); return err;}
+    }
 #endif
 
 
@@ -570,17 +599,23 @@ void CO_delete(int32_t CANbaseAddress){
           free(CO_traceValueBuffers[i]);
       }
   #endif
-  #if CO_NO_SDO_CLIENT == 1
-    free(CO->SDOclient);
+  #if CO_NO_SDO_CLIENT > 0
+    for(i=0; i<CO_NO_SDO_CLIENT; i++){
+        free(CO->SDOclient[i]);
+    }
   #endif
     free(CO_HBcons_monitoredNodes);
     free(CO->HBcons);
-    for(i=0; i<CO_NO_RPDO; i++){
+    for(i=0; i<CO_noRPDOallocated; i++){
         free(CO->RPDO[i]);
+        CO->RPDO[i] = NULL;
     }
-    for(i=0; i<CO_NO_TPDO; i++){
+    for(i=0; i<CO_noTPDOallocated; i++){
         free(CO->TPDO[i]);
+        CO->TPDO[i] = NULL;
     }
+    CO_noRPDOallocated = 0;
+    CO_noTPDOallocated = 0;
     free(CO->SYNC);
     free(CO->NMT);
     free(CO->emPr);
@@ -675,7 +710,8 @@ bool_t CO_process_SYNC_RPDO(
             break;
     }
 
-    for(i=0; i<CO_NO_RPDO; i++){
+    /* Only the registered RPDOs, not the whole CO_NO_RPDO table */
+    for(i=0; i<CO->noRPDO; i++){
         CO_RPDO_process(CO->RPDO[i], syncWas);
     }
 
@@ -692,8 +728,35 @@ void CO_process_TPDO(
     int16_t i;
 
     /* Verify PDO Change Of State and process PDOs */
-    for(i=0; i<CO_NO_TPDO; i++){
+    for(i=0; i<CO->noTPDO; i++){
         if(!CO->TPDO[i]->sendRequest) CO->TPDO[i]->sendRequest = CO_TPDOisCOS(CO->TPDO[i]);
         CO_TPDO_process(CO->TPDO[i], CO->SYNC, syncWas, timeDifference_us);
     }
 }
+
+
+/******************************************************************************/
+uint16_t CO_flush_TPDO(
+        CO_t                   *CO)
+{
+    int16_t i;
+    uint16_t sent = 0;
+
+    for(i=0; i<CO->noTPDO; i++){
+        CO_TPDO_t *TPDO = CO->TPDO[i];
+
+        if(!TPDO->valid || *TPDO->operatingState != CO_NMT_OPERATIONAL ||
+           TPDO->TPDOCommPar->transmissionType < 253 || TPDO->inhibitTimer != 0){
+            continue;
+        }
+        if(!TPDO->sendRequest) TPDO->sendRequest = CO_TPDOisCOS(TPDO);
+        if(TPDO->sendRequest && CO_TPDOsend(TPDO) == CO_ERROR_NO){
+            /* as CO_TPDO_process() */
+            TPDO->inhibitTimer = ((uint32_t) TPDO->TPDOCommPar->inhibitTime) * 100;
+            TPDO->eventTimer = ((uint32_t) TPDO->TPDOCommPar->eventTimer) * 1000;
+            sent++;
+        }
+    }
+
+    return sent;
+}
@@ -83,7 +83,7 @@ extern "C" {
     #include "CO_SYNC.h"
     #include "CO_PDO.h"
     #include "CO_HBconsumer.h"
-#if CO_NO_SDO_CLIENT == 1
+#if CO_NO_SDO_CLIENT > 0
     #include "CO_SDOmaster.h"
 #endif
 #if CO_NO_TRACE > 0
@@ -130,9 +130,11 @@ typedef struct{
     CO_SYNC_t          *SYNC;           /**< SYNC object */
     CO_RPDO_t          *RPDO[CO_NO_RPDO];/**< RPDO objects */
     CO_TPDO_t          *TPDO[CO_NO_TPDO];/**< TPDO objects */
+    uint16_t            noRPDO;         /**< Number of RPDO objects in use (registered before CO_init) */
+    uint16_t            noTPDO;         /**< Number of TPDO objects in use (registered before CO_init) */
     CO_HBconsumer_t    *HBcons;         /**<  Heartbeat consumer object*/
-#if CO_NO_SDO_CLIENT == 1
-    CO_SDOclient_t     *SDOclient;      /**< SDO client object */
+#if CO_NO_SDO_CLIENT > 0
+    CO_SDOclient_t     *SDOclient[CO_NO_SDO_CLIENT]; /**< SDO client objects */
 #endif
 #if CO_NO_TRACE > 0
     CO_trace_t         *trace[CO_NO_TRACE]; /**< Trace object for monitoring variables */
@@ -242,6 +244,22 @@ void CO_process_TPDO(
         bool_t                  syncWas,
         uint32_t                timeDifference_us);
 
+
+/**
+ * Send now the event driven TPDOs (transmission type >= 253) whose mapped
+ * data changed, rather than at the next CO_process_TPDO().
+ *
+ * Typically called by the application right after writing new outputs.
+ * Inhibit times are respected; synchronous TPDOs and event timers are left
+ * to CO_process_TPDO(). Must be called with OD locked (CO_LOCK_OD).
+ *
+ * @param CO This object.
+ *
+ * @return Number of TPDOs sent.
+ */
+uint16_t CO_flush_TPDO(
+        CO_t                   *CO);
+
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
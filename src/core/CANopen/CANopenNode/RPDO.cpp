@@ -21,10 +21,24 @@ RPDO::RPDO(UNSIGNED32 COBID, UNSIGNED8 transmissionType, void *dataEntry[], UNSI
     }
 
     // Then set up the OD
-    CO_setRPDO(&commParam, &mappingParam, commRecord, dataRecord, mappingRecord);
+    myRPDONum = CO_setRPDO(&commParam, &mappingParam, commRecord, dataRecord, mappingRecord);
 
 }
 
 UNSIGNED32 RPDO::getCOBID(){
     return myCOBID;
 }
+
+uint64_t RPDO::getTimestamp(){
+    if (CO == NULL || myRPDONum < 1 || myRPDONum > CO->noRPDO) {
+        return 0;
+    }
+    return __atomic_load_n(&CO->RPDO[myRPDONum - 1]->timestamp, __ATOMIC_RELAXED);
+}
+
+uint32_t RPDO::getRxCount(){
+    if (CO == NULL || myRPDONum < 1 || myRPDONum > CO->noRPDO) {
+        return 0;
+    }
+    return CO->RPDO[myRPDONum - 1]->rxCount;
+}
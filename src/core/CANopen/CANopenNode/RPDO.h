@@ -24,6 +24,7 @@ class RPDO {
         UNSIGNED8 nullData = 0;
         UNSIGNED8 lengthData = 0;
         UNSIGNED32 myCOBID =0;
+        int myRPDONum = -1; // Number returned by CO_setRPDO (index in CO->RPDO + 1)
 
     public:
     // Storage for the configuration parameters for the RPDO
@@ -78,6 +79,20 @@ class RPDO {
       * @return UNSIGNED32 COB-ID of this RPDO
       */
      UNSIGNED32 getCOBID();
+
+     /**
+      * \brief returns the kernel receive time of the data last copied from this RPDO to the mapped variables
+      *
+      * @return uint64_t time in ns (CLOCK_MONOTONIC), 0 if nothing received yet
+      */
+     uint64_t getTimestamp();
+
+     /**
+      * \brief returns the number of messages copied from this RPDO to the mapped variables since the start
+      *
+      * @return uint32_t messages count (wraps around), 0 if nothing received yet
+      */
+     uint32_t getRxCount();
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "SDO.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "RTConfig.h"
+#include "StartupTrace.h"
+
+
+int sdoDownload(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, UNSIGNED8 *data, UNSIGNED32 length) {
+    spdlog::trace("SDO write node {} 0x{:04X} {} ({} bytes)", nodeID, index, subIndex, length);
+#ifndef NOROBOT
+    UNSIGNED32 abortCode = 0;
+    if (cancomm_sdoWrite(nodeID, index, subIndex, data, length, &abortCode) != 0) {
+        spdlog::error("SDO write node {} 0x{:04X} {}: ERROR => SDO client internal error", nodeID, index, subIndex);
+        return -1;
+    }
+    if (abortCode != 0) {
+        spdlog::error("SDO write node {} 0x{:04X} {}: ERROR => {}", nodeID, index, subIndex, sdoAbortCodeDescription(abortCode));
+        return -1;
+    }
+#else
+    spdlog::trace("VCAN OK no reply.");
+#endif
+    return 0;
+}
+
+int sdoUpload(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, UNSIGNED8 *data, UNSIGNED32 length, UNSIGNED32 *receivedLength) {
+    spdlog::trace("SDO read node {} 0x{:04X} {} ({} bytes)", nodeID, index, subIndex, length);
+#ifndef NOROBOT
+    UNSIGNED32 abortCode = 0;
+    UNSIGNED32 rxLength = 0;
+    if (cancomm_sdoRead(nodeID, index, subIndex, data, length, &rxLength, &abortCode) != 0) {
+        spdlog::error("SDO read node {} 0x{:04X} {}: ERROR => SDO client internal error", nodeID, index, subIndex);
+        return -1;
+    }
+    if (abortCode != 0) {
+        spdlog::error("SDO read node {} 0x{:04X} {}: ERROR => {}", nodeID, index, subIndex, sdoAbortCodeDescription(abortCode));
+        return -1;
+    }
+    if (receivedLength != NULL) {
+        *receivedLength = rxLength;
+    } else if (rxLength != length) {
+        spdlog::error("SDO read node {} 0x{:04X} {}: ERROR => received {} bytes, expected {}", nodeID, index, subIndex, rxLength, length);
+        return -1;
+    }
+#else
+    memset(data, 0, length);
+    if (receivedLength != NULL) {
+        *receivedLength = length;
+    }
+    spdlog::trace("VCAN OK no reply.");
+#endif
+    return 0;
+}
+
+int nmtCommand(UNSIGNED8 nodeID, CO_NMT_command_t command) {
+    spdlog::trace("NMT command 0x{:02X} to node {}", (int)command, nodeID);
+#ifndef NOROBOT
+    // NMT master has a single transmit buffer, shared by the concurrent sequences
+    static std::mutex NMTmutex;
+    std::lock_guard<std::mutex> lock(NMTmutex);
+    if (CO_sendNMTcommand(CO, command, nodeID) != 0) {
+        spdlog::error("NMT command 0x{:02X} to node {}: ERROR", (int)command, nodeID);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+bool sdoRunParallel(const std::vector<std::function<bool()>> &sequences) {
+    std::atomic<unsigned int> next(0);
+    std::atomic<bool> ok(true);
+    std::vector<std::thread> workers;
+    unsigned int noWorkers = std::min<unsigned int>(sequences.size(), CO_NO_SDO_CLIENT);
+
+    for (unsigned int i = 0; i < noWorkers; i++) {
+        workers.emplace_back([&] {
+            // Blocked on SDO round trips: do not compete with the control loop (created from rt_control_thread)
+            applyNonRTThreadConfig("sdo_parallel");
+            for (unsigned int n = next++; n < sequences.size(); n = next++) {
+                StartupSpan span("sdoRunParallel sequence " + std::to_string(n));
+                if (!sequences[n]()) {
+                    ok = false;
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    return ok;
+}
+
+std::string sdoAbortCodeDescription(UNSIGNED32 abortCode) {
+    char code[11];
+    snprintf(code, sizeof(code), "0x%08X", abortCode);
+    auto it = SDO_Standard_Error.find(code);
+    if (it != SDO_Standard_Error.end()) {
+        return it->second + " (" + code + ")";
+    }
+    return std::string("Unknown SDO abort code (") + code + ")";
+}
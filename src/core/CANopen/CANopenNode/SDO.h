@@ -0,0 +1,152 @@
+/**
+ * \file SDO.h
+ * \brief  Typed SDO reads and writes to remote nodes, and NMT commands
+ *
+ * Values are converted to/from the CANopen (little endian) byte order and passed to
+ * the SDO client directly (cancomm_sdoWrite/cancomm_sdoRead): no command string is built or parsed.
+ * Errors are logged with the description of the SDO abort code.
+ *
+ * \version 0.1
+ *
+ */
+
+#ifndef SDO_H_INCLUDED
+#define SDO_H_INCLUDED
+
+#include <CANopen.h>
+#include <CO_command.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "logging.h"
+
+/**
+ * Map of standard SDOs return error codes
+ */
+static std::map<std::string, std::string> SDO_Standard_Error = {
+    {"0x05030000", "Toggle bit not changed"},
+    {"0x05040000", "SDO protocol timed out"},
+    {"0x05040001", "Client/server command specifier not valid or unknown"},
+    {"0x05040002", "Invalid block size (block mode only)"},
+    {"0x05040003", "Invalid sequence number (block mode only)"},
+    {"0x05040004", "CRC error (block mode only)"},
+    {"0x05040005", "Out of memory"},
+    {"0x06010000", "Access to this object is not supported"},
+    {"0x06010002", "Attempt to write to a Read_Only parameter"},
+    {"0x06020000", "The object is not found in the object directory"},
+    {"0x06040041", "The object can not be mapped into the PDO"},
+    {"0x06040042", "The number and/or length of mapped objects would exceed the PDO length"},
+    {"0x06040043", "General parameter incompatibility"},
+    {"0x06040047", "General internal error in device"},
+    {"0x06060000", "Access interrupted due to hardware error"},
+    {"0x06070010", "Data type or parameter length do not agree or are unknown"},
+    {"0x06070012", "Data type does not agree, parameter length too great"},
+    {"0x06070013", "Data type does not agree, parameter length too short"},
+    {"0x06090011", "Sub-index not present"},
+    {"0x06090030", "General value range error"},
+    {"0x06090031", "Value range error: parameter value too great"},
+    {"0x06090032", "Value range error: parameter value too small"},
+    {"0x060A0023", "Resource not available"},
+    {"0x08000021", "Access not possible due to local application"},
+    {"0x08000022", "Access not possible due to current device status"}};
+
+/**
+ * \brief Writes data to an object of a remote node (blocking)
+ *
+ * \param nodeID Node-ID of the remote node
+ * \param index Index of the object in the remote node Object Dictionary
+ * \param subIndex Sub-index of the object
+ * \param data Data to write, in CANopen byte order
+ * \param length Length of data (in bytes)
+ * \return int 0 on success, -1 on failure (error is logged). Always 0 with NOROBOT (no reply check).
+ */
+int sdoDownload(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, UNSIGNED8 *data, UNSIGNED32 length);
+
+/**
+ * \brief Reads an object of a remote node (blocking). The object must be exactly length bytes long,
+ * unless receivedLength is given.
+ *
+ * \param nodeID Node-ID of the remote node
+ * \param index Index of the object in the remote node Object Dictionary
+ * \param subIndex Sub-index of the object
+ * \param data Buffer receiving the data, in CANopen byte order
+ * \param length Expected length of the object (size of data, in bytes)
+ * \param receivedLength If not NULL, objects of any length up to length are accepted and their length returned here
+ * \return int 0 on success, -1 on failure (error is logged). Always 0 with NOROBOT, data is then zeroed.
+ */
+int sdoUpload(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, UNSIGNED8 *data, UNSIGNED32 length,
+              UNSIGNED32 *receivedLength = NULL);
+
+/**
+ * \brief Sends an NMT command (e.g. CO_NMT_ENTER_OPERATIONAL) to a remote node
+ *
+ * \param nodeID Node-ID of the remote node (0 for all nodes)
+ * \param command NMT command
+ * \return int 0 on success, -1 on failure. Always 0 with NOROBOT.
+ */
+int nmtCommand(UNSIGNED8 nodeID, CO_NMT_command_t command);
+
+/**
+ * \brief Runs SDO sequences concurrently (e.g. the configuration of each node) and waits for all of them
+ *
+ * Each sequence runs in its own thread (at most CO_NO_SDO_CLIENT at once). The SDO master has one
+ * channel per node (see sdoClientChannel()), so the transfers of sequences to different nodes overlap
+ * on the bus and the whole takes about as long as the longest sequence instead of the sum.
+ * Transfers to a same node are still serialised.
+ *
+ * \param sequences Functions issuing the SDOs, returning true on success
+ * \return true if all sequences succeeded
+ */
+bool sdoRunParallel(const std::vector<std::function<bool()>> &sequences);
+
+/**
+ * \brief Returns the description of an SDO abort code, as "description (0xXXXXXXXX)"
+ *
+ */
+std::string sdoAbortCodeDescription(UNSIGNED32 abortCode);
+
+/**
+ * \brief Writes an integer value to an object of a remote node, e.g. sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 4)
+ *
+ * The type T gives the size of the object (e.g. UNSIGNED16 for a u16).
+ *
+ * \return int 0 on success, -1 on failure
+ */
+template <typename T>
+int sdoWrite(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, T value) {
+    static_assert(std::is_integral<T>::value, "sdoWrite only supports integer types");
+    typedef typename std::make_unsigned<T>::type U;
+    UNSIGNED8 data[sizeof(T)];
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+        data[i] = (UNSIGNED8)((U)value >> (8 * i));
+    }
+    return sdoDownload(nodeID, index, subIndex, data, sizeof(T));
+}
+
+/**
+ * \brief Reads an integer object of a remote node, e.g. sdoRead<UNSIGNED16>(NodeID, 0x6041, 0, statusWord)
+ *
+ * \param value Read value. Unchanged on failure.
+ * \return int 0 on success, -1 on failure (including an object size different than sizeof(T))
+ */
+template <typename T>
+int sdoRead(UNSIGNED8 nodeID, UNSIGNED16 index, UNSIGNED8 subIndex, T &value) {
+    static_assert(std::is_integral<T>::value, "sdoRead only supports integer types");
+    typedef typename std::make_unsigned<T>::type U;
+    UNSIGNED8 data[sizeof(T)];
+    if (sdoUpload(nodeID, index, subIndex, data, sizeof(T)) != 0) {
+        return -1;
+    }
+    U v = 0;
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+        v |= (U)data[i] << (8 * i);
+    }
+    value = (T)v;
+    return 0;
+}
+
+#endif
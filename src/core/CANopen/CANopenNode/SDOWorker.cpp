@@ -0,0 +1,117 @@
+#include "SDOWorker.h"
+
+#include "RTConfig.h"
+#include "logging.h"
+
+static_assert((SDO_WORKER_QUEUE_SIZE & (SDO_WORKER_QUEUE_SIZE - 1)) == 0, "SDO_WORKER_QUEUE_SIZE must be a power of 2");
+
+SDOWorker &SDOWorker::instance() {
+    static SDOWorker worker;
+    return worker;
+}
+
+SDOWorker::SDOWorker() : enqueuePos(0), dequeuePos(0), submitting(0), running(true) {
+    for (size_t i = 0; i < SDO_WORKER_QUEUE_SIZE; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    sem_init(&jobsAvailable, 0, 0);
+    thread = std::thread(&SDOWorker::process, this);
+}
+
+void SDOWorker::stop() {
+    running = false;
+    // Submits which saw running before it was cleared: let them publish their job, failed below
+    while (submitting.load() > 0) {
+        std::this_thread::yield();
+    }
+    sem_post(&jobsAvailable);
+    if (thread.joinable()) {
+        thread.join();
+    }
+    // Jobs not run: complete their futures rather than leaving them to a broken promise
+    Slot *slot = &slots[dequeuePos & (SDO_WORKER_QUEUE_SIZE - 1)];
+    while (slot->sequence.load(std::memory_order_acquire) == dequeuePos + 1) {
+        Job job = std::move(slot->job);
+        slot->sequence.store(dequeuePos + SDO_WORKER_QUEUE_SIZE, std::memory_order_release);
+        dequeuePos++;
+        if (job.onCompletion) {
+            job.onCompletion(false);
+        }
+        job.result.set_value(false);
+        slot = &slots[dequeuePos & (SDO_WORKER_QUEUE_SIZE - 1)];
+    }
+}
+
+SDOWorker::~SDOWorker() {
+    stop();
+    sem_destroy(&jobsAvailable);
+}
+
+std::future<bool> SDOWorker::submit(std::function<bool()> job, std::function<void(bool)> onCompletion) {
+    // In progress until the job is published (or dropped): stop() waits for it before failing the queued jobs.
+    // Both seq_cst: either running is seen cleared here, or submitting is seen by stop().
+    submitting.fetch_add(1);
+    if (!running) {
+        submitting.fetch_sub(1);
+        spdlog::error("SDOWorker: stopped, job dropped");
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future();
+    }
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+        slot = &slots[pos & (SDO_WORKER_QUEUE_SIZE - 1)];
+        intptr_t diff = (intptr_t)slot->sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            submitting.fetch_sub(1);
+            spdlog::error("SDOWorker: queue full ({} jobs), job dropped", SDO_WORKER_QUEUE_SIZE);
+            std::promise<bool> failed;
+            failed.set_value(false);
+            return failed.get_future();
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->job.run = std::move(job);
+    slot->job.onCompletion = std::move(onCompletion);
+    slot->job.result = std::promise<bool>();
+    std::future<bool> result = slot->job.result.get_future();
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    sem_post(&jobsAvailable);
+    submitting.fetch_sub(1);
+    return result;
+}
+
+void SDOWorker::process() {
+    // Not a real-time task: do not inherit the policy and CPUs of the (control) thread which created the worker
+    applyNonRTThreadConfig("sdo_worker");
+
+    while (running) {
+        if (sem_wait(&jobsAvailable) != 0) {
+            continue;  // EINTR
+        }
+        // The job posted may be a later one: the producer of this slot is about to publish it
+        Slot *slot = &slots[dequeuePos & (SDO_WORKER_QUEUE_SIZE - 1)];
+        while (slot->sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+            if (!running) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        Job job = std::move(slot->job);
+        slot->sequence.store(dequeuePos + SDO_WORKER_QUEUE_SIZE, std::memory_order_release);
+        dequeuePos++;
+
+        bool ok = job.run();
+        if (job.onCompletion) {
+            job.onCompletion(ok);
+        }
+        job.result.set_value(ok);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * \file SDOWorker.h
+ * \brief  Non real-time thread running SDO jobs (sequences of blocking SDOs) submitted from the control loop
+ *
+ * A job is queued without locking or blocking the caller (bounded lock-free queue) and completes through
+ * a future, which the control loop can poll, and/or a callback, called from the worker thread.
+ *
+ * \version 0.1
+ *
+ */
+
+#ifndef SDOWORKER_H_INCLUDED
+#define SDOWORKER_H_INCLUDED
+
+#include <semaphore.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+
+#ifndef SDO_WORKER_QUEUE_SIZE
+#define SDO_WORKER_QUEUE_SIZE 32 /*!< Maximum number of queued SDO jobs (power of 2) */
+#endif
+
+/**
+ * \brief Runs SDO jobs one after the other on a dedicated SCHED_OTHER thread (started on first use)
+ *
+ * e.g. in a state entry(), without blocking the control thread:
+ * \code
+ * configured = SDOWorker::instance().submit([this] { return drive->initTorqueControl(); });
+ * \endcode
+ * and in during(): if (configured.wait_for(std::chrono::seconds(0)) == std::future_status::ready) ...
+ */
+class SDOWorker {
+   public:
+    /**
+     * \brief The worker, its thread is created on the first call (preferably at initialisation, not from the control loop)
+     */
+    static SDOWorker &instance();
+
+    /**
+     * \brief Queue a job, never blocks on the bus or on a lock. It does allocate (the job state shared with the future,
+     * and captures not fitting in std::function): fine for an occasional call from the control loop (e.g. a control
+     * mode change), not to call every period.
+     *
+     * \param job Function issuing the SDOs, returning true on success. Run on the worker thread.
+     * \param onCompletion Optional function called on the worker thread with the job result
+     * \return std::future<bool> job result. Immediately false if the queue is full.
+     */
+    std::future<bool> submit(std::function<bool()> job, std::function<void(bool)> onCompletion = nullptr);
+
+    /**
+     * \brief Stops the worker at the end of the program, while the CAN processing still runs: waits for the job in
+     * progress and for the submits in progress, fails (false) the queued jobs and the later submits.
+     */
+    void stop();
+
+    ~SDOWorker();
+
+   private:
+    SDOWorker();
+    void process();
+
+    struct Job {
+        std::function<bool()> run;
+        std::function<void(bool)> onCompletion;
+        std::promise<bool> result;
+    };
+    // Bounded multi-producer queue (D. Vyukov): a slot is free for the producer at position pos when
+    // sequence == pos, and holds a job for the consumer when sequence == pos + 1
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Job job;
+    };
+    Slot slots[SDO_WORKER_QUEUE_SIZE];
+    std::atomic<size_t> enqueuePos;
+    size_t dequeuePos;  // single consumer: the worker thread
+    std::atomic<int> submitting;  // submit() calls between their running check and their job publication
+
+    sem_t jobsAvailable;
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+#endif
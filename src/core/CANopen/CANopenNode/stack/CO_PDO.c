@@ -80,6 +80,7 @@ static void CO_PDO_receive(void *object, const CO_CANrxMsg_t *msg){
             RPDO->CANrxData[1][5] = msg->data[5];
             RPDO->CANrxData[1][6] = msg->data[6];
             RPDO->CANrxData[1][7] = msg->data[7];
+            __atomic_store_n(&RPDO->CANrxTimestamp[1], RPDO->CANdevRx->rxTimestamp, __ATOMIC_RELAXED);
 
             RPDO->CANrxNew[1] = true;
         }
@@ -93,6 +94,7 @@ static void CO_PDO_receive(void *object, const CO_CANrxMsg_t *msg){
             RPDO->CANrxData[0][5] = msg->data[5];
             RPDO->CANrxData[0][6] = msg->data[6];
             RPDO->CANrxData[0][7] = msg->data[7];
+            __atomic_store_n(&RPDO->CANrxTimestamp[0], RPDO->CANdevRx->rxTimestamp, __ATOMIC_RELAXED);
 
             RPDO->CANrxNew[0] = true;
         }
@@ -297,8 +299,8 @@ static CO_SDO_abortCode_t CO_PDOfindMap(
  *
  * Function is called from communication reset or when parameter changes.
  *
- * Function configures following variables from CO_RPDO_t: _dataLength_ and
- * _mapPointer_.
+ * Function configures following variables from CO_RPDO_t: _dataLength_,
+ * _mapPointer_ and _mapPlan_.
  *
  * @param RPDO RPDO object.
  * @param noOfMappedObjects Number of mapped object (from OD).
@@ -353,6 +355,7 @@ static CO_SDO_abortCode_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedOb
     }
 
     RPDO->dataLength = length;
+    CO_PDOmapPlanInit(&RPDO->mapPlan, RPDO->mapPointer, length);
 
     return ret;
 }
@@ -364,7 +367,7 @@ static CO_SDO_abortCode_t CO_RPDOconfigMap(CO_RPDO_t* RPDO, uint8_t noOfMappedOb
  * Function is called from communication reset or when parameter changes.
  *
  * Function configures following variables from CO_TPDO_t: _dataLength_,
- * _mapPointer_ and _sendIfCOSFlags_.
+ * _mapPointer_, _mapPlan_ and _sendIfCOSFlags_.
  *
  * @param TPDO TPDO object.
  * @param noOfMappedObjects Number of mapped object (from OD).
@@ -420,6 +423,7 @@ static CO_SDO_abortCode_t CO_TPDOconfigMap(CO_TPDO_t* TPDO, uint8_t noOfMappedOb
     }
 
     TPDO->dataLength = length;
+    CO_PDOmapPlanInit(&TPDO->mapPlan, TPDO->mapPointer, length);
 
     return ret;
 }
@@ -759,6 +763,8 @@ CO_ReturnError_t CO_RPDO_init(
 
     /* configure communication and mapping */
     RPDO->CANrxNew[0] = RPDO->CANrxNew[1] = false;
+    __atomic_store_n(&RPDO->timestamp, 0U, __ATOMIC_RELAXED);
+    RPDO->rxCount = 0U;
     RPDO->CANdevRx = CANdevRx;
     RPDO->CANdevRxIdx = CANdevRxIdx;
 
@@ -827,6 +833,80 @@ CO_ReturnError_t CO_TPDO_init(
 }
 
 
+/******************************************************************************/
+void CO_PDOmapPlanInit(CO_PDOmapPlan_t *plan, uint8_t *const mapPointer[8], uint8_t dataLength){
+    CO_PDOsegment_t *seg = NULL;
+    uint8_t i;
+
+    plan->noOfSegments = 0;
+    plan->dataLength = dataLength;
+    for(i=0; i<dataLength; i++){
+        if(seg != NULL && mapPointer[i] == seg->pData + seg->length){
+            seg->length++;
+        }
+        else{
+            seg = &plan->segment[plan->noOfSegments++];
+            seg->pData = mapPointer[i];
+            seg->offset = i;
+            seg->length = 1;
+        }
+    }
+    plan->twoWords = plan->noOfSegments == 2 && plan->segment[0].length == 4 && plan->segment[1].length == 4;
+    /* A segment copy costs more than a byte copy: only fewer copies pay off */
+    plan->byteCopy = !plan->twoWords && plan->noOfSegments * 2 >= dataLength;
+}
+
+/* Copy with a constant size where possible, so it becomes a single load/store */
+static inline void CO_PDOcopy(uint8_t *dest, const uint8_t *src, uint8_t length){
+    switch(length){
+        case 1: *dest = *src; break;
+        case 2: memcpy(dest, src, 2); break;
+        case 4: memcpy(dest, src, 4); break;
+        case 8: memcpy(dest, src, 8); break;
+        default: memcpy(dest, src, length); break;
+    }
+}
+
+/******************************************************************************/
+void CO_PDOmapPlanUnpack(const CO_PDOmapPlan_t *plan, const uint8_t *data){
+    const CO_PDOsegment_t *seg = &plan->segment[0];
+
+    if(plan->twoWords){
+        memcpy(seg[0].pData, &data[0], 4);
+        memcpy(seg[1].pData, &data[4], 4);
+    }
+    else switch(plan->noOfSegments){
+        case 8: CO_PDOcopy(seg[7].pData, &data[seg[7].offset], seg[7].length);
+        case 7: CO_PDOcopy(seg[6].pData, &data[seg[6].offset], seg[6].length);
+        case 6: CO_PDOcopy(seg[5].pData, &data[seg[5].offset], seg[5].length);
+        case 5: CO_PDOcopy(seg[4].pData, &data[seg[4].offset], seg[4].length);
+        case 4: CO_PDOcopy(seg[3].pData, &data[seg[3].offset], seg[3].length);
+        case 3: CO_PDOcopy(seg[2].pData, &data[seg[2].offset], seg[2].length);
+        case 2: CO_PDOcopy(seg[1].pData, &data[seg[1].offset], seg[1].length);
+        case 1: CO_PDOcopy(seg[0].pData, &data[seg[0].offset], seg[0].length);
+    }
+}
+
+/******************************************************************************/
+void CO_PDOmapPlanPack(const CO_PDOmapPlan_t *plan, uint8_t *data){
+    const CO_PDOsegment_t *seg = &plan->segment[0];
+
+    if(plan->twoWords){
+        memcpy(&data[0], seg[0].pData, 4);
+        memcpy(&data[4], seg[1].pData, 4);
+    }
+    else switch(plan->noOfSegments){
+        case 8: CO_PDOcopy(&data[seg[7].offset], seg[7].pData, seg[7].length);
+        case 7: CO_PDOcopy(&data[seg[6].offset], seg[6].pData, seg[6].length);
+        case 6: CO_PDOcopy(&data[seg[5].offset], seg[5].pData, seg[5].length);
+        case 5: CO_PDOcopy(&data[seg[4].offset], seg[4].pData, seg[4].length);
+        case 4: CO_PDOcopy(&data[seg[3].offset], seg[3].pData, seg[3].length);
+        case 3: CO_PDOcopy(&data[seg[2].offset], seg[2].pData, seg[2].length);
+        case 2: CO_PDOcopy(&data[seg[1].offset], seg[1].pData, seg[1].length);
+        case 1: CO_PDOcopy(&data[seg[0].offset], seg[0].pData, seg[0].length);
+    }
+}
+
 /******************************************************************************/
 uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
 
@@ -854,9 +934,9 @@ uint8_t CO_TPDOisCOS(CO_TPDO_t *TPDO){
 //#define TPDO_CALLS_EXTENSION
 /******************************************************************************/
 int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
+#ifdef TPDO_CALLS_EXTENSION
     int16_t i;
-    uint8_t* pPDOdataByte;
-    uint8_t** ppODdataByte;
+#endif
 
 #ifdef TPDO_CALLS_EXTENSION
     if(TPDO->SDO->ODExtensions){
@@ -886,13 +966,17 @@ int16_t CO_TPDOsend(CO_TPDO_t *TPDO){
         }
     }
 #endif
-    i = TPDO->dataLength;
-    pPDOdataByte = &TPDO->CANtxBuff->data[0];
-    ppODdataByte = &TPDO->mapPointer[0];
-
     /* Copy data from Object dictionary. */
-    for(; i>0; i--) {
-        *(pPDOdataByte++) = **(ppODdataByte++);
+    if(TPDO->mapPlan.byteCopy){
+        uint8_t* pPDOdataByte = &TPDO->CANtxBuff->data[0];
+        uint8_t** ppODdataByte = &TPDO->mapPointer[0];
+        int16_t i;
+        for(i=TPDO->dataLength; i>0; i--) {
+            *(pPDOdataByte++) = **(ppODdataByte++);
+        }
+    }
+    else{
+        CO_PDOmapPlanPack(&TPDO->mapPlan, &TPDO->CANtxBuff->data[0]);
     }
 
     TPDO->sendRequest = 0;
@@ -918,20 +1002,26 @@ void CO_RPDO_process(CO_RPDO_t *RPDO, bool_t syncWas){
         }
 
         while(RPDO->CANrxNew[bufNo]){
+#ifdef RPDO_CALLS_EXTENSION
             int16_t i;
-            uint8_t* pPDOdataByte;
-            uint8_t** ppODdataByte;
-
-            i = RPDO->dataLength;
-            pPDOdataByte = &RPDO->CANrxData[bufNo][0];
-            ppODdataByte = &RPDO->mapPointer[0];
+#endif
 
             /* Copy data to Object dictionary. If between the copy operation CANrxNew
              * is set to true by receive thread, then copy the latest data again. */
             RPDO->CANrxNew[bufNo] = false;
-            for(; i>0; i--) {
-                **(ppODdataByte++) = *(pPDOdataByte++);
+            if(RPDO->mapPlan.byteCopy){
+                uint8_t* pPDOdataByte = &RPDO->CANrxData[bufNo][0];
+                uint8_t** ppODdataByte = &RPDO->mapPointer[0];
+                int16_t i;
+                for(i=RPDO->dataLength; i>0; i--) {
+                    **(ppODdataByte++) = *(pPDOdataByte++);
+                }
+            }
+            else{
+                CO_PDOmapPlanUnpack(&RPDO->mapPlan, &RPDO->CANrxData[bufNo][0]);
             }
+            __atomic_store_n(&RPDO->timestamp, __atomic_load_n(&RPDO->CANrxTimestamp[bufNo], __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+            RPDO->rxCount++;
 
 #ifdef RPDO_CALLS_EXTENSION
             if(RPDO->SDO->ODExtensions){
@@ -178,6 +178,36 @@ extern "C"
         uint32_t mappedObject8; /**< Same */
     } CO_TPDOMapPar_t;
 
+    /**
+ * Contiguous part of a PDO: one or more mapped objects whose Object Dictionary
+ * variables are adjacent in memory, copied with a single memcpy.
+ */
+    typedef struct
+    {
+        uint8_t *pData; /**< First byte of the Object Dictionary variable(s) */
+        uint8_t offset; /**< Offset of the first byte in the CAN message */
+        uint8_t length; /**< Number of bytes */
+    } CO_PDOsegment_t;
+
+    /**
+ * PDO mapping plan, compiled from _mapPointer_ by CO_RPDOconfigMap() and
+ * CO_TPDOconfigMap(). Replaces the copy of the PDO one byte at a time when
+ * it saves copies (segments of more than 2 bytes on average).
+ */
+    typedef struct
+    {
+        /** Number of segments, 0 if mapping is empty or wrong */
+        uint8_t noOfSegments;
+        /** Length of the PDO in bytes */
+        uint8_t dataLength;
+        /** True for the common 8 byte PDO made of two 4 byte segments */
+        bool_t twoWords;
+        /** True if the segments are not worth it (mostly 8 and 16 bit
+         * objects): PDO copied one byte at a time through _mapPointer_ */
+        bool_t byteCopy;
+        CO_PDOsegment_t segment[8]; /**< Segments in CAN message order */
+    } CO_PDOmapPlan_t;
+
     /**
  * RPDO object.
  */
@@ -200,10 +230,21 @@ extern "C"
         uint8_t dataLength;
         /** Pointers to 8 data objects, where PDO will be copied */
         uint8_t *mapPointer[8];
+        /** mapPointer merged into contiguous segments, used for the copy */
+        CO_PDOmapPlan_t mapPlan;
         /** Variable indicates, if new PDO message received from CAN bus. */
         volatile bool_t CANrxNew[2];
         /** 8 data bytes of the received message. */
         uint8_t CANrxData[2][8];
+        /** Receive time of the messages in CANrxData [ns, CLOCK_MONOTONIC].
+         * Accessed with __atomic builtins: a 64 bit access is not single copy
+         * atomic on 32 bit targets. */
+        uint64_t CANrxTimestamp[2];
+        /** Receive time of the data last copied to Object dictionary [ns, CLOCK_MONOTONIC], 0 if none yet.
+         * Accessed with __atomic builtins (read from other threads, see CANrxTimestamp). */
+        uint64_t timestamp;
+        /** Number of messages copied to Object dictionary (wraps around) */
+        volatile uint32_t rxCount;
         CO_CANmodule_t *CANdevRx; /**< From CO_RPDO_init() */
         uint16_t CANdevRxIdx;     /**< From CO_RPDO_init() */
     } CO_RPDO_t;
@@ -229,6 +270,8 @@ extern "C"
         uint8_t sendRequest;
         /** Pointers to 8 data objects, where PDO will be copied */
         uint8_t *mapPointer[8];
+        /** mapPointer merged into contiguous segments, used for the copy */
+        CO_PDOmapPlan_t mapPlan;
         /** Each flag bit is connected with one mapPointer. If flag bit
     is true, CO_TPDO_process() functiuon will send PDO if
     Change of State is detected on value pointed by that mapPointer */
@@ -340,6 +383,34 @@ extern "C" {
         uint16_t CANdevTxIdx);
 
 
+    /**
+ * Compile PDO mapping plan.
+ *
+ * Merges consecutive PDO bytes which point to consecutive bytes of memory into
+ * segments. Called from CO_RPDOconfigMap() and CO_TPDOconfigMap().
+ *
+ * @param plan Plan to fill.
+ * @param mapPointer Pointers to the Object Dictionary byte of each PDO byte.
+ * @param dataLength Length of the PDO, 0 for an empty or wrong mapping.
+ */
+    void CO_PDOmapPlanInit(CO_PDOmapPlan_t *plan, uint8_t *const mapPointer[8], uint8_t dataLength);
+
+    /**
+ * Copy received PDO data to the Object Dictionary variables of the plan.
+ *
+ * @param plan Mapping plan.
+ * @param data CAN message data.
+ */
+    void CO_PDOmapPlanUnpack(const CO_PDOmapPlan_t *plan, const uint8_t *data);
+
+    /**
+ * Copy the Object Dictionary variables of the plan to PDO data.
+ *
+ * @param plan Mapping plan.
+ * @param data CAN message data.
+ */
+    void CO_PDOmapPlanPack(const CO_PDOmapPlan_t *plan, uint8_t *data);
+
     /**
  * Verify Change of State of the PDO.
  *
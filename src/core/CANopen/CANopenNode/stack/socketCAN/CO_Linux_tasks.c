@@ -188,6 +188,8 @@ static struct {
     long                intervalns;
     long                intervalus;
     uint16_t           *maxTime;
+    void              (*pFunctRT)(bool_t syncWas);
+    void              (*pFunctStats)(long wakeupLatency_ns, long processing_ns);
 } taskRT;
 
 
@@ -230,6 +232,31 @@ void CANrx_taskTmr_init(int fdEpoll, long intervalns, uint16_t *maxTime) {
 }
 
 
+void CANrx_taskTmr_setCallback(void (*pFunct)(bool_t syncWas)) {
+    taskRT.pFunctRT = pFunct;
+}
+
+
+void CANrx_taskTmr_setStatsCallback(void (*pFunct)(long wakeupLatency_ns, long processing_ns)) {
+    taskRT.pFunctStats = pFunct;
+}
+
+
+uint16_t CANrx_taskTmr_flushTPDOs(void) {
+    uint16_t sent = 0;
+
+    CO_LOCK_OD();
+    if(CO->CANmodule[0]->CANnormal) {
+        CO_CANtxBatchBegin(CO->CANmodule[0]);
+        sent = CO_flush_TPDO(CO);
+        CO_CANtxBatchFlush(CO->CANmodule[0]);
+    }
+    CO_UNLOCK_OD();
+
+    return sent;
+}
+
+
 void CANrx_taskTmr_close(void) {
     close(taskRT.fdTmr);
 }
@@ -246,16 +273,22 @@ bool_t CANrx_taskTmr_process(int fd) {
     /* Execute taskTmr */
     else if(fd == taskRT.fdTmr) {
         uint64_t tmrExp;
+        struct timespec tmrMeasure;
+        long wakeupLatency = 0;
 
         /* Wait for timer to expire */
         if(read(taskRT.fdTmr, &tmrExp, sizeof(tmrExp)) != sizeof(uint64_t))
             CO_error(0x22100000L + errno);
 
-        /* Calculate maximum interval in microseconds (informative) */
-        if(taskRT.maxTime != NULL) {
-            struct timespec tmrMeasure;
+        if(taskRT.maxTime != NULL || taskRT.pFunctStats != NULL) {
             if(clock_gettime(CLOCK_MONOTONIC, &tmrMeasure) == -1)
                 CO_error(0x22200000L + errno);
+            wakeupLatency = (tmrMeasure.tv_sec - taskRT.tmrVal->tv_sec) * NSEC_PER_SEC
+                          + (tmrMeasure.tv_nsec - taskRT.tmrVal->tv_nsec);
+        }
+
+        /* Calculate maximum interval in microseconds (informative) */
+        if(taskRT.maxTime != NULL) {
             if(tmrMeasure.tv_sec == taskRT.tmrVal->tv_sec) {
                 long dt = tmrMeasure.tv_nsec - taskRT.tmrVal->tv_nsec;
                 dt /= 1000;
@@ -284,17 +317,34 @@ bool_t CANrx_taskTmr_process(int fd) {
         if(CO->CANmodule[0]->CANnormal) {
             bool_t syncWas;
 
+            /* Stage SYNC and TPDOs of this tick, sent together below */
+            CO_CANtxBatchBegin(CO->CANmodule[0]);
+
             /* Process Sync and read inputs */
             syncWas = CO_process_SYNC_RPDO(CO, taskRT.intervalus);
 
             /* Further I/O or nonblocking application code may go here. */
+            if(taskRT.pFunctRT != NULL) {
+                taskRT.pFunctRT(syncWas);
+            }
 
             /* Write outputs */
             CO_process_TPDO(CO, syncWas, taskRT.intervalus);
+
+            /* Send all frames of the tick with one syscall */
+            CO_CANtxBatchFlush(CO->CANmodule[0]);
         }
 
         /* Unlock */
         CO_UNLOCK_OD();
+
+        /* Timing statistics */
+        if(taskRT.pFunctStats != NULL) {
+            struct timespec tmrEnd;
+            clock_gettime(CLOCK_MONOTONIC, &tmrEnd);
+            taskRT.pFunctStats(wakeupLatency, (tmrEnd.tv_sec - tmrMeasure.tv_sec) * NSEC_PER_SEC
+                                              + (tmrEnd.tv_nsec - tmrMeasure.tv_nsec));
+        }
     }
 
     else {
@@ -87,6 +87,42 @@ void taskMain_cbSignal(void);
  */
 void CANrx_taskTmr_init(int fdEpoll, long intervalns, uint16_t *maxTime);
 
+/**
+ * Set realtime application function.
+ *
+ * Function is called by CANrx_taskTmr_process() each interval, with OD locked,
+ * between processing of RPDOs (inputs) and TPDOs (outputs). It must be
+ * nonblocking and fast.
+ *
+ * @param pFunct Function to call, with true if SYNC was processed in this
+ * interval. NULL to disable.
+ */
+void CANrx_taskTmr_setCallback(void (*pFunct)(bool_t syncWas));
+
+/**
+ * Set timing statistics function.
+ *
+ * Function is called by CANrx_taskTmr_process() each interval, after
+ * processing (OD unlocked). It must be nonblocking and fast.
+ *
+ * @param pFunct Function to call with the timer wakeup latency (actual -
+ * programmed expiration time) and the processing time of the interval, in
+ * nanoseconds. NULL to disable.
+ */
+void CANrx_taskTmr_setStatsCallback(void (*pFunct)(long wakeupLatency_ns, long processing_ns));
+
+/**
+ * Send the changed event driven TPDOs now (see CO_flush_TPDO), all with one
+ * syscall, rather than at the next interval of CANrx_taskTmr_process().
+ *
+ * To be called by another thread than the one running
+ * CANrx_taskTmr_process(), e.g. by the control loop after writing the drives
+ * commands. Locks the OD, so waits for a running interval to complete.
+ *
+ * @return Number of TPDOs sent (0 if CAN is not in normal mode).
+ */
+uint16_t CANrx_taskTmr_flushTPDOs(void);
+
 /**
  * Cleanup realtime task.
  */
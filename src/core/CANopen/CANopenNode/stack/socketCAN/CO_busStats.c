@@ -0,0 +1,326 @@
+/*
+ * CAN bus statistics for Linux SocketCAN.
+ *
+ * @file        CO_busStats.c
+ */
+
+#include "CO_busStats.h"
+
+#include <linux/can.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Per COB-ID statistics, indexed by the 11 bit identifier */
+static CO_CANcobStats_t cobStats[CO_BUS_STATS_COB_IDS];
+
+/* Rolling windows: window number (high 32 bits) and bits recorded during it
+ * (low 32 bits), in one word so that recycling a window and accounting its
+ * first frame is a single atomic update. */
+#define WINDOW_EPOCH(w) ((w) >> 32)
+#define WINDOW_BITS(w) ((w) & 0xFFFFFFFFULL)
+static uint64_t windowState[CO_BUS_STATS_WINDOWS];
+static uint64_t peakWindowBits;
+
+static uint64_t totalFrames;
+static uint64_t totalBits;
+static uint64_t firstTime;
+static uint32_t bitrate = 1000;
+static int enabled = 1;
+
+/* Frame length tables: CRC-15 of a byte, and bit stuffing of a byte from a
+ * stuffing state ((last bit << 2) | (run of identical bits - 1)): next state
+ * in the low 3 bits, stuff bits inserted above. */
+static uint16_t crcTable[256];
+static uint8_t stuffTable[8][256];
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+#define LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#define ADD(x, v) __atomic_fetch_add(&(x), (v), __ATOMIC_RELAXED)
+
+
+/******************************************************************************/
+void CO_CANbusStatsSetBitrate(uint32_t bitrate_kbps){
+    if(bitrate_kbps > 0U){
+        bitrate = bitrate_kbps;
+    }
+}
+
+
+/******************************************************************************/
+void CO_CANbusStatsEnable(int enable){
+    STORE(enabled, enable ? 1 : 0);
+}
+
+
+/******************************************************************************/
+int CO_CANbusStatsEnabled(void){
+    return LOAD(enabled);
+}
+
+
+/* One bit through the CRC-15 (polynomial 0x4599) and the bit stuffing *******/
+static inline uint16_t crcBit(uint16_t crc, uint8_t bit){
+    uint8_t crcNext = bit ^ ((crc >> 14) & 1U);
+    crc = (crc << 1) & 0x7FFFU;
+    return crcNext ? crc ^ 0x4599U : crc;
+}
+
+/* A complement bit is stuffed after 5 identical bits, and counts in the next run */
+static inline uint8_t stuffBit(uint8_t state, uint8_t bit, uint32_t *stuff){
+    uint8_t last = state >> 2, run = (state & 3U) + 1U;
+
+    if(bit != last){
+        return (uint8_t)(bit << 2);
+    }
+    if(++run == 5U){
+        (*stuff)++;
+        return (uint8_t)((!last) << 2);
+    }
+    return (uint8_t)((last << 2) | (run - 1U));
+}
+
+static void tablesInit(void){
+    uint32_t i, s, b;
+
+    for(i=0U; i<256U; i++){
+        uint16_t crc = 0U;
+        for(b=0U; b<8U; b++){
+            crc = crcBit(crc, (i >> (7U - b)) & 1U);
+        }
+        crcTable[i] = crc;
+    }
+    for(s=0U; s<8U; s++){
+        for(i=0U; i<256U; i++){
+            uint8_t state = (uint8_t)s;
+            uint32_t stuff = 0U;
+            for(b=0U; b<8U; b++){
+                state = stuffBit(state, (i >> (7U - b)) & 1U, &stuff);
+            }
+            stuffTable[s][i] = (uint8_t)(state | (stuff << 3));
+        }
+    }
+}
+
+
+/******************************************************************************/
+uint32_t CO_CANframeBits(uint32_t ident, uint8_t DLC, const uint8_t *data){
+    uint32_t nData = (ident & CAN_RTR_FLAG) ? 0U : (DLC > 8U ? 8U : DLC);
+    uint32_t header, stuff = 0U, i;
+    uint16_t crc = 0U;
+    uint8_t state;
+
+    if(ident & CAN_EFF_FLAG){
+        /* Not used by CANopen: worst case of an extended frame */
+        return 54U + 8U * nData + (53U + 8U * nData) / 4U + 13U;
+    }
+    pthread_once(&tablesOnce, tablesInit);
+
+    /* SOF, identifier, RTR, IDE, r0, DLC (19 bits) bit by bit, then the data
+     * bytes through the tables: the CRC is computed over all of them */
+    header = ((ident & CAN_SFF_MASK) << 7) | ((ident & CAN_RTR_FLAG) ? 0x40U : 0U) | (DLC & 0xFU);
+    crc = crcBit(crc, 0U);
+    state = 0U; /* SOF: dominant, run of 1 */
+    for(i=0U; i<18U; i++){
+        uint8_t bit = (header >> (17U - i)) & 1U;
+        crc = crcBit(crc, bit);
+        state = stuffBit(state, bit, &stuff);
+    }
+    for(i=0U; i<nData; i++){
+        uint8_t next = stuffTable[state][data[i]];
+        crc = ((crc << 8) ^ crcTable[((crc >> 7) ^ data[i]) & 0xFFU]) & 0x7FFFU;
+        stuff += next >> 3;
+        state = next & 7U;
+    }
+    for(i=0U; i<15U; i++){
+        state = stuffBit(state, (crc >> (14U - i)) & 1U, &stuff);
+    }
+
+    /* Stuffed part, CRC delimiter, ACK slot and delimiter, EOF and interframe space */
+    return 19U + 8U * nData + 15U + stuff + 13U;
+}
+
+
+/* Account bits in the rolling window of time_ns ******************************/
+static void windowAdd(uint64_t time_ns, uint32_t nBits){
+    uint64_t epoch = (time_ns / CO_BUS_STATS_WINDOW_NS) & 0xFFFFFFFFULL;
+    uint32_t i = epoch % CO_BUS_STATS_WINDOWS;
+    uint64_t old = LOAD(windowState[i]);
+
+    for(;;){
+        uint64_t next;
+        if(WINDOW_EPOCH(old) == epoch){
+            next = old + nBits;
+        }
+        else if(WINDOW_EPOCH(old) < epoch){
+            /* First frame of a new window: recycled with the bits of this frame */
+            next = (epoch << 32) | nBits;
+        }
+        else{
+            /* A frame timed more than CO_BUS_STATS_WINDOWS windows late is not accounted in the windows */
+            return;
+        }
+        if(__atomic_compare_exchange_n(&windowState[i], &old, next, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+            break;
+        }
+    }
+    if(WINDOW_EPOCH(old) != epoch){
+        /* The thread recycling a window accounts the previous one in the peak */
+        uint64_t prev = LOAD(windowState[(epoch - 1U) % CO_BUS_STATS_WINDOWS]);
+        if(WINDOW_EPOCH(prev) == epoch - 1U){
+            uint64_t b = WINDOW_BITS(prev);
+            uint64_t peak = LOAD(peakWindowBits);
+            while(b > peak && !__atomic_compare_exchange_n(&peakWindowBits, &peak, b, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+            }
+        }
+    }
+}
+
+
+/******************************************************************************/
+void CO_CANbusStatsRecord(uint32_t ident, uint8_t DLC, const uint8_t *data, uint64_t time_ns, uint8_t tx){
+    CO_CANcobStats_t *s = &cobStats[ident & CAN_SFF_MASK];
+    uint32_t nBits = CO_CANframeBits(ident, DLC, data);
+    uint64_t last;
+
+    ADD(s->frames, 1U);
+    ADD(s->bytes, (ident & CAN_RTR_FLAG) ? 0U : (DLC > 8U ? 8U : DLC));
+    ADD(s->bits, nBits);
+    STORE(s->tx, tx);
+    ADD(totalFrames, 1U);
+    ADD(totalBits, nBits);
+    if(LOAD(firstTime) == 0U){
+        uint64_t zero = 0U;
+        __atomic_compare_exchange_n(&firstTime, &zero, time_ns, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+    windowAdd(time_ns, nBits);
+
+    /* Inter-arrival statistics (one writer per COB-ID) */
+    last = LOAD(s->lastTime);
+    STORE(s->lastTime, time_ns);
+    if(last != 0U && time_ns >= last){
+        uint64_t interval = time_ns - last;
+        uint64_t lastInterval = LOAD(s->lastInterval);
+        if(LOAD(s->intervals) == 0U || interval < LOAD(s->intervalMin)){
+            STORE(s->intervalMin, interval);
+        }
+        if(interval > LOAD(s->intervalMax)){
+            STORE(s->intervalMax, interval);
+        }
+        ADD(s->intervalSum, interval);
+        if(ADD(s->intervals, 1U) > 0U){
+            int64_t d = (int64_t)(interval - lastInterval);
+            int64_t jitter = (int64_t)LOAD(s->jitter);
+            jitter += ((d < 0 ? -d : d) - jitter) / 16;
+            STORE(s->jitter, (uint64_t)jitter);
+        }
+        STORE(s->lastInterval, interval);
+    }
+}
+
+
+/******************************************************************************/
+int CO_CANbusStatsGet(uint16_t cobId, CO_CANcobStats_t *stats){
+    CO_CANcobStats_t *s;
+
+    if(cobId >= CO_BUS_STATS_COB_IDS || stats == NULL){
+        return 0;
+    }
+    s = &cobStats[cobId];
+    stats->frames = LOAD(s->frames);
+    stats->bytes = LOAD(s->bytes);
+    stats->bits = LOAD(s->bits);
+    stats->lastTime = LOAD(s->lastTime);
+    stats->intervals = LOAD(s->intervals);
+    stats->intervalSum = LOAD(s->intervalSum);
+    stats->intervalMin = (stats->intervals > 0U) ? LOAD(s->intervalMin) : UINT64_MAX;
+    stats->intervalMax = LOAD(s->intervalMax);
+    stats->lastInterval = LOAD(s->lastInterval);
+    stats->jitter = LOAD(s->jitter);
+    stats->tx = LOAD(s->tx);
+    return stats->frames > 0U;
+}
+
+
+/******************************************************************************/
+void CO_CANbusLoadGet(CO_CANbusLoad_t *load){
+    struct timespec ts;
+    uint64_t now, epoch, bits = 0U, first;
+    double bitsPerWindow;
+    uint32_t i;
+
+    if(load == NULL){
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    epoch = (now / CO_BUS_STATS_WINDOW_NS) & 0xFFFFFFFFULL;
+
+    /* Complete windows only (the current one is being filled) */
+    for(i=0U; i<CO_BUS_STATS_WINDOWS; i++){
+        uint64_t w = LOAD(windowState[i]);
+        if(WINDOW_EPOCH(w) < epoch && WINDOW_EPOCH(w) + CO_BUS_STATS_WINDOWS > epoch){
+            bits += WINDOW_BITS(w);
+        }
+    }
+    bitsPerWindow = (double)bitrate * 1000. * CO_BUS_STATS_WINDOW_NS / 1e9;
+    load->bitrate_kbps = bitrate;
+    load->load = 100. * bits / (bitsPerWindow * (CO_BUS_STATS_WINDOWS - 1));
+    load->peakLoad = 100. * LOAD(peakWindowBits) / bitsPerWindow;
+    load->frames = LOAD(totalFrames);
+    load->bits = LOAD(totalBits);
+    first = LOAD(firstTime);
+    load->averageLoad = (first != 0U && now > first) ? 100. * load->bits / ((double)bitrate * 1000. * (now - first) / 1e9) : 0.;
+}
+
+
+/******************************************************************************/
+int CO_CANbusStatsDump(const char *filename){
+    char tmpFilename[256];
+    CO_CANbusLoad_t load;
+    FILE *f;
+    uint16_t id;
+
+    snprintf(tmpFilename, sizeof(tmpFilename), "%s.tmp", filename);
+    f = fopen(tmpFilename, "w");
+    if(f == NULL){
+        return -1;
+    }
+    CO_CANbusLoadGet(&load);
+    fprintf(f, "# CAN bus at %ukbit/s: load %.1f%% (last %.1fs), peak %.1f%% (%.1fs window), average %.1f%%, %llu frames, %llu bits\n",
+            load.bitrate_kbps, load.load, (CO_BUS_STATS_WINDOWS - 1) * CO_BUS_STATS_WINDOW_NS / 1e9, load.peakLoad,
+            CO_BUS_STATS_WINDOW_NS / 1e9, load.averageLoad, (unsigned long long)load.frames, (unsigned long long)load.bits);
+    fprintf(f, "# COB-ID, direction, frames, bytes, bits, interval min, mean, max (us), jitter (us)\n");
+    for(id=0U; id<CO_BUS_STATS_COB_IDS; id++){
+        CO_CANcobStats_t s;
+        if(CO_CANbusStatsGet(id, &s)){
+            if(s.intervals > 0U){
+                fprintf(f, "0x%03x, %s, %llu, %llu, %llu, %.1f, %.1f, %.1f, %.1f\n", id, s.tx ? "tx" : "rx",
+                        (unsigned long long)s.frames, (unsigned long long)s.bytes, (unsigned long long)s.bits,
+                        s.intervalMin / 1e3, (double)s.intervalSum / s.intervals / 1e3, s.intervalMax / 1e3, s.jitter / 1e3);
+            }
+            else{
+                fprintf(f, "0x%03x, %s, %llu, %llu, %llu, -, -, -, -\n", id, s.tx ? "tx" : "rx",
+                        (unsigned long long)s.frames, (unsigned long long)s.bytes, (unsigned long long)s.bits);
+            }
+        }
+    }
+    if(fclose(f) != 0 || rename(tmpFilename, filename) != 0){
+        return -1;
+    }
+    return 0;
+}
+
+
+/******************************************************************************/
+void CO_CANbusStatsReset(void){
+    memset(cobStats, 0, sizeof(cobStats));
+    memset(windowState, 0, sizeof(windowState));
+    peakWindowBits = 0U;
+    totalFrames = 0U;
+    totalBits = 0U;
+    firstTime = 0U;
+}
@@ -0,0 +1,109 @@
+/*
+ * CAN bus statistics for Linux SocketCAN: per COB-ID counters of the frames
+ * received and sent, and rolling bus utilisation.
+ *
+ * @file        CO_busStats.h
+ *
+ * Frames are recorded by the driver (CO_CANrxWait, CO_CANsend and
+ * CO_CANtxBatchFlush), from any thread and without lock: counters are updated
+ * atomically. The inter-arrival statistics of a COB-ID assume a single thread
+ * sends it (always the case for received frames): concurrent senders of the
+ * same COB-ID only skew its intervals. Readers (CO_CANbusStatsGet,
+ * CO_CANbusLoadGet, CO_CANbusStatsDump) can run at any time.
+ *
+ * Received frames are the ones passing the socket filters (the COB-IDs the
+ * stack listens to, see CO_CANrxBufferInit), sent frames are timed when handed
+ * to the kernel. Frame lengths are exact: bit stuffing is computed from the
+ * frame content (byte-wise, through tables built at the first frame).
+ *
+ * Recording can be disabled at runtime (CO_CANbusStatsEnable(), bus statistics
+ * in config/rt_config.yaml): the driver then neither computes the frame
+ * lengths nor times the frames it sends (unless they are captured).
+ */
+
+#ifndef CO_BUS_STATS_H
+#define CO_BUS_STATS_H
+
+#include <stdint.h>
+
+#ifndef CO_BUS_STATS_WINDOW_NS
+#define CO_BUS_STATS_WINDOW_NS 100000000ULL /* Bus utilisation window [ns] */
+#endif
+#define CO_BUS_STATS_WINDOWS 11 /* Windows kept: utilisation over the last 10 complete ones (1s) */
+#define CO_BUS_STATS_COB_IDS 2048 /* 11 bit identifiers */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Statistics of one COB-ID. Times in ns (CLOCK_MONOTONIC). */
+typedef struct {
+    uint64_t frames;       /* Number of frames */
+    uint64_t bytes;        /* Data bytes */
+    uint64_t bits;         /* Bits on the wire, including stuff bits and interframe space */
+    uint64_t lastTime;     /* Time of the last frame */
+    uint64_t intervals;    /* Number of inter-arrival intervals (frames - 1) */
+    uint64_t intervalSum;  /* Sum of the intervals (mean: intervalSum / intervals) */
+    uint64_t intervalMin;  /* Shortest interval, UINT64_MAX if none */
+    uint64_t intervalMax;  /* Longest interval */
+    uint64_t lastInterval; /* Last interval */
+    uint64_t jitter;       /* Mean deviation between consecutive intervals (RFC 3550 estimator, gain 1/16) */
+    uint8_t tx;            /* Sent by this node (1) or received (0) */
+} CO_CANcobStats_t;
+
+/* Bus utilisation, all frames sent and received. */
+typedef struct {
+    double load;           /* Over the last complete windows [%] */
+    double peakLoad;       /* Highest load of a single window since start (or reset) [%] */
+    double averageLoad;    /* Since the first frame [%] */
+    uint64_t frames;       /* Frames since start */
+    uint64_t bits;         /* Bits since start */
+    uint32_t bitrate_kbps; /* Bitrate used for the loads */
+} CO_CANbusLoad_t;
+
+/* Set the CAN bitrate used to compute the bus loads (default 1000kbit/s). */
+void CO_CANbusStatsSetBitrate(uint32_t bitrate_kbps);
+
+/* Enable (default) or disable the recording of the frames by the driver. */
+void CO_CANbusStatsEnable(int enable);
+
+/* @return 1 if the frames are recorded. */
+int CO_CANbusStatsEnabled(void);
+
+/* Exact length on the wire of a standard (11 bit) data or remote frame,
+ * including stuff bits, CRC, ACK, EOF and interframe space [bits].
+ *
+ * @param ident CAN identifier (socketCAN can_id: flags are taken into account)
+ * @param DLC Data length code
+ * @param data Frame data
+ */
+uint32_t CO_CANframeBits(uint32_t ident, uint8_t DLC, const uint8_t *data);
+
+/* Record a frame (called by the driver). */
+void CO_CANbusStatsRecord(uint32_t ident, uint8_t DLC, const uint8_t *data, uint64_t time_ns, uint8_t tx);
+
+/* Copy the statistics of a COB-ID.
+ *
+ * @return 0 if no frame of this COB-ID was recorded.
+ */
+int CO_CANbusStatsGet(uint16_t cobId, CO_CANcobStats_t *stats);
+
+/* Current bus utilisation. */
+void CO_CANbusLoadGet(CO_CANbusLoad_t *load);
+
+/* Write the bus utilisation and statistics of every recorded COB-ID into a
+ * text file (written to filename.tmp first, then renamed: readers never see
+ * a partial file).
+ *
+ * @return 0 on success, -1 on error.
+ */
+int CO_CANbusStatsDump(const char *filename);
+
+/* Clear all statistics. Not to call while frames are recorded. */
+void CO_CANbusStatsReset(void);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * Binary capture of CAN frames.
+ *
+ * @file        CO_canCapture.c
+ */
+
+#include "CO_canCapture.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/******************************************************************************/
+int CO_CANcaptureWriteHeader(FILE *f, uint64_t startRealtime_ns){
+    CO_CANcaptureHeader_t header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CO_CAN_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CO_CAN_CAPTURE_VERSION;
+    header.startRealtime_ns = startRealtime_ns;
+    return fwrite(&header, sizeof(header), 1, f) == 1 ? 0 : -1;
+}
+
+
+/******************************************************************************/
+int CO_CANcaptureReadHeader(FILE *f, CO_CANcaptureHeader_t *header){
+    if(fread(header, sizeof(*header), 1, f) != 1 ||
+       memcmp(header->magic, CO_CAN_CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != CO_CAN_CAPTURE_VERSION){
+        return -1;
+    }
+    return 0;
+}
+
+
+/******************************************************************************/
+int CO_CANcaptureWriteRecord(FILE *f, const struct can_frame *frame, uint64_t time_ns, uint8_t flags){
+    CO_CANcaptureRecord_t record;
+    uint8_t length = (frame->can_id & CAN_RTR_FLAG) ? 0U : (frame->can_dlc > 8U ? 8U : frame->can_dlc);
+
+    record.time_ns = time_ns;
+    record.can_id = frame->can_id;
+    record.dlc = frame->can_dlc;
+    record.flags = flags;
+    if(fwrite(&record, sizeof(record), 1, f) != 1 ||
+       (length > 0U && fwrite(frame->data, length, 1, f) != 1)){
+        return -1;
+    }
+    return 0;
+}
+
+
+/******************************************************************************/
+int CO_CANcaptureReadRecord(FILE *f, struct can_frame *frame, uint64_t *time_ns, uint8_t *flags){
+    CO_CANcaptureRecord_t record;
+    uint8_t length;
+    size_t n = fread(&record, 1, sizeof(record), f);
+
+    if(n == 0U){
+        return 0;
+    }
+    if(n != sizeof(record)){
+        return -1;
+    }
+    memset(frame, 0, sizeof(*frame));
+    frame->can_id = record.can_id;
+    frame->can_dlc = record.dlc;
+    length = (record.can_id & CAN_RTR_FLAG) ? 0U : (record.dlc > 8U ? 8U : record.dlc);
+    if(length > 0U && fread(frame->data, length, 1, f) != 1){
+        return -1;
+    }
+    *time_ns = record.time_ns;
+    *flags = record.flags;
+    return 1;
+}
+
+
+/* In-process capture *********************************************************
+ * Bounded multi-producer queue (one sequence number per slot, D. Vyukov): the
+ * senders (any thread of the stack) reserve a slot with a CAS, the writer
+ * thread is the only consumer. */
+typedef struct {
+    uint64_t seq;
+    uint64_t time_ns;
+    struct can_frame frame;
+    uint8_t tx;
+} captureSlot_t;
+
+static captureSlot_t queue[CO_CAN_CAPTURE_QUEUE_SIZE];
+static uint64_t enqueuePos;
+static uint64_t dequeuePos;
+static volatile int capturing = 0;
+static volatile int writerRunning = 0;
+static pthread_t writerThread;
+static FILE *captureFile = NULL;
+static uint64_t startTime_ns;
+static uint64_t written;
+static uint64_t dropped;
+
+/* Write the queued frames, @return number written */
+static uint64_t captureDrain(void){
+    uint64_t n = 0U;
+
+    for(;;){
+        captureSlot_t *slot = &queue[dequeuePos & (CO_CAN_CAPTURE_QUEUE_SIZE - 1)];
+        if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != dequeuePos + 1U){
+            break;
+        }
+        /* Frames timed before the start (kernel receive time) at 0 */
+        CO_CANcaptureWriteRecord(captureFile, &slot->frame,
+                                 slot->time_ns > startTime_ns ? slot->time_ns - startTime_ns : 0U,
+                                 slot->tx ? CO_CAN_CAPTURE_TX : 0U);
+        __atomic_store_n(&slot->seq, dequeuePos + CO_CAN_CAPTURE_QUEUE_SIZE, __ATOMIC_RELEASE);
+        dequeuePos++;
+        n++;
+    }
+    __atomic_fetch_add(&written, n, __ATOMIC_RELAXED);
+    return n;
+}
+
+static void *captureWriter(void *arg){
+    (void)arg;
+    while(writerRunning){
+        if(captureDrain() > 0U){
+            fflush(captureFile);
+        }
+        usleep(10000);
+    }
+    return NULL;
+}
+
+
+/******************************************************************************/
+int CO_CANcaptureStart(const char *filename){
+    struct timespec real, mono;
+    uint64_t i;
+
+    if(capturing || writerRunning){
+        return -1;
+    }
+    captureFile = fopen(filename, "wb");
+    if(captureFile == NULL){
+        return -1;
+    }
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    startTime_ns = (uint64_t)mono.tv_sec * 1000000000ULL + mono.tv_nsec;
+    if(CO_CANcaptureWriteHeader(captureFile, (uint64_t)real.tv_sec * 1000000000ULL + real.tv_nsec) != 0){
+        fclose(captureFile);
+        captureFile = NULL;
+        return -1;
+    }
+    for(i=0U; i<CO_CAN_CAPTURE_QUEUE_SIZE; i++){
+        queue[i].seq = i;
+    }
+    enqueuePos = 0U;
+    dequeuePos = 0U;
+    written = 0U;
+    dropped = 0U;
+
+    writerRunning = 1;
+    if(pthread_create(&writerThread, NULL, captureWriter, NULL) != 0){
+        writerRunning = 0;
+        fclose(captureFile);
+        captureFile = NULL;
+        return -1;
+    }
+    __atomic_store_n(&capturing, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+
+/******************************************************************************/
+void CO_CANcaptureStop(void){
+    if(!writerRunning){
+        return;
+    }
+    __atomic_store_n(&capturing, 0, __ATOMIC_RELEASE);
+    writerRunning = 0;
+    pthread_join(writerThread, NULL);
+    /* Frames of senders which were already queuing are written if complete */
+    captureDrain();
+    fclose(captureFile);
+    captureFile = NULL;
+}
+
+
+/******************************************************************************/
+void CO_CANcaptureFrame(const struct can_frame *frame, uint64_t time_ns, uint8_t tx){
+    captureSlot_t *slot;
+    uint64_t pos;
+
+    if(!__atomic_load_n(&capturing, __ATOMIC_ACQUIRE)){
+        return;
+    }
+    pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    for(;;){
+        int64_t diff;
+        slot = &queue[pos & (CO_CAN_CAPTURE_QUEUE_SIZE - 1)];
+        diff = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if(diff == 0){
+            if(__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1U, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                break;
+            }
+        }
+        else if(diff < 0){
+            /* Queue full: the writer thread is late */
+            __atomic_fetch_add(&dropped, 1U, __ATOMIC_RELAXED);
+            return;
+        }
+        else{
+            pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+    slot->time_ns = time_ns;
+    slot->frame = *frame;
+    slot->tx = tx;
+    __atomic_store_n(&slot->seq, pos + 1U, __ATOMIC_RELEASE);
+}
+
+
+/******************************************************************************/
+void CO_CANcaptureGetCounts(uint64_t *writtenFrames, uint64_t *droppedFrames){
+    if(writtenFrames != NULL){
+        *writtenFrames = __atomic_load_n(&written, __ATOMIC_RELAXED);
+    }
+    if(droppedFrames != NULL){
+        *droppedFrames = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    }
+}
+
+
+#ifdef CO_LOG_CAN_MESSAGES
+/* Driver hook (see CO_driver.h) */
+void CO_logMessage(const struct can_frame *frame, uint64_t time_ns, uint8_t tx){
+    CO_CANcaptureFrame(frame, time_ns, tx);
+}
+#endif
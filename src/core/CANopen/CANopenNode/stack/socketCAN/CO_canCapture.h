@@ -0,0 +1,91 @@
+/*
+ * Binary capture of CAN frames: file format, and in-process capture of the
+ * frames received and sent by the stack.
+ *
+ * @file        CO_canCapture.h
+ *
+ * With CO_LOG_CAN_MESSAGES defined (CAN_CAPTURE in CMakeLists.txt), the driver
+ * calls CO_logMessage() for every frame received (dispatched) and sent. While a
+ * capture is started (CO_CANcaptureStart), the frames are queued without lock
+ * nor system call and written to the file by a separate (non real-time) thread.
+ * Frames are dropped (and counted) if the queue is full.
+ *
+ * File format (little endian, as written by the host):
+ *  - CO_CANcaptureHeader_t
+ *  - records: CO_CANcaptureRecord_t followed by the data bytes (dlc bytes, none
+ *    for a remote frame), in capture order.
+ * Captures are replayed with src/tools/CANreplay, and can also be made from
+ * a live interface with src/tools/CANcapture.
+ */
+
+#ifndef CO_CAN_CAPTURE_H
+#define CO_CAN_CAPTURE_H
+
+#include <linux/can.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CO_CAN_CAPTURE_MAGIC "CORCCAN1"
+#define CO_CAN_CAPTURE_VERSION 1
+#define CO_CAN_CAPTURE_TX 0x01 /* Record flag: frame sent by the capturing node (or host) */
+#ifndef CO_CAN_CAPTURE_QUEUE_SIZE
+#define CO_CAN_CAPTURE_QUEUE_SIZE 8192 /* Frames queued for the writer thread (power of 2) */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* File header */
+typedef struct {
+    char magic[8];             /* CO_CAN_CAPTURE_MAGIC */
+    uint32_t version;          /* CO_CAN_CAPTURE_VERSION */
+    uint32_t reserved;
+    uint64_t startRealtime_ns; /* Wall clock time of the capture start (CLOCK_REALTIME) */
+    uint64_t reserved2;
+} CO_CANcaptureHeader_t;
+
+/* Record header, followed by the data bytes */
+typedef struct __attribute__((packed)) {
+    uint64_t time_ns; /* Since the capture start */
+    uint32_t can_id;  /* socketCAN can_id, flags included */
+    uint8_t dlc;
+    uint8_t flags;    /* CO_CAN_CAPTURE_TX */
+} CO_CANcaptureRecord_t;
+
+/* Write a capture file header. @return 0 on success. */
+int CO_CANcaptureWriteHeader(FILE *f, uint64_t startRealtime_ns);
+
+/* Read and check a capture file header. @return 0 on success. */
+int CO_CANcaptureReadHeader(FILE *f, CO_CANcaptureHeader_t *header);
+
+/* Write one record. @return 0 on success. */
+int CO_CANcaptureWriteRecord(FILE *f, const struct can_frame *frame, uint64_t time_ns, uint8_t flags);
+
+/* Read the next record into frame (data zeroed beyond dlc).
+ * @return 1 if a record was read, 0 at the end of the file, -1 if truncated. */
+int CO_CANcaptureReadRecord(FILE *f, struct can_frame *frame, uint64_t *time_ns, uint8_t *flags);
+
+/* Start capturing the frames of the stack into a file (truncated).
+ * @return 0 on success, -1 if the file or the writer thread can't be created. */
+int CO_CANcaptureStart(const char *filename);
+
+/* Stop the capture: remaining queued frames are written and the file closed. */
+void CO_CANcaptureStop(void);
+
+/* Queue a frame for the capture file (if started). Never blocks.
+ *
+ * @param time_ns Frame time, CLOCK_MONOTONIC [ns]
+ * @param tx 1 if sent, 0 if received
+ */
+void CO_CANcaptureFrame(const struct can_frame *frame, uint64_t time_ns, uint8_t tx);
+
+/* Frames written to the file and frames dropped (queue full) by the current
+ * or last capture. */
+void CO_CANcaptureGetCounts(uint64_t *written, uint64_t *dropped);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -23,12 +23,17 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* for recvmmsg, sendmmsg */
+#endif
 
 #include "CO_driver.h"
 #include "CO_Emergency.h"
+#include "CO_busStats.h"
 #include <string.h> /* for memcpy */
 #include <stdlib.h> /* for malloc, free */
 #include <errno.h>
+#include <time.h>
 #include <sys/socket.h>
 
 
@@ -98,6 +103,70 @@ static CO_ReturnError_t setFilters(CO_CANmodule_t *CANmodule){
 }
 
 
+/** Maintain rxIndex and rxMasked for one rxArray buffer **********************/
+static bool_t isExactFilter(const CO_CANrx_t *buffer){
+    return (buffer->mask & CAN_SFF_MASK) == CAN_SFF_MASK;
+}
+
+static void rxIndexRemove(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+    uint16_t i;
+
+    if(buffer->pFunct == NULL){
+        return; /* never registered */
+    }
+
+    if(isExactFilter(buffer)){
+        uint16_t id = buffer->ident & CAN_SFF_MASK;
+
+        if(CANmodule->rxIndex[id] == index){
+            /* Fall back to next buffer with the same COB-ID, if any. */
+            uint16_t next = CO_CAN_RX_INDEX_NONE;
+            for(i = index + 1U; i < CANmodule->rxSize; i++){
+                CO_CANrx_t *b = &CANmodule->rxArray[i];
+                if(b->pFunct != NULL && isExactFilter(b) && (b->ident & CAN_SFF_MASK) == id){
+                    next = i;
+                    break;
+                }
+            }
+            CANmodule->rxIndex[id] = next;
+        }
+    }else{
+        for(i = 0U; i < CANmodule->rxMaskedCount; i++){
+            if(CANmodule->rxMasked[i] == index){
+                CANmodule->rxMaskedCount--;
+                memmove(&CANmodule->rxMasked[i], &CANmodule->rxMasked[i + 1U],
+                        (CANmodule->rxMaskedCount - i) * sizeof(uint16_t));
+                break;
+            }
+        }
+    }
+}
+
+static void rxIndexAdd(CO_CANmodule_t *CANmodule, uint16_t index){
+    CO_CANrx_t *buffer = &CANmodule->rxArray[index];
+
+    if(isExactFilter(buffer)){
+        uint16_t id = buffer->ident & CAN_SFF_MASK;
+        uint16_t prev = CANmodule->rxIndex[id];
+
+        if(prev == CO_CAN_RX_INDEX_NONE || prev > index){
+            CANmodule->rxIndex[id] = index;
+        }
+    }else{
+        uint16_t i = CANmodule->rxMaskedCount;
+
+        /* Insert sorted */
+        while(i > 0U && CANmodule->rxMasked[i - 1U] > index){
+            CANmodule->rxMasked[i] = CANmodule->rxMasked[i - 1U];
+            i--;
+        }
+        CANmodule->rxMasked[i] = index;
+        CANmodule->rxMaskedCount++;
+    }
+}
+
+
 /******************************************************************************/
 void CO_CANsetConfigurationMode(int32_t CANbaseAddress){
 }
@@ -146,6 +215,15 @@ CO_ReturnError_t CO_CANmodule_init(
         CANmodule->CANtxCount = 0U;
         CANmodule->errOld = 0U;
         CANmodule->em = NULL;
+        memset(&CANmodule->rxStats, 0, sizeof(CANmodule->rxStats));
+        memset(&CANmodule->txStats, 0, sizeof(CANmodule->txStats));
+        CANmodule->txBatchCount = 0U;
+        CANmodule->txBatchActive = false;
+        CANmodule->rxTimestamp = 0U;
+        for(i=0U; i<CO_CAN_RX_INDEX_SIZE; i++){
+            CANmodule->rxIndex[i] = CO_CAN_RX_INDEX_NONE;
+        }
+        CANmodule->rxMaskedCount = 0U;
 
 #ifdef CO_LOG_CAN_MESSAGES
         CANmodule->useCANrxFilters = false;
@@ -178,6 +256,13 @@ CO_ReturnError_t CO_CANmodule_init(
             }
         }
 
+        /* Kernel receive timestamps, used for CANmodule->rxTimestamp. If not
+         * supported, time of reading the socket is used instead. */
+        if(ret == CO_ERROR_NO){
+            int enable = 1;
+            setsockopt(CANmodule->fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+        }
+
         /* allocate memory for filter array */
         if(ret == CO_ERROR_NO){
             CANmodule->filter = (struct can_filter *) calloc(rxSize, sizeof(struct can_filter));
@@ -185,10 +270,33 @@ CO_ReturnError_t CO_CANmodule_init(
                 ret = CO_ERROR_OUT_OF_MEMORY;
             }
         }
+
+        /* allocate memory for masked filters index */
+        if(ret == CO_ERROR_NO){
+            CANmodule->rxMasked = (uint16_t *) calloc(rxSize, sizeof(uint16_t));
+            if(CANmodule->rxMasked == NULL){
+                ret = CO_ERROR_OUT_OF_MEMORY;
+            }
+        }
+
+#ifndef CO_SINGLE_THREAD
+        /* Receive buffer lock, taken by the RT thread while dispatching:
+         * priority inheritance, so a lower priority thread reconfiguring
+         * a buffer is boosted instead of delaying the dispatch. */
+        if(ret == CO_ERROR_NO){
+            pthread_mutexattr_t attr;
+            pthread_mutexattr_init(&attr);
+            pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+            if(pthread_mutex_init(&CANmodule->rxLock, &attr) != 0){
+                ret = CO_ERROR_OUT_OF_MEMORY;
+            }
+            pthread_mutexattr_destroy(&attr);
+        }
+#endif
     }
 
     /* Additional check. */
-    if(ret == CO_ERROR_NO && CANmodule->filter == NULL){
+    if(ret == CO_ERROR_NO && (CANmodule->filter == NULL || CANmodule->rxMasked == NULL)){
         ret = CO_ERROR_ILLEGAL_ARGUMENT;
     }
 
@@ -241,6 +349,8 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule){
     close(CANmodule->fd);
     free(CANmodule->filter);
     CANmodule->filter = NULL;
+    free(CANmodule->rxMasked);
+    CANmodule->rxMasked = NULL;
 }
 
 
@@ -267,6 +377,15 @@ CO_ReturnError_t CO_CANrxBufferInit(
         /* buffer, which will be configured */
         CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+        /* Between rxIndexRemove and rxIndexAdd the buffer is in neither
+         * index and rxMasked may be mid memmove: keep the dispatch out. */
+#ifndef CO_SINGLE_THREAD
+        pthread_mutex_lock(&CANmodule->rxLock);
+#endif
+
+        /* Unregister previous configuration of this buffer from the index */
+        rxIndexRemove(CANmodule, index);
+
         /* Configure object variables */
         buffer->object = object;
         buffer->pFunct = pFunct;
@@ -278,10 +397,21 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = (mask & CAN_SFF_MASK) | CAN_EFF_FLAG | CAN_RTR_FLAG;
 
+        /* Register in the COB-ID index used by CO_CANrxDispatch */
+        rxIndexAdd(CANmodule, index);
+
         /* Set CAN hardware module filter and mask. */
         if(CANmodule->useCANrxFilters){
             CANmodule->filter[index].can_id = buffer->ident;
             CANmodule->filter[index].can_mask = buffer->mask;
+        }
+
+#ifndef CO_SINGLE_THREAD
+        pthread_mutex_unlock(&CANmodule->rxLock);
+#endif
+
+        /* Kernel filters are applied outside of the lock (system call). */
+        if(CANmodule->useCANrxFilters){
             if(CANmodule->CANnormal){
                 ret = setFilters(CANmodule);
             }
@@ -325,27 +455,168 @@ CO_CANtx_t *CO_CANtxBufferInit(
 }
 
 
+/* Send time of the frames [ns, CLOCK_MONOTONIC] *****************************/
+static uint64_t monotonicNow(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+
+/* Transmit batches opened by CO_CANtxBatchBegin (see CO_CANtxBatchEnable) ***/
+static volatile bool_t txBatchEnabled = true;
+
+/* Transmit statistics are updated from any sending thread */
+#define TX_STATS_ADD(x, v) __atomic_fetch_add(&(x), (v), __ATOMIC_RELAXED)
+
+
+/******************************************************************************/
+static bool_t isTxBatching(CO_CANmodule_t *CANmodule){
+#ifndef CO_SINGLE_THREAD
+    return CANmodule->txBatchActive && pthread_equal(pthread_self(), CANmodule->txBatchOwner);
+#else
+    return CANmodule->txBatchActive;
+#endif
+}
+
+
 /******************************************************************************/
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     CO_ReturnError_t err = CO_ERROR_NO;
     ssize_t n;
     size_t count = sizeof(struct can_frame);
 
+    if(isTxBatching(CANmodule)){
+        if(CANmodule->txBatchCount >= CO_CAN_TX_BATCH_SIZE){
+            /* Batch full: send what is staged so far, keep batching. */
+            err = CO_CANtxBatchFlush(CANmodule);
+            CO_CANtxBatchBegin(CANmodule);
+        }
+        memcpy(&CANmodule->txBatch[CANmodule->txBatchCount++], buffer, count);
+        return err;
+    }
+
     n = write(CANmodule->fd, buffer, count);
-#ifdef CO_LOG_CAN_MESSAGES
-    void CO_logMessage(const CanMsg *msg);
-    CO_logMessage((const CanMsg*) buffer);
-#endif
+    TX_STATS_ADD(CANmodule->txStats.syscalls, 1U);
 
     if(n != count){
         CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_TX_OVERFLOW, CO_EMC_CAN_OVERRUN, n);
         err = CO_ERROR_TX_OVERFLOW;
     }
+    else{
+#ifdef CO_LOG_CAN_MESSAGES
+        uint64_t now = monotonicNow();
+        CO_logMessage((const struct can_frame *) buffer, now, 1U);
+        if(CO_CANbusStatsEnabled()){
+            CO_CANbusStatsRecord(buffer->ident, buffer->DLC, buffer->data, now, 1U);
+        }
+#else
+        if(CO_CANbusStatsEnabled()){
+            CO_CANbusStatsRecord(buffer->ident, buffer->DLC, buffer->data, monotonicNow(), 1U);
+        }
+#endif
+        TX_STATS_ADD(CANmodule->txStats.frames, 1U);
+    }
 
     return err;
 }
 
 
+/******************************************************************************/
+void CO_CANtxBatchEnable(bool_t enable){
+    txBatchEnabled = enable;
+}
+
+
+/******************************************************************************/
+void CO_CANtxBatchBegin(CO_CANmodule_t *CANmodule){
+    if(CANmodule != NULL && txBatchEnabled){
+#ifndef CO_SINGLE_THREAD
+        CANmodule->txBatchOwner = pthread_self();
+#endif
+        CANmodule->txBatchActive = true;
+    }
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANtxBatchFlush(CO_CANmodule_t *CANmodule){
+    struct mmsghdr hdrs[CO_CAN_TX_BATCH_SIZE];
+    struct iovec iovs[CO_CAN_TX_BATCH_SIZE];
+    CO_ReturnError_t err = CO_ERROR_NO;
+    uint16_t count, sent = 0U;
+    uint16_t i;
+
+    if(CANmodule == NULL){
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    CANmodule->txBatchActive = false;
+    count = CANmodule->txBatchCount;
+    CANmodule->txBatchCount = 0U;
+    if(count == 0U){
+        return CO_ERROR_NO;
+    }
+
+    memset(hdrs, 0, count * sizeof(struct mmsghdr));
+    for(i=0U; i<count; i++){
+        iovs[i].iov_base = &CANmodule->txBatch[i];
+        iovs[i].iov_len = sizeof(struct can_frame);
+        hdrs[i].msg_hdr.msg_iov = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    /* sendmmsg may send less than requested: continue with the rest. */
+    while(sent < count){
+        int n = sendmmsg(CANmodule->fd, &hdrs[sent], count - sent, 0);
+        TX_STATS_ADD(CANmodule->txStats.syscalls, 1U);
+        if(n <= 0){
+            /* Remaining frames are lost, as with a failed write() */
+            CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_TX_OVERFLOW, CO_EMC_CAN_OVERRUN, count - sent);
+            err = CO_ERROR_TX_OVERFLOW;
+            break;
+        }
+        sent += n;
+    }
+
+    if(sent > 0U){
+        int record = CO_CANbusStatsEnabled();
+#ifdef CO_LOG_CAN_MESSAGES
+        uint64_t now = monotonicNow();
+#else
+        uint64_t now = record ? monotonicNow() : 0U;
+#endif
+        for(i=0U; i<sent; i++){
+            if(record){
+                CO_CANbusStatsRecord(CANmodule->txBatch[i].can_id, CANmodule->txBatch[i].can_dlc, CANmodule->txBatch[i].data, now, 1U);
+            }
+#ifdef CO_LOG_CAN_MESSAGES
+            CO_logMessage(&CANmodule->txBatch[i], now, 1U);
+#endif
+        }
+    }
+    TX_STATS_ADD(CANmodule->txStats.frames, sent);
+    TX_STATS_ADD(CANmodule->txStats.batches, 1U);
+    /* Batches are flushed with the OD locked: one writer at a time */
+    if(count > __atomic_load_n(&CANmodule->txStats.maxBatch, __ATOMIC_RELAXED)){
+        __atomic_store_n(&CANmodule->txStats.maxBatch, count, __ATOMIC_RELAXED);
+    }
+
+    return err;
+}
+
+
+/******************************************************************************/
+void CO_CANtxGetStats(const CO_CANmodule_t *CANmodule, CO_CANtxStats_t *stats){
+    if(CANmodule != NULL && stats != NULL){
+        stats->frames = __atomic_load_n(&CANmodule->txStats.frames, __ATOMIC_RELAXED);
+        stats->syscalls = __atomic_load_n(&CANmodule->txStats.syscalls, __ATOMIC_RELAXED);
+        stats->batches = __atomic_load_n(&CANmodule->txStats.batches, __ATOMIC_RELAXED);
+        stats->maxBatch = __atomic_load_n(&CANmodule->txStats.maxBatch, __ATOMIC_RELAXED);
+    }
+}
+
+
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule){
     /* Messages can not be cleared, because they are allready in kernel */
@@ -415,54 +686,159 @@ void CO_CANverifyErrors(CO_CANmodule_t *CANmodule){
 }
 
 
+/******************************************************************************/
+void CO_CANrxDispatch(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg){
+    uint32_t rcvMsgIdent;       /* identifier of the received message */
+    CO_CANrx_t *buffer = NULL;  /* receive message buffer from CO_CANmodule_t object. */
+    uint16_t index;
+    uint16_t i;
+
+    rcvMsgIdent = rcvMsg->ident;
+
+    /* Direct lookup of exact COB-ID filters. */
+    index = CANmodule->rxIndex[rcvMsgIdent & CAN_SFF_MASK];
+    if(index != CO_CAN_RX_INDEX_NONE){
+        buffer = &CANmodule->rxArray[index];
+        if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) != 0U){
+            /* Same COB-ID, but rtr or frame format differs: search whole rxArray. */
+            buffer = NULL;
+            index = CO_CAN_RX_INDEX_NONE;
+            for(i = 0U; i < CANmodule->rxSize; i++){
+                if(((rcvMsgIdent ^ CANmodule->rxArray[i].ident) & CANmodule->rxArray[i].mask) == 0U){
+                    buffer = &CANmodule->rxArray[i];
+                    index = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Masked filters registered before the exact match take precedence. */
+    for(i = 0U; i < CANmodule->rxMaskedCount && CANmodule->rxMasked[i] < index; i++){
+        CO_CANrx_t *masked = &CANmodule->rxArray[CANmodule->rxMasked[i]];
+        if(((rcvMsgIdent ^ masked->ident) & masked->mask) == 0U){
+            buffer = masked;
+            break;
+        }
+    }
+
+    /* Call specific function, which will process the message */
+    if(buffer != NULL && buffer->pFunct != NULL){
+        buffer->pFunct(buffer->object, rcvMsg);
+    }
+
+#ifdef CO_LOG_CAN_MESSAGES
+    CO_logMessage((const struct can_frame *) rcvMsg, CANmodule->rxTimestamp, 0U);
+#endif
+}
+
+
+/* Kernel receive timestamp of a message, converted to CLOCK_MONOTONIC *******/
+static uint64_t rxMsgTimestamp(struct msghdr *hdr, int64_t realToMonoOffset, uint64_t now){
+    struct cmsghdr *cmsg;
+
+    for(cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(hdr, cmsg)){
+        if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS){
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return (uint64_t)((int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec - realToMonoOffset);
+        }
+    }
+    return now;
+}
+
+
 /******************************************************************************/
 void CO_CANrxWait(CO_CANmodule_t *CANmodule){
-    struct can_frame msg;
-    int n, size;
+    static struct can_frame msgs[CO_CAN_RX_BATCH_SIZE];
+    static struct iovec iovs[CO_CAN_RX_BATCH_SIZE];
+    static struct mmsghdr hdrs[CO_CAN_RX_BATCH_SIZE];
+    static uint8_t ctrl[CO_CAN_RX_BATCH_SIZE][CMSG_SPACE(sizeof(struct timespec))];
+    const unsigned int size = sizeof(struct can_frame);
+    uint32_t nBatch = 0;
+    int n, i;
 
     if(CANmodule == NULL){
         errno = EFAULT;
         CO_errExit("CO_CANreceive - CANmodule not configured.");
     }
 
-    /* Read socket and pre-process message */
-    size = sizeof(struct can_frame);
-    n = read(CANmodule->fd, &msg, size);
-
-    if(CANmodule->CANnormal){
-        if(n != size){
-            /* This happens only once after error occurred (network down or something). */
-            CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_RXB_OVERFLOW, CO_EMC_COMMUNICATION, n);
+    /* Read socket and pre-process messages. Keep draining until the socket
+     * is empty (less than a full batch returned), so one epoll wakeup
+     * processes every pending frame. Only rt_thread calls this function, so
+     * static buffers are safe. */
+    do{
+        struct timespec real, mono;
+        int64_t realToMonoOffset;
+        uint64_t now;
+
+        for(i=0; i<CO_CAN_RX_BATCH_SIZE; i++){
+            iovs[i].iov_base = &msgs[i];
+            iovs[i].iov_len = size;
+            memset(&hdrs[i].msg_hdr, 0, sizeof(hdrs[i].msg_hdr));
+            hdrs[i].msg_hdr.msg_iov = &iovs[i];
+            hdrs[i].msg_hdr.msg_iovlen = 1;
+            hdrs[i].msg_hdr.msg_control = ctrl[i];
+            hdrs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
         }
-        else{
-            CO_CANrxMsg_t *rcvMsg;      /* pointer to received message in CAN module */
-            uint32_t rcvMsgIdent;       /* identifier of the received message */
-            CO_CANrx_t *buffer;         /* receive message buffer from CO_CANmodule_t object. */
-            int i;
-            bool_t msgMatched = false;
 
-            rcvMsg = (CO_CANrxMsg_t *) &msg;
-            rcvMsgIdent = rcvMsg->ident;
+        /* Block for the first frame only (as read() did), then just drain. */
+        n = recvmmsg(CANmodule->fd, hdrs, CO_CAN_RX_BATCH_SIZE,
+                     (nBatch == 0) ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+        CANmodule->rxStats.syscalls++;
 
-            /* Search rxArray form CANmodule for the matching CAN-ID. */
-            buffer = &CANmodule->rxArray[0];
-            for(i = CANmodule->rxSize; i > 0U; i--){
-                if(((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U){
-                    msgMatched = true;
-                    break;
-                }
-                buffer++;
+        if(n < 0){
+            if(nBatch == 0 && CANmodule->CANnormal){
+                /* This happens only once after error occurred (network down or something). */
+                CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_RXB_OVERFLOW, CO_EMC_COMMUNICATION, n);
             }
+            break;
+        }
 
-            /* Call specific function, which will process the message */
-            if(msgMatched && (buffer->pFunct != NULL)){
-                buffer->pFunct(buffer->object, rcvMsg);
-            }
+        /* Kernel timestamps are CLOCK_REALTIME, the rest of the stack uses CLOCK_MONOTONIC. */
+        clock_gettime(CLOCK_REALTIME, &real);
+        clock_gettime(CLOCK_MONOTONIC, &mono);
+        now = (uint64_t)mono.tv_sec * 1000000000ULL + mono.tv_nsec;
+        realToMonoOffset = ((int64_t)real.tv_sec - mono.tv_sec) * 1000000000LL + (real.tv_nsec - mono.tv_nsec);
 
-#ifdef CO_LOG_CAN_MESSAGES
-            void CO_logMessage(const CanMsg *msg);
-            CO_logMessage((CanMsg*)&rcvMsg);
+        nBatch += n;
+#ifndef CO_SINGLE_THREAD
+        pthread_mutex_lock(&CANmodule->rxLock);
 #endif
+        for(i=0; i<n; i++){
+            uint64_t timestamp;
+            if(hdrs[i].msg_len != size){
+                if(CANmodule->CANnormal){
+                    CO_errorReport((CO_EM_t*)CANmodule->em, CO_EM_CAN_RXB_OVERFLOW, CO_EMC_COMMUNICATION, hdrs[i].msg_len);
+                }
+                continue;
+            }
+            /* Bus statistics include the frames received while not in normal mode */
+            timestamp = rxMsgTimestamp(&hdrs[i].msg_hdr, realToMonoOffset, now);
+            if(CO_CANbusStatsEnabled()){
+                CO_CANbusStatsRecord(msgs[i].can_id, msgs[i].can_dlc, msgs[i].data, timestamp, 0U);
+            }
+            if(CANmodule->CANnormal){
+                CANmodule->rxTimestamp = timestamp;
+                CO_CANrxDispatch(CANmodule, (const CO_CANrxMsg_t *) &msgs[i]);
+            }
         }
+#ifndef CO_SINGLE_THREAD
+        pthread_mutex_unlock(&CANmodule->rxLock);
+#endif
+    }while(n == CO_CAN_RX_BATCH_SIZE);
+
+    CANmodule->rxStats.wakeups++;
+    CANmodule->rxStats.frames += nBatch;
+    if(nBatch > CANmodule->rxStats.maxBatch){
+        CANmodule->rxStats.maxBatch = nBatch;
+    }
+}
+
+
+/******************************************************************************/
+void CO_CANrxGetStats(const CO_CANmodule_t *CANmodule, CO_CANrxStats_t *stats){
+    if(CANmodule != NULL && stats != NULL){
+        *stats = CANmodule->rxStats;
     }
 }
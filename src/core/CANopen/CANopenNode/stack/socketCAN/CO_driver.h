@@ -43,8 +43,16 @@
 #include <linux/can/raw.h>
 
 /* general configuration */
-//    #define CO_LOG_CAN_MESSAGES   /* Call external function for each received or transmitted CAN message. */
+//    #define CO_LOG_CAN_MESSAGES   /* Call CO_logMessage() for each received or transmitted CAN message (CAN_CAPTURE in CMakeLists.txt). */
 #define CO_SDO_BUFFER_SIZE 889 /* Override default SDO buffer size. */
+#ifndef CO_CAN_RX_BATCH_SIZE
+#define CO_CAN_RX_BATCH_SIZE 32 /* Max number of frames drained by one recvmmsg() in CO_CANrxWait. */
+#endif
+#ifndef CO_CAN_TX_BATCH_SIZE
+#define CO_CAN_TX_BATCH_SIZE 32 /* Max number of frames staged between CO_CANtxBatchBegin and CO_CANtxBatchFlush. */
+#endif
+#define CO_CAN_RX_INDEX_SIZE (CAN_SFF_MASK + 1) /* One rxArray index per 11 bit COB-ID */
+#define CO_CAN_RX_INDEX_NONE 0xFFFFU            /* No buffer registered for this COB-ID */
 
 /* Critical sections */
 #ifdef CO_SINGLE_THREAD
@@ -133,6 +141,22 @@ typedef struct {
     volatile bool_t syncFlag;
 } CO_CANtx_t;
 
+/* CAN receive statistics, updated by CO_CANrxWait (informative). */
+typedef struct {
+    uint64_t wakeups;  /* Number of CO_CANrxWait calls (one per epoll wakeup) */
+    uint64_t frames;   /* Number of frames received */
+    uint64_t syscalls; /* Number of recvmmsg() calls */
+    uint32_t maxBatch; /* Largest number of frames drained in one wakeup */
+} CO_CANrxStats_t;
+
+/* CAN transmit statistics (informative), updated atomically by the sending threads. */
+typedef struct {
+    uint64_t frames;   /* Number of frames sent */
+    uint64_t syscalls; /* Number of write() and sendmmsg() calls */
+    uint64_t batches;  /* Number of flushed (non empty) batches */
+    uint32_t maxBatch; /* Largest number of frames sent in one batch */
+} CO_CANtxStats_t;
+
 /* CAN module object. */
 typedef struct {
     int32_t CANbaseAddress;
@@ -154,6 +178,21 @@ typedef struct {
     volatile uint16_t CANtxCount;
     uint32_t errOld;
     void *em;
+    CO_CANrxStats_t rxStats;
+    uint64_t rxTimestamp; /* Kernel receive time of the message being dispatched [ns, CLOCK_MONOTONIC] */
+    uint16_t rxIndex[CO_CAN_RX_INDEX_SIZE]; /* COB-ID -> lowest rxArray index with exact (full 11 bit mask) match */
+    uint16_t *rxMasked;                     /* sorted rxArray indexes of buffers with partial mask, size rxSize */
+    uint16_t rxMaskedCount;
+#ifndef CO_SINGLE_THREAD
+    pthread_mutex_t rxLock; /* rxArray, rxIndex and rxMasked: CO_CANrxBufferInit against the dispatch (priority inheritance) */
+#endif
+    CO_CANtxStats_t txStats;
+    struct can_frame txBatch[CO_CAN_TX_BATCH_SIZE]; /* frames staged by CO_CANsend while batching */
+    uint16_t txBatchCount;
+    volatile bool_t txBatchActive;
+#ifndef CO_SINGLE_THREAD
+    pthread_t txBatchOwner; /* only frames sent from this thread are staged */
+#endif
 } CO_CANmodule_t;
 
 /* Endianes */
@@ -191,7 +230,15 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule);
 /* Read CAN identifier */
 uint16_t CO_CANrxMsg_readIdent(const CO_CANrxMsg_t *rxMsg);
 
-/* Configure CAN message receive buffer. */
+/* Configure CAN message receive buffer.
+ *
+ * May be called while the RT thread receives (e.g. SDO client setup from the
+ * parallel SDO threads): the rxArray, rxIndex and rxMasked update is done
+ * under CANmodule->rxLock, which CO_CANrxWait holds while dispatching.
+ * Concurrent callers for the same CANmodule must be serialised by the caller
+ * (SDO clients: sdoChannel_mtx in CO_master.c). Must not be called from a
+ * receive buffer function (pFunct), which runs with rxLock held.
+ */
 CO_ReturnError_t CO_CANrxBufferInit(
     CO_CANmodule_t *CANmodule,
     uint16_t index,
@@ -210,9 +257,27 @@ CO_CANtx_t *CO_CANtxBufferInit(
     uint8_t noOfBytes,
     bool_t syncFlag);
 
-/* Send CAN message. */
-
+/* Send CAN message.
+ *
+ * While a transmit batch is open by the calling thread, the message is only
+ * staged and goes out with CO_CANtxBatchFlush(). */
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+
+/* Start staging messages sent by the calling thread (see CO_CANsend). */
+void CO_CANtxBatchBegin(CO_CANmodule_t *CANmodule);
+
+/* Enable (default) or disable the transmit batches: when disabled,
+ * CO_CANtxBatchBegin opens none and every message is sent with its own
+ * write(), e.g. to compare the processing time of the ticks of both. */
+void CO_CANtxBatchEnable(bool_t enable);
+
+/* Send all staged messages in original order with one sendmmsg() call
+ * (more if CO_CAN_TX_BATCH_SIZE is exceeded) and close the batch. */
+CO_ReturnError_t CO_CANtxBatchFlush(CO_CANmodule_t *CANmodule);
+
+/* Copy CAN transmit statistics of the CANmodule into stats. */
+void CO_CANtxGetStats(const CO_CANmodule_t *CANmodule, CO_CANtxStats_t *stats);
+
 /* Clear all synchronous TPDOs from CAN module transmit buffers. */
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule);
 
@@ -220,10 +285,41 @@ void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule);
 void CO_CANverifyErrors(CO_CANmodule_t *CANmodule);
 
 /* Functions receives CAN messages. It is blocking.
+ *
+ * All frames pending on the socket are drained (CO_CAN_RX_BATCH_SIZE at a
+ * time, with recvmmsg) and dispatched before returning. During dispatch,
+ * CANmodule->rxTimestamp holds the kernel receive time of the message.
  *
  * @param CANmodule This object.
  */
 void CO_CANrxWait(CO_CANmodule_t *CANmodule);
+
+/* Dispatch one received message to the matching receive buffer.
+ *
+ * Exact COB-ID filters are found in O(1) through CANmodule->rxIndex, buffers
+ * registered with a partial mask are checked in rxArray order as fallback.
+ * Result is the same as a linear search of the registered rxArray buffers
+ * (first match wins).
+ *
+ * Caller must hold CANmodule->rxLock if CO_CANrxBufferInit may run
+ * concurrently (CO_CANrxWait does).
+ */
+void CO_CANrxDispatch(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg);
+
+/* Copy CAN receive statistics of the CANmodule into stats. */
+void CO_CANrxGetStats(const CO_CANmodule_t *CANmodule, CO_CANrxStats_t *stats);
+
+#ifdef CO_LOG_CAN_MESSAGES
+/* External function called for each message dispatched (after its receive
+ * buffer function) and each message sent (once handed to the kernel). Called
+ * from the CAN receive and sending threads: must not block.
+ * Implemented by CO_canCapture.c.
+ *
+ * @param time_ns Receive or send time [ns, CLOCK_MONOTONIC]
+ * @param tx 1 if sent, 0 if received
+ */
+void CO_logMessage(const struct can_frame *frame, uint64_t time_ns, uint8_t tx);
+#endif
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
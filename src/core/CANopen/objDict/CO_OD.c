@@ -54,6 +54,8 @@
 
 #include "CO_OD.h"
 
+#include <stdlib.h>
+
 #include "CO_SDO.h"
 #include "CO_driver.h"
 
@@ -140,12 +142,7 @@ struct sCO_OD_EEPROM CO_OD_EEPROM = {
     {(void *)&CO_OD_RAM.SDOServerParameter[0].COB_IDServerToClient, 0x86, 0x4},
 };
 
-/*0x1280*/ const CO_OD_entryRecord_t OD_record1280[4] = {
-    {(void *)&CO_OD_RAM.SDOClientParameter[0].maxSubIndex, 0x06, 0x1},
-    {(void *)&CO_OD_RAM.SDOClientParameter[0].COB_IDClientToServer, 0x9e, 0x4},
-    {(void *)&CO_OD_RAM.SDOClientParameter[0].COB_IDServerToClient, 0x9e, 0x4},
-    {(void *)&CO_OD_RAM.SDOClientParameter[0].nodeIDOfTheSDOServer, 0x0e, 0x1},
-};
+/*0x1280-*/ static CO_OD_entryRecord_t OD_record1280[CO_NO_SDO_CLIENT][4]; // set in CO_OD_build()
 
 // Parameters setting the RPDO to off
 OD_RPDOCommunicationParameter_t RPDOCommParamOff = {0x2L, 0x80000000L, 0xffL};
@@ -155,25 +152,6 @@ OD_RPDOMappingParameter_t RPDOMapParamOff = {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x
 OD_RPDOCommunicationParameter_t *OD_RPDOCommunicationParameter[CO_NO_RPDO] = {&RPDOCommParamOff};
 OD_RPDOMappingParameter_t *OD_RPDOMappingParameter[CO_NO_RPDO] = {&RPDOMapParamOff};
 
-// OD_record for Entries that are off
-/*0x1400*/ CO_OD_entryRecord_t OD_recordRPDOCommOff[3] = {
-    {(void *)&(RPDOCommParamOff.maxSubIndex), 0x06, 0x1},
-    {(void *)&(RPDOCommParamOff.COB_IDUsedByRPDO), 0x8e, 0x4},
-    {(void *)&(RPDOCommParamOff.transmissionType), 0x0e, 0x1},
-};
-
-/*0x1600*/ CO_OD_entryRecord_t OD_recordRPDOMapOff[9] = {
-    {(void *)&RPDOMapParamOff.numberOfMappedObjects, 0x0e, 0x1},
-    {(void *)&RPDOMapParamOff.mappedObject1, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject2, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject3, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject4, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject5, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject6, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject7, 0x8e, 0x4},
-    {(void *)&RPDOMapParamOff.mappedObject8, 0x8e, 0x4},
-};
-
 // Parameters setting the TPDO to off
 OD_TPDOCommunicationParameter_t TPDOCommParamOff = {0x6L, 0x80000000L, 0xfeL, 0x00, 0x0L, 0x00, 0x0L};
 OD_TPDOMappingParameter_t TPDOMapParamOff = {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L, 0x0000L};
@@ -182,28 +160,6 @@ OD_TPDOMappingParameter_t TPDOMapParamOff = {0x0L, 0x0000L, 0x0000L, 0x0000L, 0x
 OD_TPDOCommunicationParameter_t *OD_TPDOCommunicationParameter[CO_NO_TPDO] = {&TPDOCommParamOff};
 OD_TPDOMappingParameter_t *OD_TPDOMappingParameter[CO_NO_TPDO] = {&TPDOMapParamOff};
 
-/*0x1800*/ const CO_OD_entryRecord_t OD_recordTPDOCommOff[7] = {
-    {(void *)&TPDOCommParamOff.maxSubIndex, 0x06, 0x1},
-    {(void *)&TPDOCommParamOff.COB_IDUsedByTPDO, 0x8e, 0x4},
-    {(void *)&TPDOCommParamOff.transmissionType, 0x0e, 0x1},
-    {(void *)&TPDOCommParamOff.inhibitTime, 0x8e, 0x2},
-    {(void *)&TPDOCommParamOff.compatibilityEntry, 0x0e, 0x1},
-    {(void *)&TPDOCommParamOff.eventTimer, 0x8e, 0x2},
-    {(void *)&TPDOCommParamOff.SYNCStartValue, 0x0e, 0x1},
-};
-
-/*0x1a00*/ const CO_OD_entryRecord_t OD_recordTPDOMapOff[9] = {
-    {(void *)&TPDOMapParamOff.numberOfMappedObjects, 0x0e, 0x1},
-    {(void *)&TPDOMapParamOff.mappedObject1, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject2, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject3, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject4, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject5, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject6, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject7, 0x8e, 0x4},
-    {(void *)&TPDOMapParamOff.mappedObject8, 0x8e, 0x4},
-};
-
 
 /*0x2130*/ const CO_OD_entryRecord_t OD_record2130[4] = {
     {(void *)&CO_OD_RAM.time.maxSubIndex, 0x06, 0x1},
@@ -212,24 +168,22 @@ OD_TPDOMappingParameter_t *OD_TPDOMappingParameter[CO_NO_TPDO] = {&TPDOMapParamO
     {(void *)&CO_OD_RAM.time.epochTimeOffsetMs, 0x9e, 0x4},
 };
 
-INTEGER16 junkData =8;
-
-const CO_OD_entryRecord_t OD_DummyDataStoreLocation[9] = {
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-    {(void *)&junkData, 0xfe, 0x2},
-};
-
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-CO_OD_entry_t CO_OD[CO_OD_NoOfElements];
+CO_OD_entry_t *CO_OD = NULL;
+static uint16_t CO_OD_capacity = 0;
+
+// PDOs registered through CO_setRPDO()/CO_setTPDO() since the last CO_configure().
+// Only these get OD entries (and PDO objects in CO_init), so the OD grows with the robot
+uint16_t CO_noRPDO = 0;
+uint16_t CO_noTPDO = 0;
+static CO_OD_entryRecord_t *RPDOCommEntry[CO_NO_RPDO];
+static CO_OD_entryRecord_t *RPDOMapEntry[CO_NO_RPDO];
+static CO_OD_entryRecord_t *RPDODataStore[CO_NO_RPDO];
+static CO_OD_entryRecord_t *TPDOCommEntry[CO_NO_TPDO];
+static CO_OD_entryRecord_t *TPDOMapEntry[CO_NO_TPDO];
+static CO_OD_entryRecord_t *TPDODataStore[CO_NO_TPDO];
 
 bool_t CO_OD_set_entry(uint16_t element_, uint16_t index_, uint8_t maxSubIndex_, uint16_t attribute_, uint16_t length_, void *pData_) {
     CO_OD[element_].index = index_;
@@ -241,81 +195,119 @@ bool_t CO_OD_set_entry(uint16_t element_, uint16_t index_, uint8_t maxSubIndex_,
 }
 
 bool_t CO_configure(void) {
-    int i;
-    CO_OD_set_entry(0, 0x1000, 0x00, 0x86, 4, (void *)&CO_OD_RAM.deviceType);
-    CO_OD_set_entry(1, 0x1001, 0x00, 0x26, 1, (void *)&CO_OD_RAM.errorRegister);
-    CO_OD_set_entry(2, 0x1002, 0x00, 0xa6, 4, (void *)&CO_OD_RAM.manufacturerStatusRegister);
-    CO_OD_set_entry(3, 0x1003, 0x08, 0x8e, 4, (void *)&CO_OD_RAM.preDefinedErrorField[0]);
-    CO_OD_set_entry(4, 0x1005, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.COB_ID_SYNCMessage);
-    CO_OD_set_entry(5, 0x1006, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.communicationCyclePeriod);
-    CO_OD_set_entry(6, 0x1007, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.synchronousWindowLength);
-    CO_OD_set_entry(7, 0x1008, 0x00, 0x86, 11, (void *)&CO_OD_RAM.manufacturerDeviceName);
-    CO_OD_set_entry(8, 0x1009, 0x00, 0x86, 4, (void *)&CO_OD_RAM.manufacturerHardwareVersion);
-    CO_OD_set_entry(9, 0x100a, 0x00, 0x86, 4, (void *)&CO_OD_RAM.manufacturerSoftwareVersion);
-    CO_OD_set_entry(10, 0x100c, 0x00, 0x85, 2, (void *)&CO_OD_ROM.guardTime);
-    CO_OD_set_entry(11, 0x100d, 0x00, 0x06, 1, (void *)&CO_OD_RAM.lifeTimeFactor);
-    CO_OD_set_entry(12, 0x1010, 0x01, 0x8e, 4, (void *)&CO_OD_RAM.storeParameters[0]);
-    CO_OD_set_entry(13, 0x1011, 0x01, 0x8e, 4, (void *)&CO_OD_RAM.restoreDefaultParameters[0]);
-    CO_OD_set_entry(14, 0x1012, 0x00, 0x85, 4, (void *)&CO_OD_ROM.COB_ID_TIME);
-    CO_OD_set_entry(15, 0x1013, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.highResolutionTimeStamp);
-    CO_OD_set_entry(16, 0x1014, 0x00, 0x86, 4, (void *)&CO_OD_RAM.COB_ID_EMCY);
-    CO_OD_set_entry(17, 0x1015, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.inhibitTimeEMCY);
-    CO_OD_set_entry(18, 0x1016, 0x04, 0x8e, 4, (void *)&CO_OD_RAM.consumerHeartbeatTime[0]);
-    CO_OD_set_entry(19, 0x1017, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.producerHeartbeatTime);
-    CO_OD_set_entry(20, 0x1018, 0x04, 0x00, 0, (void *)&OD_record1018);
-    CO_OD_set_entry(21, 0x1019, 0x00, 0x0e, 1, (void *)&CO_OD_RAM.synchronousCounterOverflowValue);
-    CO_OD_set_entry(22, 0x1029, 0x06, 0x0e, 1, (void *)&CO_OD_RAM.errorBehavior[0]);
-    CO_OD_set_entry(23, 0x1200, 0x02, 0x00, 0, (void *)&OD_record1200);
-    CO_OD_set_entry(24, 0x1280, 0x03, 0x00, 0, (void *)&OD_record1280);
-    // Initialise all PDOs to off
-    for (i = 0; i < CO_NO_RPDO; i = i + 1) {
-        CO_OD_set_entry(25 + i, 0x1400 + i, 0x02, 0x00, 0, (void *)&OD_recordRPDOCommOff);
-    }
-    for (i = 0; i < CO_NO_RPDO; i = i + 1) {
-        CO_OD_set_entry(25 + CO_NO_RPDO + i, 0x1600 + i, 0x08, 0x00, 0, (void *)&OD_recordRPDOMapOff);
-
-    }
-    for (i = 0; i < CO_NO_TPDO; i = i + 1) {
-        CO_OD_set_entry(25 + CO_NO_RPDO * 2 + i, 0x1800 + i, 0x06, 0x00, 0, (void *)&OD_recordTPDOCommOff);
-    }
-    for (i = 0; i < CO_NO_TPDO; i = i + 1) {
-        CO_OD_set_entry(25 + CO_NO_RPDO * 2 + CO_NO_TPDO + i, 0x1a00 + i, 0x08, 0x00, 0, (void *)&OD_recordTPDOMapOff);
-    }
-
-    // Also modify the pointers to the mapping parameters
+    // Forget the PDOs of a previous configuration: they are registered again by the application
     for (int i = 0; i < CO_NO_RPDO; i++) {
         OD_RPDOCommunicationParameter[i] = &RPDOCommParamOff;
         OD_RPDOMappingParameter[i] = &RPDOMapParamOff;
+        RPDOCommEntry[i] = NULL;
+        RPDOMapEntry[i] = NULL;
+        RPDODataStore[i] = NULL;
     }
     for (int i = 0; i < CO_NO_TPDO; i++) {
         OD_TPDOCommunicationParameter[i] = &TPDOCommParamOff;
         OD_TPDOMappingParameter[i] = &TPDOMapParamOff;
+        TPDOCommEntry[i] = NULL;
+        TPDOMapEntry[i] = NULL;
+        TPDODataStore[i] = NULL;
     }
+    CO_noRPDO = 0;
+    CO_noTPDO = 0;
+    return true;
+}
 
-    // PDOs go here
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 1, 0x1f80, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.NMTStartup);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 2, 0x1f81, 0x7f, 0x8e, 4, (void *)&CO_OD_RAM.slaveAssignment[0]);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 3, 0x1f82, 0x7f, 0x0e, 1, (void *)&CO_OD_RAM.requestNMT[0]);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 4, 0x1f89, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.bootTime);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 5, 0x2100, 0x00, 0xa6, 10, (void *)&CO_OD_RAM.errorStatusBits);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 6, 0x2101, 0x00, 0x0e, 1, (void *)&CO_OD_RAM.CANNodeID);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 7, 0x2102, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.CANBitRate);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 8, 0x2103, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.SYNCCounter);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 9, 0x2104, 0x00, 0x86, 2, (void *)&CO_OD_RAM.SYNCTime);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 10, 0x2106, 0x00, 0x86, 4, (void *)&CO_OD_RAM.powerOnCounter);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 11, 0x2107, 0x05, 0x8e, 2, (void *)&CO_OD_RAM.performance[0]);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 12, 0x2108, 0x01, 0x8e, 2, (void *)&CO_OD_RAM.temperature[0]);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 13, 0x2109, 0x01, 0x8e, 2, (void *)&CO_OD_RAM.voltage[0]);
-    CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 14, 0x2130, 0x03, 0x00, 0, (void *)&OD_record2130);
-    // Extra data stores for RPDO Data
-    for (int i = 0; i < CO_NO_RPDO; i++) {
-        CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 15+i, 0x6000+i, 0x08, 0x00, 0, (void *)&OD_DummyDataStoreLocation);
+bool_t CO_OD_build(void) {
+    uint16_t n = 0;
+
+    // Only grow the table: SDO objects of a previous CO_init() may still point to it until re-initialised
+    if (CO_OD == NULL || CO_OD_NoOfElements > CO_OD_capacity) {
+        CO_OD_entry_t *OD = (CO_OD_entry_t *)realloc(CO_OD, CO_OD_NoOfElements * sizeof(CO_OD_entry_t));
+        if (OD == NULL) {
+            return false;
+        }
+        CO_OD = OD;
+        CO_OD_capacity = CO_OD_NoOfElements;
+    }
+
+    // Entries must stay sorted by index (CO_OD_find() is a binary search)
+    CO_OD_set_entry(n++, 0x1000, 0x00, 0x86, 4, (void *)&CO_OD_RAM.deviceType);
+    CO_OD_set_entry(n++, 0x1001, 0x00, 0x26, 1, (void *)&CO_OD_RAM.errorRegister);
+    CO_OD_set_entry(n++, 0x1002, 0x00, 0xa6, 4, (void *)&CO_OD_RAM.manufacturerStatusRegister);
+    CO_OD_set_entry(n++, 0x1003, 0x08, 0x8e, 4, (void *)&CO_OD_RAM.preDefinedErrorField[0]);
+    CO_OD_set_entry(n++, 0x1005, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.COB_ID_SYNCMessage);
+    CO_OD_set_entry(n++, 0x1006, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.communicationCyclePeriod);
+    CO_OD_set_entry(n++, 0x1007, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.synchronousWindowLength);
+    CO_OD_set_entry(n++, 0x1008, 0x00, 0x86, 11, (void *)&CO_OD_RAM.manufacturerDeviceName);
+    CO_OD_set_entry(n++, 0x1009, 0x00, 0x86, 4, (void *)&CO_OD_RAM.manufacturerHardwareVersion);
+    CO_OD_set_entry(n++, 0x100a, 0x00, 0x86, 4, (void *)&CO_OD_RAM.manufacturerSoftwareVersion);
+    CO_OD_set_entry(n++, 0x100c, 0x00, 0x85, 2, (void *)&CO_OD_ROM.guardTime);
+    CO_OD_set_entry(n++, 0x100d, 0x00, 0x06, 1, (void *)&CO_OD_RAM.lifeTimeFactor);
+    CO_OD_set_entry(n++, 0x1010, 0x01, 0x8e, 4, (void *)&CO_OD_RAM.storeParameters[0]);
+    CO_OD_set_entry(n++, 0x1011, 0x01, 0x8e, 4, (void *)&CO_OD_RAM.restoreDefaultParameters[0]);
+    CO_OD_set_entry(n++, 0x1012, 0x00, 0x85, 4, (void *)&CO_OD_ROM.COB_ID_TIME);
+    CO_OD_set_entry(n++, 0x1013, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.highResolutionTimeStamp);
+    CO_OD_set_entry(n++, 0x1014, 0x00, 0x86, 4, (void *)&CO_OD_RAM.COB_ID_EMCY);
+    CO_OD_set_entry(n++, 0x1015, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.inhibitTimeEMCY);
+    CO_OD_set_entry(n++, 0x1016, 0x04, 0x8e, 4, (void *)&CO_OD_RAM.consumerHeartbeatTime[0]);
+    CO_OD_set_entry(n++, 0x1017, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.producerHeartbeatTime);
+    CO_OD_set_entry(n++, 0x1018, 0x04, 0x00, 0, (void *)&OD_record1018);
+    CO_OD_set_entry(n++, 0x1019, 0x00, 0x0e, 1, (void *)&CO_OD_RAM.synchronousCounterOverflowValue);
+    CO_OD_set_entry(n++, 0x1029, 0x06, 0x0e, 1, (void *)&CO_OD_RAM.errorBehavior[0]);
+    CO_OD_set_entry(n++, 0x1200, 0x02, 0x00, 0, (void *)&OD_record1200);
+    // One SDO client parameter record per SDO client (SDO master channel)
+    for (int i = 0; i < CO_NO_SDO_CLIENT; i++) {
+        OD_SDOClientParameter_t *par = &CO_OD_RAM.SDOClientParameter[i];
+        CO_OD_entryRecord_t *rec = OD_record1280[i];
+        par->maxSubIndex = 0x3L;
+        rec[0].pData = (void *)&par->maxSubIndex;
+        rec[0].attribute = 0x06;
+        rec[0].length = 0x1;
+        rec[1].pData = (void *)&par->COB_IDClientToServer;
+        rec[1].attribute = 0x9e;
+        rec[1].length = 0x4;
+        rec[2].pData = (void *)&par->COB_IDServerToClient;
+        rec[2].attribute = 0x9e;
+        rec[2].length = 0x4;
+        rec[3].pData = (void *)&par->nodeIDOfTheSDOServer;
+        rec[3].attribute = 0x0e;
+        rec[3].length = 0x1;
+        CO_OD_set_entry(n++, 0x1280 + i, 0x03, 0x00, 0, (void *)rec);
+    }
+    // PDOs go here, only the registered ones
+    for (int i = 0; i < CO_noRPDO; i++) {
+        CO_OD_set_entry(n++, 0x1400 + i, 0x02, 0x00, 0, (void *)RPDOCommEntry[i]);
+    }
+    for (int i = 0; i < CO_noRPDO; i++) {
+        CO_OD_set_entry(n++, 0x1600 + i, 0x08, 0x00, 0, (void *)RPDOMapEntry[i]);
+    }
+    for (int i = 0; i < CO_noTPDO; i++) {
+        CO_OD_set_entry(n++, 0x1800 + i, 0x06, 0x00, 0, (void *)TPDOCommEntry[i]);
+    }
+    for (int i = 0; i < CO_noTPDO; i++) {
+        CO_OD_set_entry(n++, 0x1a00 + i, 0x08, 0x00, 0, (void *)TPDOMapEntry[i]);
+    }
+    CO_OD_set_entry(n++, 0x1f80, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.NMTStartup);
+    CO_OD_set_entry(n++, 0x1f81, 0x7f, 0x8e, 4, (void *)&CO_OD_RAM.slaveAssignment[0]);
+    CO_OD_set_entry(n++, 0x1f82, 0x7f, 0x0e, 1, (void *)&CO_OD_RAM.requestNMT[0]);
+    CO_OD_set_entry(n++, 0x1f89, 0x00, 0x8e, 4, (void *)&CO_OD_RAM.bootTime);
+    CO_OD_set_entry(n++, 0x2100, 0x00, 0xa6, 10, (void *)&CO_OD_RAM.errorStatusBits);
+    CO_OD_set_entry(n++, 0x2101, 0x00, 0x0e, 1, (void *)&CO_OD_RAM.CANNodeID);
+    CO_OD_set_entry(n++, 0x2102, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.CANBitRate);
+    CO_OD_set_entry(n++, 0x2103, 0x00, 0x8e, 2, (void *)&CO_OD_RAM.SYNCCounter);
+    CO_OD_set_entry(n++, 0x2104, 0x00, 0x86, 2, (void *)&CO_OD_RAM.SYNCTime);
+    CO_OD_set_entry(n++, 0x2106, 0x00, 0x86, 4, (void *)&CO_OD_RAM.powerOnCounter);
+    CO_OD_set_entry(n++, 0x2107, 0x05, 0x8e, 2, (void *)&CO_OD_RAM.performance[0]);
+    CO_OD_set_entry(n++, 0x2108, 0x01, 0x8e, 2, (void *)&CO_OD_RAM.temperature[0]);
+    CO_OD_set_entry(n++, 0x2109, 0x01, 0x8e, 2, (void *)&CO_OD_RAM.voltage[0]);
+    CO_OD_set_entry(n++, 0x2130, 0x03, 0x00, 0, (void *)&OD_record2130);
+    // Extra data stores for RPDO data
+    for (int i = 0; i < CO_noRPDO; i++) {
+        CO_OD_set_entry(n++, CO_OD_RPDO_DATA_INDEX + i, 0x08, 0x00, 0, (void *)RPDODataStore[i]);
     }
     // Extra data stores for TPDO data
-    for (int i = 0; i < CO_NO_TPDO; i++) {
-        CO_OD_set_entry(24 + 2 * CO_NO_RPDO + 3 * CO_NO_TPDO + 15 + i, 0x6000 + CO_NO_RPDO + i, 0x08, 0x00, 0, (void *)&OD_DummyDataStoreLocation);
+    for (int i = 0; i < CO_noTPDO; i++) {
+        CO_OD_set_entry(n++, CO_OD_TPDO_DATA_INDEX + i, 0x08, 0x00, 0, (void *)TPDODataStore[i]);
     }
-    return true;
+    return n == CO_OD_NoOfElements;
 }
 
 // Should return RPDO number
@@ -325,38 +317,34 @@ bool_t CO_configure(void) {
  * 
  * @return int RPDO number
  */
-int currRPDO = 0;
-
-int CO_setRPDO(OD_RPDOCommunicationParameter_t *RPDOCommParams, OD_RPDOMappingParameter_t *RPDOMapParams, CO_OD_entryRecord_t *RPDOCommEntry, CO_OD_entryRecord_t *dataStoreRecord, CO_OD_entryRecord_t *RPDOMapParamsEntry) {
+int CO_setRPDO(OD_RPDOCommunicationParameter_t *RPDOCommParams, OD_RPDOMappingParameter_t *RPDOMapParams, CO_OD_entryRecord_t *RPDOCommEntryRecord, CO_OD_entryRecord_t *dataStoreRecord, CO_OD_entryRecord_t *RPDOMapParamsEntry) {
     // Should check that the COB-ID is not being used at the moment
     // Could also add a flag which says whether it should be checked or not
 
-    if (currRPDO < CO_NO_RPDO){
+    if (CO_noRPDO < CO_NO_RPDO){
         // Iterate through the Mapped Objects to set the parameters
         //This is super hacky and crap.. seriously... why did they set it up in this way?
         uint32_t *pMap = &RPDOMapParams->mappedObject1;
         for (int i = 0; i < RPDOMapParams->numberOfMappedObjects; i++) {
             uint32_t map = *pMap;
 
-            // Change it to 0x6000
-            *pMap = (0x60000000 + currRPDO*0x10000)| (0x0000FFFF & map);
+            // Change it to the data store of this RPDO
+            *pMap = ((uint32_t)(CO_OD_RPDO_DATA_INDEX + CO_noRPDO) << 16) | (0x0000FFFF & map);
             pMap++;
         }
 
-        // Change the OD entry
-        CO_OD[25 + currRPDO].pData = (void *)RPDOCommEntry;
-        CO_OD[25 + CO_NO_RPDO+ currRPDO].pData = (void *)RPDOMapParamsEntry;
-
         // Change the Mapping Parameter Entry
-        OD_RPDOCommunicationParameter[currRPDO] = RPDOCommParams;
-        OD_RPDOMappingParameter[currRPDO] = RPDOMapParams;
+        OD_RPDOCommunicationParameter[CO_noRPDO] = RPDOCommParams;
+        OD_RPDOMappingParameter[CO_noRPDO] = RPDOMapParams;
 
-        // Change the relevant OD location
-        CO_OD[24 + 2 * CO_NO_RPDO + 2 * CO_NO_TPDO + 15 + currRPDO].pData = (void *)dataStoreRecord;
+        // Remember the OD records, the OD entries are laid out by CO_OD_build()
+        RPDOCommEntry[CO_noRPDO] = RPDOCommEntryRecord;
+        RPDOMapEntry[CO_noRPDO] = RPDOMapParamsEntry;
+        RPDODataStore[CO_noRPDO] = dataStoreRecord;
 
         // increment counter, but return the original value
-        currRPDO = currRPDO +1;
-        return currRPDO;
+        CO_noRPDO = CO_noRPDO + 1;
+        return CO_noRPDO;
     }
     return -1; // Error  - too many PDOs defined
 }
@@ -368,36 +356,34 @@ int CO_setRPDO(OD_RPDOCommunicationParameter_t *RPDOCommParams, OD_RPDOMappingPa
  * 
  * @return int TPDO number
  */
-int currTPDO = 0;
-int CO_setTPDO(OD_TPDOCommunicationParameter_t *TPDOCommParams, OD_TPDOMappingParameter_t *TPDOMapParams, CO_OD_entryRecord_t *TPDOCommEntry, CO_OD_entryRecord_t *dataStoreRecord, CO_OD_entryRecord_t *TPDOMapParamsEntry) {
+int CO_setTPDO(OD_TPDOCommunicationParameter_t *TPDOCommParams, OD_TPDOMappingParameter_t *TPDOMapParams, CO_OD_entryRecord_t *TPDOCommEntryRecord, CO_OD_entryRecord_t *dataStoreRecord, CO_OD_entryRecord_t *TPDOMapParamsEntry) {
     // Should check that the COB-ID is not being used at the moment
     // Could also add a flag which says whether it should be checked or not
 
-    if (currTPDO < CO_NO_TPDO) {
+    if (CO_noTPDO < CO_NO_TPDO) {
         // Iterate through the Mapped Objects to set the parameters
         //This is super hacky and crap.. seriously... why did they set it up in this way?
         uint32_t *pMap = &TPDOMapParams->mappedObject1;
         for (int i = 0; i < TPDOMapParams->numberOfMappedObjects; i++) {
             uint32_t map = *pMap;
 
-            // Change it to 0x6000
-            *pMap = (0x60000000 + (CO_NO_RPDO+currTPDO) * 0x10000) | (0x0000FFFF & map);
+            // Change it to the data store of this TPDO
+            *pMap = ((uint32_t)(CO_OD_TPDO_DATA_INDEX + CO_noTPDO) << 16) | (0x0000FFFF & map);
             pMap++;
         }
 
-        // Change the OD entry
-        CO_OD[25 + 2*CO_NO_RPDO +currTPDO].pData = (void *)TPDOCommEntry;
-        CO_OD[25 + 2 * CO_NO_RPDO + CO_NO_TPDO + currTPDO].pData = (void *)TPDOMapParamsEntry;
-
         // Change the Mapping Parameter Entry
-        OD_TPDOCommunicationParameter[currTPDO] = TPDOCommParams;
-        OD_TPDOMappingParameter[currTPDO] = TPDOMapParams;
+        OD_TPDOCommunicationParameter[CO_noTPDO] = TPDOCommParams;
+        OD_TPDOMappingParameter[CO_noTPDO] = TPDOMapParams;
+
+        // Remember the OD records, the OD entries are laid out by CO_OD_build()
+        TPDOCommEntry[CO_noTPDO] = TPDOCommEntryRecord;
+        TPDOMapEntry[CO_noTPDO] = TPDOMapParamsEntry;
+        TPDODataStore[CO_noTPDO] = dataStoreRecord;
 
-        // Change the relevant OD location
-        CO_OD[24 + 3 * CO_NO_RPDO + 2 * CO_NO_TPDO + 15 + currTPDO].pData = (void *)dataStoreRecord;
         // increment counter, but return the original value
-        currTPDO = currTPDO + 1;
-        return currTPDO;
+        CO_noTPDO = CO_noTPDO + 1;
+        return CO_noTPDO;
     }
     return -1;  // Error  - too many PDOs defined
 }
@@ -102,17 +102,29 @@ typedef domain_t CO_DOMAIN;
 #define CO_NO_SYNC 1        //Associated objects: 1005-1007
 #define CO_NO_EMERGENCY 1   //Associated objects: 1014, 1015
 #define CO_NO_SDO_SERVER 1  //Associated objects: 1200-127F
-#define CO_NO_SDO_CLIENT 1  //Associated objects: 1280-12FF
+#define CO_NO_SDO_CLIENT 16 //Associated objects: 1280-12FF (one per SDO master channel)
 #define CO_NO_LSS_SERVER 0  //LSS Slave
 #define CO_NO_LSS_CLIENT 0  //LSS Master
-#define CO_NO_RPDO 32       //Associated objects: 14xx, 16xx
-#define CO_NO_TPDO 32       //Associated objects: 18xx, 1Axx
+#define CO_NO_RPDO 0x200    //Maximum, associated objects: 14xx, 16xx (number in use: CO_noRPDO)
+#define CO_NO_TPDO 0x200    //Maximum, associated objects: 18xx, 1Axx (number in use: CO_noTPDO)
 #define CO_NO_NMT_MASTER 1
 
 /*******************************************************************************
    OBJECT DICTIONARY
 *******************************************************************************/
-#define CO_OD_NoOfElements (39 + CO_NO_RPDO * 3 + CO_NO_TPDO * 3)
+/* The PDO entries (14xx-1Axx and their data stores) are only created for the
+   PDOs registered with CO_setRPDO()/CO_setTPDO(), so the size is known at runtime */
+extern uint16_t CO_noRPDO;
+extern uint16_t CO_noTPDO;
+#define CO_OD_NoOfFixedElements (38 + CO_NO_SDO_CLIENT)
+#define CO_OD_NoOfElements (CO_OD_NoOfFixedElements + CO_noRPDO * 3 + CO_noTPDO * 3)
+#define CO_OD_MaxNoOfElements (CO_OD_NoOfFixedElements + CO_NO_RPDO * 3 + CO_NO_TPDO * 3)
+
+/* Indexes of the data stores the PDO mappings are redirected to */
+#define CO_OD_RPDO_DATA_INDEX 0x6000
+#define CO_OD_TPDO_DATA_INDEX (CO_OD_RPDO_DATA_INDEX + CO_NO_RPDO)
+
+extern CO_OD_entry_t *CO_OD;
 
 /*******************************************************************************
    TYPE DEFINITIONS FOR RECORDS
@@ -713,7 +725,7 @@ struct sCO_OD_RAM {
     /*1019      */ UNSIGNED8 synchronousCounterOverflowValue;
     /*1029      */ UNSIGNED8 errorBehavior[6];
     /*1200      */ OD_SDOServerParameter_t SDOServerParameter[1];
-    /*1280      */ OD_SDOClientParameter_t SDOClientParameter[1];
+    /*1280      */ OD_SDOClientParameter_t SDOClientParameter[CO_NO_SDO_CLIENT];
     /*1f80      */ UNSIGNED32 NMTStartup;
     /*1f81      */ UNSIGNED32 slaveAssignment[127];
     /*1f82      */ UNSIGNED8 requestNMT[127];
@@ -939,6 +951,14 @@ extern OD_TPDOMappingParameter_t *OD_TPDOMappingParameter[CO_NO_TPDO];
  */
 bool_t CO_configure(void);
 
+/**
+ * Lays out the Object Dictionary (CO_OD) with the PDOs registered since the
+ * last CO_configure(). Called by CO_init().
+ *
+ * @return Success or failure (out of memory) of the build
+ */
+bool_t CO_OD_build(void);
+
 /**
  * Configures a single element in the object dictionary
  *
@@ -0,0 +1,144 @@
+#include "ControlLoopScheduler.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "logging.h"
+
+namespace {
+unsigned int gcd(unsigned int a, unsigned int b) {
+    while (b != 0) {
+        unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+}  // namespace
+
+ControlLoopScheduler &ControlLoopScheduler::instance() {
+    static ControlLoopScheduler scheduler;
+    return scheduler;
+}
+
+int ControlLoopScheduler::addTask(const std::string &name, double rate_hz, Task_t task, int phase) {
+    if (rate_hz <= 0) {
+        spdlog::error("ControlLoopScheduler: invalid rate {}Hz for task {}.", rate_hz, name);
+        return -1;
+    }
+    double controlRate = 1000. / period;
+    if (rate_hz > controlRate) {
+        spdlog::warn("ControlLoopScheduler: task {} at {}Hz, faster than the control loop: run at {}Hz.", name, rate_hz, controlRate);
+    }
+    long divider = std::lround(controlRate / rate_hz);
+    return addTaskDivider(name, divider > 1 ? divider : 1, task, phase);
+}
+
+int ControlLoopScheduler::addTaskDivider(const std::string &name, unsigned int divider, Task_t task, int phase) {
+    if (divider == 0) {
+        divider = 1;
+    }
+    if (phase >= (int)divider) {
+        spdlog::warn("ControlLoopScheduler: phase {} of task {} out of range (divider {}): phase {} used.", phase, name, divider, phase % divider);
+        phase %= divider;
+    }
+    unsigned int p = phase < 0 ? leastLoadedPhase(divider) : phase;
+    int id = nextId++;
+    ScheduledTask t = {id, name, divider, p, task, true, 0};
+    if (running) {
+        //Added by a running task: starts with the next period
+        pending.push_back(t);
+    } else {
+        tasks.push_back(t);
+    }
+    spdlog::debug("ControlLoopScheduler: task {} ({}) every {} periods ({:.1f}Hz), phase {}.", name, id, divider, 1000. / (period * divider), p);
+    return id;
+}
+
+bool ControlLoopScheduler::removeTask(int id) {
+    for (auto *list : {&tasks, &pending}) {
+        for (auto it = list->begin(); it != list->end(); it++) {
+            if (it->id == id && it->active) {
+                if (running) {
+                    it->active = false;  // Erased at the end of tick()
+                } else {
+                    list->erase(it);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ControlLoopScheduler::clear() {
+    if (running) {
+        for (auto &t : tasks) {
+            t.active = false;
+        }
+    } else {
+        tasks.clear();
+    }
+    pending.clear();
+}
+
+unsigned int ControlLoopScheduler::leastLoadedPhase(unsigned int divider) const {
+    //Load of the periods in which the new task would run: a task j runs in a fraction g/divider_j of them
+    //(g = gcd(divider, divider_j)) if the phases are compatible (p = phase_j mod g), and never otherwise.
+    unsigned int best = 0;
+    double bestLoad = -1;
+    for (unsigned int p = 0; p < divider; p++) {
+        double load = 0;
+        for (auto *list : {&tasks, &pending}) {
+            for (const auto &t : *list) {
+                unsigned int g = gcd(divider, t.divider);
+                if (t.active && t.divider > 1 && p % g == t.phase % g) {
+                    load += (double)g / t.divider;
+                }
+            }
+        }
+        if (bestLoad < 0 || load < bestLoad - 1e-9) {
+            best = p;
+            bestLoad = load;
+        }
+    }
+    return best;
+}
+
+void ControlLoopScheduler::tick() {
+    running = true;
+    for (auto &t : tasks) {
+        if (t.active && tickCount % t.divider == t.phase) {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            t.task();
+            double dt = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (dt > t.maxTime) {
+                t.maxTime = dt;
+            }
+        }
+    }
+    running = false;
+    tickCount++;
+
+    //Apply the changes made by the tasks
+    for (auto it = tasks.begin(); it != tasks.end();) {
+        it = it->active ? it + 1 : tasks.erase(it);
+    }
+    for (auto &t : pending) {
+        if (t.active) {
+            tasks.push_back(std::move(t));
+        }
+    }
+    pending.clear();
+}
+
+void ControlLoopScheduler::logTasks() const {
+    if (tasks.empty()) {
+        return;
+    }
+    spdlog::info("Control loop tasks ({}ms period):", period);
+    for (const auto &t : tasks) {
+        spdlog::info("  {:<24} {:>7.1f}Hz (every {} periods, phase {}), max {:.3f}ms", t.name, 1000. / (period * t.divider),
+                     t.divider, t.phase, t.maxTime);
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * \file ControlLoopScheduler.h
+ * \brief Sub-rate tasks of the control loop: periodic functions run by rt_control_thread every N control loop
+ * periods, after the state machine update.
+ *
+ * States and robots register tasks slower than the control loop (e.g. UI streaming at 100Hz, diagnostics at 10Hz
+ * with a 1kHz control loop) so that they do not run, and take time, every period. Each task gets a phase offset
+ * (in periods), chosen deterministically at registration to spread the tasks over the periods: the same
+ * registrations always give the same schedule. For example, with a 1ms control loop:
+ * \code
+ * int id = ControlLoopScheduler::instance().addTask("UI stream", 100, [this] { streamState(); });
+ * ...
+ * ControlLoopScheduler::instance().removeTask(id); //e.g. in State exit()
+ * \endcode
+ * Registration and removal are to be done from the control loop thread (State and StateMachine methods,
+ * Robot initialisation), including from a running task. Tasks are cleared at the end of the application.
+ *
+ * \version 0.1
+ *
+ */
+#ifndef CONTROLLOOPSCHEDULER_H_INCLUDED
+#define CONTROLLOOPSCHEDULER_H_INCLUDED
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class ControlLoopScheduler {
+   public:
+    typedef std::function<void()> Task_t;
+
+    /**
+     * \brief The scheduler run by rt_control_thread
+     */
+    static ControlLoopScheduler &instance();
+
+    /**
+     * \brief Sets the control loop period (ms), used to convert the tasks rates into a number of periods.
+     * Set by the application at startup (RTConfig controlLoopPeriod).
+     */
+    void setPeriod(double period_ms) { period = period_ms; }
+    double getPeriod() const { return period; }
+
+    /**
+     * \brief Registers a periodic task
+     *
+     * \param name Task name (logs)
+     * \param rate_hz Task rate: rounded to an integer divider of the control loop rate, at most the control loop rate
+     * \param task Function to run
+     * \param phase Phase offset in periods (0 to divider-1), -1 to let the scheduler choose the least loaded one
+     * \return Task id (for removeTask())
+     */
+    int addTask(const std::string &name, double rate_hz, Task_t task, int phase = -1);
+
+    /**
+     * \brief Registers a task running every divider control loop periods
+     */
+    int addTaskDivider(const std::string &name, unsigned int divider, Task_t task, int phase = -1);
+
+    /**
+     * \brief Removes a task (can be called by the task itself)
+     *
+     * \return false if no such task
+     */
+    bool removeTask(int id);
+
+    /**
+     * \brief Removes all tasks
+     */
+    void clear();
+
+    /**
+     * \brief Runs the tasks due this period. Called by the control loop once per period.
+     */
+    void tick();
+
+    /**
+     * \brief Logs the registered tasks: rate, phase and maximum execution time
+     */
+    void logTasks() const;
+
+   private:
+    ControlLoopScheduler(){};
+
+    struct ScheduledTask {
+        int id;
+        std::string name;
+        unsigned int divider;
+        unsigned int phase;
+        Task_t task;
+        bool active;
+        double maxTime;  // ms
+    };
+
+    unsigned int leastLoadedPhase(unsigned int divider) const;
+
+    std::vector<ScheduledTask> tasks;
+    std::vector<ScheduledTask> pending;  // Added during tick(), run from the next period
+    double period = 2.;
+    uint64_t tickCount = 0;
+    int nextId = 0;
+    bool running = false;  // In tick(): removed tasks are only deactivated
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "LatencyHistogram.h"
+
+#include <stdio.h>
+
+#include <mutex>
+#include <string>
+
+#include "logging.h"
+
+namespace {
+std::mutex registryMutex;
+LatencyHistogram *registry[LATENCY_HIST_MAX_NUMBER] = {nullptr};
+}  // namespace
+
+LatencyHistogram::LatencyHistogram(const char *name) : name(name), sum(0), min(UINT64_MAX), max(0) {
+    for (auto &c : counts) {
+        c.store(0, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto &h : registry) {
+        if (h == nullptr) {
+            h = this;
+            return;
+        }
+    }
+    //Still usable, only not exported
+    fprintf(stderr, "LatencyHistogram %s: more than %d histograms, not registered.\n", name, LATENCY_HIST_MAX_NUMBER);
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto &h : registry) {
+        if (h == this) {
+            h = nullptr;
+        }
+    }
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned int i) {
+    if (i < (1u << LATENCY_HIST_SUB_BITS)) {
+        return i;
+    }
+    unsigned int m = (i >> LATENCY_HIST_SUB_BITS) - 1;
+    uint64_t sub = (i & ((1u << LATENCY_HIST_SUB_BITS) - 1)) + (1u << LATENCY_HIST_SUB_BITS);
+    return ((sub + 1) << m) - 1;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    //Snapshot of the buckets: percentiles from a consistent total even if the writer records meanwhile
+    uint64_t snapshot[LATENCY_HIST_BUCKETS];
+    LatencySummary s = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (unsigned int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        snapshot[i] = counts[i].load(std::memory_order_relaxed);
+        s.count += snapshot[i];
+    }
+    if (s.count == 0) {
+        return s;
+    }
+    s.min = min.load(std::memory_order_relaxed) / 1000.;
+    s.max = max.load(std::memory_order_relaxed) / 1000.;
+    s.mean = sum.load(std::memory_order_relaxed) / 1000. / s.count;
+
+    const double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+    double *values[] = {&s.p50, &s.p90, &s.p99, &s.p999};
+    unsigned int p = 0;
+    uint64_t cumulated = 0;
+    for (unsigned int i = 0; i < LATENCY_HIST_BUCKETS && p < 4; i++) {
+        cumulated += snapshot[i];
+        while (p < 4 && cumulated > percentiles[p] * s.count) {
+            //Bucket bound, but never above the recorded maximum
+            double v = bucketUpperBound(i) / 1000.;
+            *values[p++] = v < s.max ? v : s.max;
+        }
+    }
+    return s;
+}
+
+bool LatencyHistogram::dump(const char *filename) {
+    std::string tmpFilename = std::string(filename) + ".tmp";
+    FILE *f = fopen(tmpFilename.c_str(), "w");
+    if (f == NULL) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    fprintf(f, "# Latency histograms (us): name, count, min, mean, p50, p90, p99, p99.9, max\n");
+    for (auto h : registry) {
+        if (h != nullptr) {
+            LatencySummary s = h->summary();
+            fprintf(f, "%s, %lu, %.1f, %.1f, %.1f, %.1f, %.1f, %.1f, %.1f\n", h->name, (unsigned long)s.count, s.min, s.mean,
+                    s.p50, s.p90, s.p99, s.p999, s.max);
+        }
+    }
+    fprintf(f, "# Buckets: name, bucket upper bound (ns), count (non empty buckets only)\n");
+    for (auto h : registry) {
+        if (h != nullptr) {
+            for (unsigned int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+                uint64_t c = h->counts[i].load(std::memory_order_relaxed);
+                if (c > 0) {
+                    fprintf(f, "%s, %lu, %lu\n", h->name, (unsigned long)bucketUpperBound(i), (unsigned long)c);
+                }
+            }
+        }
+    }
+    bool ok = (fclose(f) == 0);
+    return ok && rename(tmpFilename.c_str(), filename) == 0;
+}
+
+void LatencyHistogram::logSummary() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    spdlog::info("Latency histograms (us):        count      min     mean      p50      p90      p99    p99.9      max");
+    for (auto h : registry) {
+        if (h != nullptr) {
+            LatencySummary s = h->summary();
+            spdlog::info("  {:<28} {:>8} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f}", h->name, s.count, s.min, s.mean,
+                         s.p50, s.p90, s.p99, s.p999, s.max);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * \file LatencyHistogram.h
+ * \brief Timing histograms of the real-time threads (wake-up latency, period jitter, compute time), recorded
+ * lock free and without allocation from the thread they measure.
+ *
+ * Log-linear buckets (as HDR histograms): values below 2^LATENCY_HIST_SUB_BITS ns have their own bucket, larger
+ * ones are split in 2^LATENCY_HIST_SUB_BITS buckets per power of two, that is a relative resolution of ~3%
+ * from 32ns up to ~68.7s (2^36 ns, larger values in the last bucket). One writer thread per histogram; any
+ * thread may read (summary(), dump()) while it records.
+ *
+ * Histograms register themselves on construction: dump() periodically exports all of them to a text file and
+ * logSummary() logs them (e.g. at shutdown).
+ *
+ * \version 0.1
+ *
+ */
+#ifndef LATENCYHISTOGRAM_H_INCLUDED
+#define LATENCYHISTOGRAM_H_INCLUDED
+
+#include <stdint.h>
+
+#include <atomic>
+
+#define LATENCY_HIST_SUB_BITS 5     /*!< 2^LATENCY_HIST_SUB_BITS buckets per power of two */
+#define LATENCY_HIST_BUCKETS 1024   /*!< Number of buckets (up to 2^36 ns) */
+#define LATENCY_HIST_MAX_NUMBER 16  /*!< Maximum number of registered histograms */
+
+/**
+ * \brief Statistics of a histogram, in us. Percentiles are the upper bound of their bucket.
+ *
+ */
+struct LatencySummary {
+    uint64_t count;
+    double min, mean, p50, p90, p99, p999, max;
+};
+
+class LatencyHistogram {
+   public:
+    /**
+     * \param name Name used in the dump and summary (e.g. "rt_control_thread wakeup"), must outlive the histogram
+     */
+    LatencyHistogram(const char *name);
+    ~LatencyHistogram();
+
+    /**
+     * \brief Records a value (ns, negative values count as 0). Single writer: to call from one thread only.
+     */
+    void record(int64_t value_ns) {
+        uint64_t v = value_ns > 0 ? value_ns : 0;
+        std::atomic<uint64_t> &bucket = counts[bucketIndex(v)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+        if (v < min.load(std::memory_order_relaxed)) {
+            min.store(v, std::memory_order_relaxed);
+        }
+        if (v > max.load(std::memory_order_relaxed)) {
+            max.store(v, std::memory_order_relaxed);
+        }
+    }
+
+    const char *getName() const { return name; }
+
+    /**
+     * \brief Current statistics (since construction). Can be called from any thread.
+     */
+    LatencySummary summary() const;
+
+    /**
+     * \brief Writes the summary and the non empty buckets of all the registered histograms to a text file.
+     * The file is written aside and renamed, so that a reader never sees it partially written. Not real-time.
+     *
+     * \return true on success
+     */
+    static bool dump(const char *filename = "logs/CORC_latency.txt");
+
+    /**
+     * \brief Logs the summary of all the registered histograms (info level)
+     */
+    static void logSummary();
+
+   private:
+    static unsigned int bucketIndex(uint64_t v) {
+        if (v < (1u << LATENCY_HIST_SUB_BITS)) {
+            return v;
+        }
+        unsigned int m = 63 - __builtin_clzll(v) - LATENCY_HIST_SUB_BITS;
+        unsigned int i = ((m + 1) << LATENCY_HIST_SUB_BITS) + (v >> m) - (1u << LATENCY_HIST_SUB_BITS);
+        return i < LATENCY_HIST_BUCKETS ? i : LATENCY_HIST_BUCKETS - 1;
+    }
+    static uint64_t bucketUpperBound(unsigned int i);
+
+    const char *name;
+    std::atomic<uint64_t> counts[LATENCY_HIST_BUCKETS];
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+};
+
+#endif
@@ -0,0 +1,331 @@
+#include "RTConfig.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include "logging.h"
+#include "yaml-cpp/yaml.h"
+
+namespace {
+RTConfig config;
+bool memoryLocked = false;
+std::vector<int> isolatedCpus;
+
+//Layout in effect once applyThreadConfig() returned, one entry per thread name, for logRTLayout(). Recorded
+//when applied: short lived threads (e.g. sdo_parallel) may be joined by the time it is logged.
+struct AppliedThread {
+    std::string name;
+    int policy;
+    int priority;
+    std::vector<int> cpus;
+};
+std::mutex threadsMutex;
+std::vector<AppliedThread> threads;
+
+const char *policyName(int policy) {
+    switch (policy) {
+        case SCHED_FIFO:
+            return "FIFO";
+        case SCHED_RR:
+            return "RR";
+        case SCHED_OTHER:
+            return "OTHER";
+        default:
+            return "?";
+    }
+}
+
+//CPU list in the kernel format, e.g. "1-3,5"
+std::vector<int> parseCpuList(const std::string &list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        int first, last;
+        int n = sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (n == 1) {
+            last = first;
+        } else if (n != 2) {
+            continue;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::string cpuListString(const std::vector<int> &cpus) {
+    if (cpus.empty()) {
+        return "all";
+    }
+    std::string s;
+    for (unsigned int i = 0; i < cpus.size(); i++) {
+        s += (i > 0 ? "," : "") + std::to_string(cpus[i]);
+    }
+    return s;
+}
+
+void loadThreadConfig(const YAML::Node &node, RTThreadConfig &thread) {
+    if (!node) {
+        return;
+    }
+    if (node["policy"]) {
+        std::string policy = node["policy"].as<std::string>();
+        if (policy == "FIFO") {
+            thread.policy = SCHED_FIFO;
+        } else if (policy == "RR") {
+            thread.policy = SCHED_RR;
+        } else if (policy == "OTHER") {
+            thread.policy = SCHED_OTHER;
+        } else {
+            spdlog::error("Unknown scheduling policy {} (FIFO, RR or OTHER): ignored.", policy);
+        }
+    }
+    if (node["priority"]) {
+        thread.priority = node["priority"].as<int>();
+    }
+    if (node["cpus"]) {
+        thread.cpus = node["cpus"].as<std::vector<int>>();
+    }
+    if (thread.policy == SCHED_OTHER) {
+        thread.priority = 0;
+    }
+}
+}  // namespace
+
+RTConfig &rtConfig() {
+    return config;
+}
+
+bool loadRTConfig(const std::string &filename) {
+    YAML::Node params;
+    try {
+        params = YAML::LoadFile(filename)["rt_config"];
+    } catch (...) {
+        spdlog::info("No real-time configuration ({}): default threads layout.", filename);
+        return false;
+    }
+    if (!params) {
+        spdlog::warn("No rt_config section in {}: default threads layout.", filename);
+        return false;
+    }
+    try {
+        if (params["lock_memory"]) {
+            config.lockMemory = params["lock_memory"].as<bool>();
+        }
+        if (params["prefault_stack_kb"]) {
+            config.prefaultStackSize = params["prefault_stack_kb"].as<size_t>() * 1024;
+        }
+        if (params["isolated_cores"]) {
+            config.isolatedCores = params["isolated_cores"].as<bool>();
+        }
+        if (params["timing"]) {
+            YAML::Node timing = params["timing"];
+            if (timing["control_period_ms"]) {
+                config.controlLoopPeriod = timing["control_period_ms"].as<float>();
+            }
+            if (timing["can_update_period_ms"]) {
+                config.CANUpdateLoopPeriod = timing["can_update_period_ms"].as<float>();
+            }
+            if (timing["active_wait_ms"]) {
+                config.activeWaitTime = timing["active_wait_ms"].as<float>();
+            }
+            if (timing["adaptive_active_wait"]) {
+                config.adaptiveActiveWait = timing["adaptive_active_wait"].as<bool>();
+            }
+            if (timing["sync_lock"]) {
+                config.controlLoopSyncLock = timing["sync_lock"].as<bool>();
+            }
+            if (timing["sync_offset_ms"]) {
+                config.controlLoopSyncOffset = timing["sync_offset_ms"].as<float>();
+            }
+            if (timing["tpdo_flush"]) {
+                config.flushTPDOs = timing["tpdo_flush"].as<bool>();
+            }
+            if (timing["tx_batching"]) {
+                config.txBatching = timing["tx_batching"].as<bool>();
+            }
+        }
+        if (params["bus"]) {
+            YAML::Node bus = params["bus"];
+            if (bus["bitrate_kbps"]) {
+                config.CANBitrate = bus["bitrate_kbps"].as<float>();
+            }
+            if (bus["load_budget_percent"]) {
+                config.busLoadBudget = bus["load_budget_percent"].as<float>();
+            }
+            if (bus["refuse_over_budget"]) {
+                config.busLoadStrict = bus["refuse_over_budget"].as<bool>();
+            }
+            if (bus["statistics"]) {
+                config.busStatistics = bus["statistics"].as<bool>();
+            }
+        }
+        if (params["threads"]) {
+            loadThreadConfig(params["threads"]["rt_thread"], config.rtThread);
+            loadThreadConfig(params["threads"]["rt_control_thread"], config.rtControlThread);
+            loadThreadConfig(params["threads"]["main"], config.mainThread);
+            loadThreadConfig(params["threads"]["non_rt"], config.nonRTThreads);
+        }
+    } catch (...) {
+        spdlog::error("Failed loading real-time configuration from {}.", filename);
+        return false;
+    }
+    spdlog::info("Real-time configuration loaded from {}.", filename);
+
+    RTConfig defaults;
+    if (config.controlLoopPeriod < 1.) {
+        spdlog::error("control_period_ms {} below the CANopen rt_thread interval (1ms): using {}ms.", config.controlLoopPeriod, defaults.controlLoopPeriod);
+        config.controlLoopPeriod = defaults.controlLoopPeriod;
+    }
+    if (config.CANUpdateLoopPeriod <= 0.) {
+        spdlog::error("Invalid can_update_period_ms {}: using {}ms.", config.CANUpdateLoopPeriod, defaults.CANUpdateLoopPeriod);
+        config.CANUpdateLoopPeriod = defaults.CANUpdateLoopPeriod;
+    }
+    if (config.activeWaitTime < 0. || config.activeWaitTime >= config.controlLoopPeriod) {
+        spdlog::error("Invalid active_wait_ms {} (0 to control_period_ms): using {}ms.", config.activeWaitTime, config.controlLoopPeriod / 4.);
+        config.activeWaitTime = config.controlLoopPeriod / 4.;
+    }
+    if (config.controlLoopSyncOffset < 0. || config.controlLoopSyncOffset >= config.controlLoopPeriod) {
+        spdlog::error("Invalid sync_offset_ms {} (0 to control_period_ms): using 0ms.", config.controlLoopSyncOffset);
+        config.controlLoopSyncOffset = 0.;
+    }
+    if (config.CANBitrate <= 0.) {
+        spdlog::error("Invalid bitrate_kbps {}: using {}kbit/s.", config.CANBitrate, defaults.CANBitrate);
+        config.CANBitrate = defaults.CANBitrate;
+    }
+
+    if (config.isolatedCores) {
+        std::ifstream isolated("/sys/devices/system/cpu/isolated");
+        std::string list;
+        std::getline(isolated, list);
+        isolatedCpus = parseCpuList(list);
+        if (isolatedCpus.empty()) {
+            spdlog::warn("isolated_cores: no isolated core (isolcpus kernel parameter), threads not pinned.");
+        } else {
+            //RT threads on the isolated cores (one each if possible), the others on the remaining cores
+            if (config.rtThread.cpus.empty()) {
+                config.rtThread.cpus = {isolatedCpus[0]};
+            }
+            if (config.rtControlThread.cpus.empty()) {
+                config.rtControlThread.cpus = {isolatedCpus[isolatedCpus.size() > 1 ? 1 : 0]};
+            }
+            std::vector<int> others;
+            for (int cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++) {
+                bool isolatedCpu = false;
+                for (int i : isolatedCpus) {
+                    isolatedCpu |= (i == cpu);
+                }
+                if (!isolatedCpu) {
+                    others.push_back(cpu);
+                }
+            }
+            if (config.mainThread.cpus.empty()) {
+                config.mainThread.cpus = others;
+            }
+            if (config.nonRTThreads.cpus.empty()) {
+                config.nonRTThreads.cpus = others;
+            }
+        }
+    }
+    return true;
+}
+
+void rtConfigDisableRTPolicies() {
+    for (RTThreadConfig *thread : {&config.rtThread, &config.rtControlThread, &config.mainThread, &config.nonRTThreads}) {
+        thread->policy = SCHED_OTHER;
+        thread->priority = 0;
+    }
+}
+
+int applyThreadConfig(pthread_t thread, const RTThreadConfig &threadConfig, const char *threadName) {
+    int ret = 0;
+    struct sched_param param;
+    param.sched_priority = threadConfig.priority;
+    int err = pthread_setschedparam(thread, threadConfig.policy, &param);
+    if (err != 0) {
+        spdlog::error("{}: cannot set {} scheduling, priority {} ({}).", threadName, policyName(threadConfig.policy),
+                      threadConfig.priority, strerror(err));
+        ret = -1;
+    }
+    if (!threadConfig.cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int cpu : threadConfig.cpus) {
+            CPU_SET(cpu, &cpuset);
+        }
+        err = pthread_setaffinity_np(thread, sizeof(cpuset), &cpuset);
+        if (err != 0) {
+            spdlog::error("{}: cannot set CPU affinity to {} ({}).", threadName, cpuListString(threadConfig.cpus), strerror(err));
+            ret = -1;
+        }
+    }
+
+    //Effective layout, while the thread is known to run
+    int policy;
+    cpu_set_t cpuset;
+    std::vector<int> cpus;
+    if (pthread_getschedparam(thread, &policy, &param) != 0 || pthread_getaffinity_np(thread, sizeof(cpuset), &cpuset) != 0) {
+        return ret;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpuset)) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for (auto &t : threads) {
+        if (t.name == threadName) {
+            //Same thread applied again, or a new instance of a helper thread (e.g. sdo_parallel): latest layout
+            t.policy = policy;
+            t.priority = param.sched_priority;
+            t.cpus = cpus;
+            return ret;
+        }
+    }
+    threads.push_back({threadName, policy, param.sched_priority, cpus});
+    return ret;
+}
+
+void applyNonRTThreadConfig(const char *threadName) {
+    pthread_setname_np(pthread_self(), threadName);
+    applyThreadConfig(pthread_self(), config.nonRTThreads, threadName);
+}
+
+int lockMemory() {
+    if (!config.lockMemory) {
+        return 0;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        spdlog::error("mlockall failed ({}): memory not locked.", strerror(errno));
+        return -1;
+    }
+    memoryLocked = true;
+    return 0;
+}
+
+void logRTLayout() {
+    spdlog::info("Real-time layout: memory {}, RT threads stack prefault {} KB, isolated cores: {}.",
+                 memoryLocked ? "locked" : "not locked", config.prefaultStackSize / 1024,
+                 isolatedCpus.empty() ? "none" : cpuListString(isolatedCpus));
+    spdlog::info("Timing: control loop {}ms, CAN update {}ms (SYNC {}ms), active wait {}ms ({}), commands sent {}.", config.controlLoopPeriod,
+                 config.CANUpdateLoopPeriod, 2 * config.CANUpdateLoopPeriod, config.activeWaitTime,
+                 config.adaptiveActiveWait ? "adaptive, max" : "fixed", config.flushTPDOs ? "at the end of the control loop" : "at the next CAN update");
+    if (config.controlLoopSyncLock) {
+        spdlog::info("Timing: control loop locked to SYNC, offset {}ms.", config.controlLoopSyncOffset);
+    }
+    if (!config.txBatching) {
+        spdlog::info("Timing: CAN transmit batching disabled (one write() per frame).");
+    }
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for (auto &t : threads) {
+        spdlog::info("  {:<20} {:<6} priority {:>2}, CPUs {}", t.name, policyName(t.policy), t.priority, cpuListString(t.cpus));
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * \file RTConfig.h
+ * \brief Real-time layout of the CORC threads: scheduling policy, priority and CPU affinity of each thread,
+ * memory locking and stack prefaulting, and the periods of the control loop and CAN processing.
+ *
+ * Loaded at startup from config/rt_config.yaml (or the file given with -rtconfig <file>), e.g.:
+ * \code
+ * rt_config:
+ *   lock_memory: true
+ *   prefault_stack_kb: 1024
+ *   isolated_cores: false
+ *   threads:
+ *     rt_thread: {policy: FIFO, priority: 90, cpus: [1]}
+ *     rt_control_thread: {policy: FIFO, priority: 80, cpus: [1]}
+ *     main: {policy: OTHER, priority: 0, cpus: [0]}
+ *     non_rt: {policy: OTHER, priority: 0, cpus: [0]}
+ *   timing:
+ *     control_period_ms: 2.0
+ *     can_update_period_ms: 1.0
+ *     active_wait_ms: 0.5
+ *     adaptive_active_wait: true
+ *     sync_lock: false
+ *     sync_offset_ms: 0.0
+ *     tpdo_flush: true
+ *     tx_batching: true
+ * \endcode
+ * Omitted entries keep their default value (that is the layout used without a configuration file).
+ *
+ * \version 0.1
+ *
+ */
+#ifndef RTCONFIG_H_INCLUDED
+#define RTCONFIG_H_INCLUDED
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * \brief Scheduling of one thread (or group of threads)
+ *
+ */
+struct RTThreadConfig {
+    int policy;             /*!< SCHED_FIFO, SCHED_RR or SCHED_OTHER */
+    int priority;           /*!< Real-time priority (1-99), 0 for SCHED_OTHER */
+    std::vector<int> cpus;  /*!< CPUs the thread may run on, empty for no restriction */
+};
+
+/**
+ * \brief Real-time layout of the application
+ *
+ */
+struct RTConfig {
+    RTThreadConfig rtThread = {SCHED_FIFO, 90, {}};         /*!< CAN reception and CANopen timers (rt_thread) */
+    RTThreadConfig rtControlThread = {SCHED_FIFO, 80, {}};  /*!< Application control loop (rt_control_thread) */
+    RTThreadConfig mainThread = {SCHED_OTHER, 0, {}};       /*!< Mainline: CANopen processing (SDO, NMT...) */
+    RTThreadConfig nonRTThreads = {SCHED_OTHER, 0, {}};     /*!< Helper threads: asynchronous loggers, IMUs, SDO worker */
+    bool lockMemory = false;                                /*!< mlockall(MCL_CURRENT | MCL_FUTURE) */
+    size_t prefaultStackSize = 1024 * 1024;                 /*!< Stack of the RT threads touched at their start (bytes) */
+    bool isolatedCores = false;                             /*!< RT threads on the isolated cores (isolcpus), others on the remaining ones */
+    float controlLoopPeriod = 2.;                           /*!< Period of the rt_control_thread loop (and so the app update rate), in ms. Must be longer than the CANopen rt_thread interval (1ms) */
+    float CANUpdateLoopPeriod = 1.;                         /*!< CAN PDO processing period, in ms. SYNC messages (and so actual PDO update) are sent at twice this period */
+    float activeWaitTime = 0.5;                             /*!< Active wait (busy CPU) at the end of the control loop periods for a more accurate timing, in ms (maximum if adaptive). Typically between 10%-50% of controlLoopPeriod, 0 for no effect */
+    bool adaptiveActiveWait = true;                         /*!< Size the active wait online to the measured sleep wake-up overshoot (see AdaptiveSpin.h), activeWaitTime being the maximum */
+    bool controlLoopSyncLock = false;                       /*!< Control loop triggered by rt_thread once the drives responses to a SYNC are processed (every controlLoopPeriod/SYNC period SYNCs) rather than by its own timer. controlLoopPeriod is then rounded to a multiple of the SYNC period at startup */
+    bool flushTPDOs = true;                                 /*!< Send the changed command TPDOs at the end of each control loop period rather than at the next CAN update (see CANrx_taskTmr_flushTPDOs()) */
+    bool txBatching = true;                                 /*!< Send the SYNC and TPDOs of a CAN update (and of a flush) with one sendmmsg() rather than one write() each (see CO_CANtxBatchBegin()) */
+    float controlLoopSyncOffset = 0.;                       /*!< With controlLoopSyncLock: delay of the control loop start after the processing of the drives responses to the SYNC, in ms (0 to start immediately) */
+    float CANBitrate = 1000.;                               /*!< CAN bus bitrate in kbit/s (as set on the interface), used to estimate the bus load of the PDOs (see BusLoadPlanner.h) */
+    float busLoadBudget = 70.;                              /*!< Maximum expected bus load at startup, in % */
+    bool busLoadStrict = false;                             /*!< Refuse to start (rather than warn) when the expected bus load is over budget */
+    bool busStatistics = true;                              /*!< Record the frames sent and received for the bus statistics (see CO_busStats.h): costs a frame length computation per frame on the CAN threads */
+};
+
+/**
+ * \brief The layout in use (defaults until loadRTConfig())
+ *
+ */
+RTConfig &rtConfig();
+
+/**
+ * \brief Loads the layout from a YAML file (rt_config section). Missing file or entries keep the defaults, invalid periods
+ * are replaced by the defaults.
+ * With isolated_cores, threads without explicit cpus are assigned: RT threads to the isolated cores
+ * (/sys/devices/system/cpu/isolated), the others to the remaining cores.
+ *
+ * \param filename YAML file path
+ * \return true if the file was loaded
+ */
+bool loadRTConfig(const std::string &filename);
+
+/**
+ * \brief Without root privileges: real-time policies are replaced by SCHED_OTHER (CPU affinities are kept)
+ *
+ */
+void rtConfigDisableRTPolicies();
+
+/**
+ * \brief Applies a thread configuration (policy, priority and affinity) to a thread
+ *
+ * \return 0 on success, -1 if any setting failed (logged)
+ */
+int applyThreadConfig(pthread_t thread, const RTThreadConfig &config, const char *threadName);
+
+/**
+ * \brief Applies the non_rt configuration to the calling thread. To call at the start of helper threads, which
+ * otherwise inherit the scheduling and affinity of the (real-time) thread creating them.
+ *
+ */
+void applyNonRTThreadConfig(const char *threadName);
+
+/**
+ * \brief Locks the process memory (current and future) if configured
+ *
+ * \return 0 on success or if not configured, -1 on failure (logged)
+ */
+int lockMemory();
+
+/**
+ * \brief Logs the applied layout: policy, priority and CPUs of each thread (as in effect when configured, last instance
+ * for the threads started several times), memory locking, isolated cores
+ *
+ */
+void logRTLayout();
+
+#endif
@@ -0,0 +1,149 @@
+#include "StartupTrace.h"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "logging.h"
+
+namespace {
+struct Span {
+    std::string name;
+    double start;  // us, since the first span
+    double duration;
+    int depth;
+    long tid;
+};
+
+std::mutex traceMutex;
+std::vector<Span> spans;
+std::map<long, std::string> threadNames;
+struct timespec traceOrigin = {0, 0};
+bool reported = false;
+
+thread_local int spanDepth = 0;
+
+double elapsedUs(const struct timespec &from, const struct timespec &to) {
+    return (to.tv_sec - from.tv_sec) * 1e6 + (to.tv_nsec - from.tv_nsec) / 1e3;
+}
+
+std::string jsonEscape(const std::string &s) {
+    std::string escaped;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+}  // namespace
+
+StartupSpan::StartupSpan(std::string name) : name(name), depth(spanDepth++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (traceOrigin.tv_sec == 0 && traceOrigin.tv_nsec == 0) {
+        traceOrigin = start;
+    }
+}
+
+StartupSpan::~StartupSpan() {
+    end();
+}
+
+void StartupSpan::end() {
+    if (ended) {
+        return;
+    }
+    ended = true;
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    spanDepth--;
+
+    long tid = syscall(SYS_gettid);
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (reported) {
+        spdlog::debug("{} (after startup): {:.1f} ms", name, elapsedUs(start, stop) / 1000.);
+        return;
+    }
+    if (threadNames.count(tid) == 0) {
+        char threadName[16] = "";
+        pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+        threadNames[tid] = threadName;
+    }
+    spans.push_back({name, elapsedUs(traceOrigin, start), elapsedUs(start, stop), depth, tid});
+}
+
+void StartupTrace::report(const char *filename) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (reported) {
+        return;
+    }
+    reported = true;
+    if (spans.empty()) {
+        return;
+    }
+
+    // Spans are recorded when they end: sort by start time (parents first)
+    std::stable_sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) {
+        return a.start < b.start || (a.start == b.start && a.depth < b.depth);
+    });
+    double startupDuration = 0;
+    for (auto &s : spans) {
+        startupDuration = std::max(startupDuration, s.start + s.duration);
+    }
+
+    // Summary: spans of a same name aggregated, in order of first occurence
+    struct Total {
+        int count;
+        double total;
+        double max;
+        int depth;
+    };
+    std::vector<std::string> order;
+    std::map<std::string, Total> totals;
+    for (auto &s : spans) {
+        auto it = totals.find(s.name);
+        if (it == totals.end()) {
+            order.push_back(s.name);
+            totals[s.name] = {1, s.duration, s.duration, s.depth};
+        } else {
+            it->second.count++;
+            it->second.total += s.duration;
+            it->second.max = std::max(it->second.max, s.duration);
+        }
+    }
+    spdlog::info("Startup: {:.1f} ms", startupDuration / 1000.);
+    spdlog::info("{:<48} {:>6} {:>11} {:>11} {:>6}", "span", "count", "total (ms)", "max (ms)", "%");
+    for (auto &name : order) {
+        Total &t = totals[name];
+        spdlog::info("{:<48} {:>6} {:>11.1f} {:>11.1f} {:>6.1f}", std::string(2 * t.depth, ' ') + name, t.count,
+                     t.total / 1000., t.max / 1000., 100. * t.total / startupDuration);
+    }
+
+    // Chrome trace: one complete event ("X") per span, and thread names
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        spdlog::warn("Cannot write startup trace file {}", filename);
+        return;
+    }
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (auto &t : threadNames) {
+        fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %ld, \"args\": {\"name\": \"%s\"}},\n",
+                t.first, jsonEscape(t.second).c_str());
+    }
+    for (unsigned int i = 0; i < spans.size(); i++) {
+        fprintf(f, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %ld, \"ts\": %.1f, \"dur\": %.1f}%s\n",
+                jsonEscape(spans[i].name).c_str(), spans[i].tid, spans[i].start, spans[i].duration,
+                (i + 1 < spans.size()) ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    spdlog::info("Startup trace written to {}", filename);
+}
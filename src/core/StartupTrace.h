@@ -0,0 +1,66 @@
+/**
+ * \file StartupTrace.h
+ * \brief Timeline of the application startup: nested spans (CANopen initialisation, robot network
+ * initialisation, drives configuration...) recorded with monotonic timestamps from any thread.
+ *
+ * At the end of the initialisation (app_programStart() done and CAN started), StartupTrace::report() logs a summary
+ * table and writes the spans in the Chrome trace format (open with chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Usage:
+ * \code
+ * {
+ *     StartupSpan span("Robot::initialiseNetwork");
+ *     ... // Timed until the end of the scope
+ * }
+ * \endcode
+ *
+ * \version 0.1
+ *
+ */
+#ifndef STARTUPTRACE_H_INCLUDED
+#define STARTUPTRACE_H_INCLUDED
+
+#include <time.h>
+
+#include <string>
+
+/**
+ * \brief Records a span from its construction to its destruction (scope) or to end(). Nested spans of a same
+ * thread are shown within their parent. Spans ending once the startup is reported (e.g. a homing run later from a state)
+ * are not part of the timeline: their duration is only logged at debug level (e.g. on each control mode change).
+ *
+ */
+class StartupSpan {
+   public:
+    StartupSpan(std::string name);
+    ~StartupSpan();
+
+    /**
+     * \brief Ends the span before the end of the scope (no effect if already ended)
+     *
+     */
+    void end();
+
+   private:
+    std::string name;
+    struct timespec start;
+    int depth;
+    bool ended = false;
+};
+
+/**
+ * \brief Collection of the startup spans
+ *
+ */
+class StartupTrace {
+   public:
+    /**
+     * \brief Ends the recording, logs the summary table (one line per span name: count, total and max duration,
+     * share of the startup) and writes the Chrome trace JSON file. Only the first call has an effect.
+     *
+     * \param filename Chrome trace file, relative to the working directory (as the log file)
+     */
+    static void report(const char *filename = "logs/CORC_startup_trace.json");
+};
+
+#endif
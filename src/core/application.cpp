@@ -34,9 +34,16 @@ void app_programStart(void) {
 #ifdef NOROBOT
     spdlog::info("Running in NOROBOT (virtual) mode.");
 #endif  // NOROBOT
-    spdlog::info("Application thread running at {}Hz.", (int)(1000./(float)controlLoopPeriodInms));
-    stateMachine->init();
-    stateMachine->activate();
+    spdlog::info("Application thread running at {}Hz.", (int)(1000./rtConfig().controlLoopPeriod));
+    ControlLoopScheduler::instance().setPeriod(rtConfig().controlLoopPeriod);
+    {
+        StartupSpan span("StateMachine::init");
+        stateMachine->init();
+    }
+    {
+        StartupSpan span("StateMachine::activate");
+        stateMachine->activate();
+    }
 }
 
 /******************** Runs in low priority thread ********************/
@@ -44,6 +51,9 @@ void app_programAsync(uint16_t timer1msDiffy) {
 }
 
 /******************** Runs in rt_control_thread ********************/
+void app_programRT(bool syncWas) {
+}
+
 void app_programControlLoop(void) {
     std::chrono::steady_clock::time_point _t0 = std::chrono::steady_clock::now();
 
@@ -51,17 +61,24 @@ void app_programControlLoop(void) {
     if (stateMachine->running()) {
         stateMachine->update();
     }
+    //Sub-rate tasks registered by the states and robot
+    ControlLoopScheduler::instance().tick();
 
     //Warn if time overflow (this is the effective used time, normally lower than the allocated time period)
     double dt = (std::chrono::duration_cast<std::chrono::microseconds>(
             std::chrono::steady_clock::now() - _t0).count()) / 1e6;
-    if(dt>controlLoopPeriodInms/1000.)
-        spdlog::warn("Applicaton thread time overflow: {}ms (>{}ms) !", dt*1000., controlLoopPeriodInms);
+    if(dt>rtConfig().controlLoopPeriod/1000.)
+        spdlog::warn("Applicaton thread time overflow: {}ms (>{}ms) !", dt*1000., rtConfig().controlLoopPeriod);
 }
 
 /******************** Runs at the End of rt_control_thread********************/
 void app_programEnd(void) {
+    ControlLoopScheduler::instance().logTasks();
     stateMachine->end();
+    ControlLoopScheduler::instance().clear();
+    //Jobs of the robot and drives (control mode changes) must not outlive them: wait for the one running, fail the
+    //queued ones. CAN processing (rt_thread) still runs for their responses.
+    SDOWorker::instance().stop();
     stateMachine.reset(); //Explicit delete of the state machine to answer deletion on time
     spdlog::info("CORC End application");
 }
@@ -34,6 +34,7 @@
 #include <net/if.h>
 #include <pthread.h>
 #include <sched.h>
+#include <semaphore.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -48,15 +49,25 @@
 #include "CANopen.h"
 extern "C" {
 #include "CO_Linux_tasks.h"
+#include "CO_busStats.h"
+#include "CO_canCapture.h"
 #include "CO_time.h"
+#include "CO_master.h"
 }
 #include "CO_OD_storage.h"
 #include "CO_command.h"
+#include "SDOWorker.h"
 
 //Include custom state machine (defined in cmake)
 #include STATE_MACHINE_INCLUDE
 
 #include "logging.h"
+#include "AdaptiveSpin.h"
+#include "BusLoadPlanner.h"
+#include "ControlLoopScheduler.h"
+#include "LatencyHistogram.h"
+#include "RTConfig.h"
+#include "StartupTrace.h"
 
 #ifndef CO_APPLICATION_H
 #define CO_APPLICATION_H
@@ -68,9 +79,9 @@ extern "C" {
 #define INCREMENT_1MS(var) (var++)     /* Increment 1ms variable in taskTmr */
 #define NODEID (80)
 
-const float controlLoopPeriodInms = 2.;     //!< Define the control loop period (in ms): the period of rt_control_thread loop (and so the app update rate). In [ms].
-const float CANUpdateLoopPeriodInms = 1.0;  //!< Define the CAN PDO processing period. SYNCH messages (and so actual PDO update) is set to twice this period (twice slower). In [ms].
-const float activeWaitTimeInms = 0.5;       //!< Define the active wait time (busy CPU) in the control thread to get more accurate timing. Typically between 10%-50% of controlLoopPeriod, 0 for no effect. In [ms].
+//Control loop and CAN update periods, active wait: see RTConfig.h (timing section of config/rt_config.yaml)
+const uint32_t latencyDumpPeriodInms = 5000; //!< Period of the export of the threads timing histograms to logs/CORC_latency.txt (see LatencyHistogram.h), 0 to disable. In [ms].
+const uint32_t busStatsDumpPeriodInms = 5000; //!< Period of the export of the CAN bus statistics to logs/CORC_bus.txt (see CO_busStats.h), 0 to disable. In [ms].
 
 
 
@@ -96,6 +107,16 @@ void app_programEnd(void);
  */
 void app_programAsync(uint16_t timer1msDiff);
 
+/**
+ * \brief Function is called cyclically from the CAN realtime thread (rt_thread), after RPDOs are processed and
+ * before TPDOs are sent, with OD locked.
+ *
+ * Code inside this function must be nonblocking and very fast.
+ *
+ * \param syncWas True if a SYNC message was processed in this cycle
+ */
+void app_programRT(bool syncWas);
+
 /**
  * \brief Function is called cyclically from Control loop thread at constant intervals.
  *
@@ -32,23 +32,23 @@
 #include "application.h"
 /* Threads and thread safety variables***********************************************************/
 /**
- * Mutex is locked, when CAN is not valid (configuration state).
- * May be used from other threads. RT threads may use CO->CANmodule[0]->CANnormal instead.
+ * Write locked when CAN is not valid (configuration state, reset and end of program).
+ * SDO transfers from other threads hold it read locked (see CO_master.c), so CANopen objects are never
+ * deleted under them. Writer preferring: a reset is not held off by a continuous flow of transfers.
+ * RT threads may use CO->CANmodule[0]->CANnormal instead.
 */
-pthread_mutex_t CO_CAN_VALID_mtx = PTHREAD_MUTEX_INITIALIZER;
+pthread_rwlock_t CO_CAN_VALID_rwlock = PTHREAD_RWLOCK_WRITER_NONRECURSIVE_INITIALIZER_NP;
 
 static int mainline_epoll_fd; /*!< epoll file descriptor for mainline */
 static CO_time_t CO_time;     /*!< Object for current time */
 bool readyToStart = false;    /*!< Flag used by control thread to indicate CAN stack functional */
 uint32_t tmr1msPrev = 0;
 
-/*CAN msg processing thread variables*/
-static int rtPriority = 90; /*!< priority of rt CANmsg thread */
+/*CAN msg processing thread variables (priorities, policies and CPUs: see RTConfig.h)*/
 static void *rt_thread(void *arg);
 static pthread_t rt_thread_id;
 static int rt_thread_epoll_fd; /*!< epoll file descriptor for rt thread */
 /* Application Control loop thread */
-static int rtControlPriority = 80; /*!< priority of application thread */
 static void *rt_control_thread(void *arg);
 static pthread_t rt_control_thread_id;
 CO_NMT_reset_cmd_t reset_local = CO_RESET_NOT;
@@ -57,10 +57,34 @@ CO_NMT_reset_cmd_t reset_local = CO_RESET_NOT;
 struct period_info {
     struct timespec next_period;
     long period_ns;
-    struct timespec next_period_wo_active_wait;
-    long period_wo_active_wait_ns;
-    long active_wait_ns;
 };
+/** @brief Active wait at the end of the control loop periods (at most rtConfig().activeWaitTime), created once the configuration loaded */
+static std::unique_ptr<AdaptiveSpin> controlLoopSpin;
+static long controlLoopPeriod_ns; /*!< Nominal control loop period: rtConfig().controlLoopPeriod, or a multiple of the SYNC period if locked to SYNC */
+
+/** @brief Control loop locked to SYNC (rtConfig().controlLoopSyncLock): rt_thread posts the semaphore once the drives
+ * responses to every controlLoopSyncDivider SYNC are received and processed (and the drives values published), with the
+ * time of the post */
+static sem_t controlLoopSyncSem;
+static std::atomic<int64_t> controlLoopSyncTime_ns(0);
+static unsigned int controlLoopSyncDivider = 1;
+static uint64_t controlLoopSyncMissed = 0;          /*!< SYNCs skipped by a late control loop */
+static uint64_t controlLoopSyncTimeouts = 0;        /*!< Periods without SYNC (control loop run on timeout) */
+static uint64_t controlLoopSyncLateResponses = 0;   /*!< SYNCs not fully answered by the drives before the next one (control loop run anyway) */
+static void rt_thread_RT(bool_t syncWas);
+
+/** @brief Timing histograms of the RT threads: wake-up latency, period jitter (|actual - nominal period|) and compute time */
+static LatencyHistogram rtThreadWakeup("rt_thread wakeup");
+static LatencyHistogram rtThreadJitter("rt_thread period jitter");
+static LatencyHistogram rtThreadCompute("rt_thread compute");
+static LatencyHistogram controlLoopWakeup("rt_control_thread wakeup");
+static LatencyHistogram controlLoopJitter("rt_control_thread jitter");
+static LatencyHistogram controlLoopCompute("rt_control_thread compute");
+static LatencyHistogram commandToCAN("command to CAN");  /*!< End of the control loop update to the send of the command TPDOs */
+static std::atomic<int64_t> commandTime_ns(0);          /*!< End of the last control loop update, until its commands are sent */
+static std::atomic<int64_t> commandDelay_ns(-1);        /*!< Last command to CAN delay not recorded yet (-1: none): recorded by rt_thread only */
+static void rt_thread_stats(long wakeupLatency_ns, long processing_ns);
+static void command_sent();
 
 /** @brief Struct to hold arguments for ROS thread*/
 struct ros_arg_holder {
@@ -68,10 +92,24 @@ struct ros_arg_holder {
     char **argv;
 };
 
+/** @brief Painted region of a thread stack, used to measure its high-water mark */
+struct stack_info {
+    uint8_t *bottom;   /*!< Lowest painted address */
+    size_t size;       /*!< Painted size (bytes) */
+    size_t stackSize;  /*!< Size of the thread stack (bytes) */
+};
+#define STACK_PAINT_PATTERN 0xA5
+
+/* Forward declartion of thread stack usage functions*/
+static void stack_paint(struct stack_info *sinfo);
+static void stack_report(const char *threadName, struct stack_info *sinfo);
 /* Forward declartion of control loop thread timer functions*/
 static void inc_period(struct period_info *pinfo);
 static void periodic_task_init(struct period_info *pinfo);
-static void wait_rest_of_period(struct period_info *pinfo);
+static long wait_until(struct timespec *target, bool record = true);
+static long wait_rest_of_period(struct period_info *pinfo, bool record = true);
+static long wait_sync(struct period_info *pinfo);
+double diff_ts(struct timespec *time1, struct timespec *time0);
 /* Forward declartion of CAN helper functions*/
 void configureCANopen(int nodeId, int rtPriority, int CANdevice0Index, char *CANdevice);
 void CO_errExit(char const *msg);        /*!< CAN object error code and exit program*/
@@ -121,16 +159,72 @@ int main(int argc, char *argv[]) {
     //Initialise console and file logging. Name file can be specified if required (see logging.h)
     init_logging();
     restore_privileges();
+    StartupSpan startupSpan("main: CANopen initialisation");
+
+    //Threads layout (priorities, CPU affinities), memory locking: config/rt_config.yaml or -rtconfig <file>
+    std::string rtConfigFile = std::string(XSTR(BASE_DIRECTORY)) + "/config/rt_config.yaml";
+    for (int i = 1; i < argc - 1; i++) {
+        if (std::string(argv[i]) == "-rtconfig") {
+            rtConfigFile = argv[i + 1];
+            break;
+        }
+    }
+    loadRTConfig(rtConfigFile);
+    CO_CANbusStatsSetBitrate(rtConfig().CANBitrate);
+    CO_CANbusStatsEnable(rtConfig().busStatistics);
+    CO_CANtxBatchEnable(rtConfig().txBatching);
+#ifdef CO_LOG_CAN_MESSAGES
+    //Capture writer thread started before the RT threads: keeps a normal priority
+    if (CO_CANcaptureStart("logs/CORC_can_capture.bin") == 0) {
+        spdlog::info("Capturing CAN frames to logs/CORC_can_capture.bin");
+    }
+    else {
+        spdlog::warn("Failed to start CAN capture to logs/CORC_can_capture.bin");
+    }
+#endif
 
     //Check if running with root privilege
     if (getuid() != 0) {
         //Fallback to standard non RT thread
-        rtPriority = -1;
-        rtControlPriority = -1;
+        rtConfigDisableRTPolicies();
         spdlog::warn("Running without root privilege: using non-RT priority threads");
     } else {
         spdlog::info("Running with root privilege: using RT priority threads");
     }
+    controlLoopPeriod_ns = rtConfig().controlLoopPeriod * NSEC_PER_MSEC;
+    if (rtConfig().controlLoopSyncLock) {
+        //Control loop run every controlLoopSyncDivider SYNC (SYNC period: twice the CAN update period)
+        long syncPeriod_ns = 2 * rtConfig().CANUpdateLoopPeriod * NSEC_PER_MSEC;
+        long divider = lround((double)controlLoopPeriod_ns / syncPeriod_ns);
+        controlLoopSyncDivider = divider > 1 ? divider : 1;
+        if (controlLoopSyncDivider * syncPeriod_ns != controlLoopPeriod_ns) {
+            spdlog::warn("Control loop locked to SYNC: period {}ms instead of {}ms (multiple of the SYNC period).",
+                         controlLoopSyncDivider * syncPeriod_ns / (double)NSEC_PER_MSEC, rtConfig().controlLoopPeriod);
+        }
+        controlLoopPeriod_ns = controlLoopSyncDivider * syncPeriod_ns;
+        //Effective period for everything derived from it (sub-rate dividers, overrun check, bus load, statistics)
+        rtConfig().controlLoopPeriod = controlLoopPeriod_ns / (double)NSEC_PER_MSEC;
+        if (rtConfig().activeWaitTime >= rtConfig().controlLoopPeriod) {
+            spdlog::warn("Control loop locked to SYNC: active wait {}ms reduced to {}ms.", rtConfig().activeWaitTime, rtConfig().controlLoopPeriod / 4.);
+            rtConfig().activeWaitTime = rtConfig().controlLoopPeriod / 4.;
+        }
+        if (rtConfig().controlLoopSyncOffset >= rtConfig().controlLoopPeriod) {
+            spdlog::warn("Control loop locked to SYNC: offset {}ms over the period, using 0ms.", rtConfig().controlLoopSyncOffset);
+            rtConfig().controlLoopSyncOffset = 0.;
+        }
+        sem_init(&controlLoopSyncSem, 0, 0);
+    }
+    controlLoopSpin = std::make_unique<AdaptiveSpin>(rtConfig().activeWaitTime * NSEC_PER_MSEC, rtConfig().adaptiveActiveWait);
+    lockMemory();
+    //OD mutex with priority inheritance: locked by rt_thread, the control loop (TPDOs flush) and the mainline (SDO)
+    pthread_mutexattr_t ODMutexAttr;
+    pthread_mutexattr_init(&ODMutexAttr);
+    pthread_mutexattr_setprotocol(&ODMutexAttr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&CO_OD_mtx, &ODMutexAttr);
+    pthread_mutexattr_destroy(&ODMutexAttr);
+    applyThreadConfig(pthread_self(), rtConfig().mainThread, "main");
+    //Thread of the asynchronous loggers (LogHelper), created now rather than by the control thread
+    spdlog::init_thread_pool(spdlog::details::default_async_q_size, 1, [] { applyNonRTThreadConfig("spdlog_async"); });
 
     /* TODO : MOVE bellow definitionsTO SOME KIND OF CANobject, struct or the like*/
     CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
@@ -151,6 +245,7 @@ int main(int argc, char *argv[]) {
     }
     char CANdevice[10] = "";
     int CANdevice0Index;
+    StartupSpan CANdeviceSpan("CAN device selection");
     //Rotate through list of interfaces and select first one existing and up
     for (int i = 0; i < can_dev_number; i++) {
         //Check if interface exists
@@ -177,7 +272,8 @@ int main(int argc, char *argv[]) {
             spdlog::info("{}: -", CANdeviceList[i]);
         }
     }
-    configureCANopen(nodeId, rtPriority, CANdevice0Index, CANdevice);
+    CANdeviceSpan.end();
+    configureCANopen(nodeId, (rtConfig().rtThread.policy == SCHED_OTHER) ? -1 : rtConfig().rtThread.priority, CANdevice0Index, CANdevice);
 
     struct ros_arg_holder *ros_args = (ros_arg_holder *)malloc(sizeof(*ros_args));
     ros_args->argc = argc;
@@ -192,13 +288,13 @@ int main(int argc, char *argv[]) {
     spdlog::info("Starting CANopen device with Node ID {}", nodeId);
 
     //Set synch signal period (in us)
-    CO_OD_RAM.communicationCyclePeriod = CANUpdateLoopPeriodInms * 2000; //Set CAN processing twice faster than SYNCH to avoid processing hanging
+    CO_OD_RAM.communicationCyclePeriod = rtConfig().CANUpdateLoopPeriod * 2000; //Set CAN processing twice faster than SYNCH to avoid processing hanging
 
     while (reset != CO_RESET_APP && reset != CO_RESET_QUIT && endProgram == 0) {
         /* CANopen communication reset || first run of app- initialize CANopen objects *******************/
         //CO_ReturnError_t err;
-        /*mutex locking for thread safe OD access*/
-        pthread_mutex_lock(&CO_CAN_VALID_mtx);
+        /*locking for thread safe OD access: waits for the SDO transfers in progress*/
+        pthread_rwlock_wrlock(&CO_CAN_VALID_rwlock);
         /* Wait rt_thread. */
         if (!firstRun) {
             CO_LOCK_OD();
@@ -208,19 +304,31 @@ int main(int argc, char *argv[]) {
 
         CO_configure();
         /* Execute optional additional application code */
-        app_communicationReset(argc, argv);
+        {
+            StartupSpan span("app_communicationReset");
+            app_communicationReset(argc, argv);
+        }
+        /* Expected bus load of the PDOs just registered, before enabling the network */
+        if (!BusLoadPlanner::check(rtConfig().CANBitrate, CO_OD_RAM.communicationCyclePeriod, rtConfig().controlLoopPeriod, rtConfig().busLoadBudget) &&
+            rtConfig().busLoadStrict) {
+            CO_errExit("Communication reset - expected CAN bus load over budget (rt_config bus: refuse_over_budget)");
+        }
 
 
         /* initialize CANopen with CAN interface and nodeID */
-        if (CO_init(CANdevice0Index, nodeId, 0) != CO_ERROR_NO) {
-            char s[120];
-            snprintf(s, 120, "Communication reset - CANopen initialization failed");
-            CO_errExit(s);
+        {
+            StartupSpan span("CO_init");
+            if (CO_init(CANdevice0Index, nodeId, 0) != CO_ERROR_NO) {
+                char s[120];
+                snprintf(s, 120, "Communication reset - CANopen initialization failed");
+                CO_errExit(s);
+            }
         }
         /* Configure callback functions for task control */
         CO_EM_initCallback(CO->em, taskMain_cbSignal);
         CO_SDO_initCallback(CO->SDO[0], taskMain_cbSignal);
-        CO_SDOclient_initCallback(CO->SDOclient, taskMain_cbSignal);
+        for (int i = 0; i < CO_NO_SDO_CLIENT; i++)
+            CO_SDOclient_initCallback(CO->SDOclient[i], sdoClient_cbSignal);
 
         /* Initialize time */
         CO_time_init(&CO_time, CO->SDO[0], &OD_time.epochTimeBaseMs, &OD_time.epochTimeOffsetMs, 0x2130);
@@ -239,31 +347,28 @@ int main(int argc, char *argv[]) {
             rt_thread_epoll_fd = epoll_create(2);
             if (rt_thread_epoll_fd == -1)
                 CO_errExit("Program init - epoll_create rt_thread failed");
+            /* Preallocate the SDO transfer buffers of the command interface outside of the rt threads */
+            if (CO_command_allocateBuffers() != 0)
+                CO_errExit("Program init - SDO buffers allocation failed");
             /* Init taskRT */
             CANrx_taskTmr_init(rt_thread_epoll_fd, TMR_TASK_INTERVAL_NS, &OD_performance[ODA_performance_timerCycleMaxTime]);
+            CANrx_taskTmr_setCallback(rt_thread_RT);
+            CANrx_taskTmr_setStatsCallback(rt_thread_stats);
             OD_performance[ODA_performance_timerCycleTime] = TMR_TASK_INTERVAL_NS / 1000; /* informative */
 
             /* Create rt_thread */
             if (pthread_create(&rt_thread_id, NULL, rt_thread, NULL) != 0)
                 CO_errExit("Program init - rt_thread creation failed");
-            /* Set priority for rt_thread */
-            if (rtPriority > 0) {
-                struct sched_param param;
-                param.sched_priority = rtPriority;
-                if (pthread_setschedparam(rt_thread_id, SCHED_FIFO, &param) != 0) {
-                    CO_errExit("Program init - rt_thread set scheduler failed (are you root?)");
-                }
+            /* Set priority and CPU affinity for rt_thread */
+            if (applyThreadConfig(rt_thread_id, rtConfig().rtThread, "rt_thread") != 0) {
+                CO_errExit("Program init - rt_thread set scheduler failed (are you root?)");
             }
             /* Create control_thread */
             if (pthread_create(&rt_control_thread_id, NULL, rt_control_thread, ros_args) != 0)
                 CO_errExit("Program init - rt_thread_control creation failed");
-            /* Set priority for control thread */
-            if (rtPriority > 0) {
-                struct sched_param paramc;
-                paramc.sched_priority = rtControlPriority;
-                if (pthread_setschedparam(rt_control_thread_id, SCHED_FIFO, &paramc) != 0) {
-                    CO_errExit("Program init - rt_thread set scheduler failed (are you root?)");
-                }
+            /* Set priority and CPU affinity for control thread */
+            if (applyThreadConfig(rt_control_thread_id, rtConfig().rtControlThread, "rt_control_thread") != 0) {
+                CO_errExit("Program init - rt_thread set scheduler failed (are you root?)");
             }
 
             //Privileges not required anymore
@@ -271,10 +376,13 @@ int main(int argc, char *argv[]) {
 
             /* start CAN */
             CO_CANsetNormalMode(CO->CANmodule[0]);
-            pthread_mutex_unlock(&CO_CAN_VALID_mtx);
+            pthread_rwlock_unlock(&CO_CAN_VALID_rwlock);
             reset = CO_RESET_NOT;
+            startupSpan.end();
 
             readyToStart = true;
+            uint32_t latencyDumpTime = CO_timer1ms;
+            uint32_t busStatsDumpTime = CO_timer1ms;
             while (reset == CO_RESET_NOT && endProgram == 0) {
                 /* loop for normal program execution main epoll reading ******************************************/
                 int ready;
@@ -290,6 +398,16 @@ int main(int argc, char *argv[]) {
                     tmr1msPrev = CO_timer1ms;
                     /* Execute optional additional alication code */
                     app_programAsync(timer1msDiff);
+                    /* Live export of the timing histograms */
+                    if (latencyDumpPeriodInms > 0 && CO_timer1ms - latencyDumpTime >= latencyDumpPeriodInms) {
+                        latencyDumpTime = CO_timer1ms;
+                        LatencyHistogram::dump();
+                    }
+                    /* Live export of the bus statistics */
+                    if (busStatsDumpPeriodInms > 0 && CO_timer1ms - busStatsDumpTime >= busStatsDumpPeriodInms) {
+                        busStatsDumpTime = CO_timer1ms;
+                        CO_CANbusStatsDump("logs/CORC_bus.txt");
+                    }
                 }
 
                 else {
@@ -306,12 +424,52 @@ int main(int argc, char *argv[]) {
             CO_errExit("Program end - pthread_join failed");
         }
         usleep(500000); /*wait for last CAN commands to be processed if any */
+        //SDO worker already stopped in app_programEnd(), while rt_thread still processes the responses (and timeouts)
+        pthread_rwlock_wrlock(&CO_CAN_VALID_rwlock);
         //End CAN communication processing
         CO_endProgram = 1;
         if (pthread_join(rt_thread_id, NULL) != 0) {
             CO_errExit("Program end - pthread_join failed");
         }
-        /* delete objects from memory */
+        /* Timing statistics of the RT threads */
+        LatencyHistogram::logSummary();
+        if (latencyDumpPeriodInms > 0) {
+            LatencyHistogram::dump();
+        }
+        /* Bus utilisation */
+        CO_CANbusLoad_t busLoad;
+        CO_CANbusLoadGet(&busLoad);
+        if (busLoad.frames > 0) {
+            spdlog::info("CAN bus: {} frames, average load {:.1f}%, peak {:.1f}% ({}kbit/s).", busLoad.frames, busLoad.averageLoad,
+                         busLoad.peakLoad, busLoad.bitrate_kbps);
+            if (busStatsDumpPeriodInms > 0) {
+                CO_CANbusStatsDump("logs/CORC_bus.txt");
+            }
+        }
+#ifdef CO_LOG_CAN_MESSAGES
+        /* CAN capture (kept over communication resets) */
+        CO_CANcaptureStop();
+        uint64_t captured, captureDropped;
+        CO_CANcaptureGetCounts(&captured, &captureDropped);
+        spdlog::info("CAN capture: {} frames written to logs/CORC_can_capture.bin, {} dropped.", captured, captureDropped);
+#endif
+        /* CAN RX batching statistics (vs one epoll wakeup + one read() per frame) */
+        CO_CANrxStats_t rxStats;
+        CO_CANrxGetStats(CO->CANmodule[0], &rxStats);
+        if (rxStats.wakeups > 0) {
+            spdlog::info("CAN RX: {} frames in {} wakeups ({:.2f} frames/wakeup, max {}), {} recvmmsg calls, {} syscalls saved.",
+                         rxStats.frames, rxStats.wakeups, (double)rxStats.frames / rxStats.wakeups, rxStats.maxBatch,
+                         rxStats.syscalls, (int64_t)(2 * rxStats.frames) - (int64_t)(rxStats.wakeups + rxStats.syscalls));
+        }
+        /* CAN TX batching statistics (vs one write() per frame). Tick time: rt_thread compute, against a run with tx_batching false */
+        CO_CANtxStats_t txStats;
+        CO_CANtxGetStats(CO->CANmodule[0], &txStats);
+        if (txStats.frames > 0) {
+            spdlog::info("CAN TX: {} frames, {} batches (max {} frames), {} syscalls, {} syscalls saved.",
+                         txStats.frames, txStats.batches, txStats.maxBatch, txStats.syscalls,
+                         (int64_t)txStats.frames - (int64_t)txStats.syscalls);
+        }
+        /* delete objects from memory (SDO transfers of other threads ended, CAN valid lock held) */
         CANrx_taskTmr_close();
         taskMain_close();
         CO_delete(CANdevice0Index);
@@ -330,6 +488,8 @@ int main(int argc, char *argv[]) {
 
 /* Function for CAN send, receive and taskTmr ********************************/
 static void *rt_thread(void *arg) {
+    struct stack_info sinfo;
+    stack_paint(&sinfo);
     while (CO_endProgram == 0) {
         struct epoll_event ev;
         int ready = epoll_wait(rt_thread_epoll_fd, &ev, 1, -1);
@@ -361,26 +521,168 @@ static void *rt_thread(void *arg) {
             CO_error(0x12200000L);
         }
     }
+    stack_report("rt_thread", &sinfo);
     return NULL;
 }
 /* Control thread function ********************************/
 static void *rt_control_thread(void *arg) {
+    struct stack_info sinfo;
+    stack_paint(&sinfo);
     struct period_info pinfo;
     periodic_task_init(&pinfo);
     app_programStart();
-    wait_rest_of_period(&pinfo);
+    wait_rest_of_period(&pinfo, false);
 
     while (!readyToStart) {
-        wait_rest_of_period(&pinfo);
+        wait_rest_of_period(&pinfo, false);
     }
+    //End of the initialisation: summary of the startup timeline and threads layout
+    StartupTrace::report();
+    logRTLayout();
+    bool syncLocked = rtConfig().controlLoopSyncLock;
+    timespec prevStart = {0, 0}, computeEnd;
     while (endProgram == 0) {
         periodic_task_init(&pinfo);
+        if (prevStart.tv_sec != 0) {
+            controlLoopJitter.record(labs(diff_ts(&pinfo.next_period, &prevStart) * NSEC_PER_SEC - pinfo.period_ns));
+        }
+        prevStart = pinfo.next_period;
         app_programControlLoop();
-        wait_rest_of_period(&pinfo);
+        clock_gettime(CLOCK_MONOTONIC, &computeEnd);
+        controlLoopCompute.record(diff_ts(&computeEnd, &prevStart) * NSEC_PER_SEC);
+        //Send the new commands now rather than at the next rt_thread interval
+        commandTime_ns.store((int64_t)computeEnd.tv_sec * NSEC_PER_SEC + computeEnd.tv_nsec, std::memory_order_relaxed);
+        if (rtConfig().flushTPDOs) {
+            if (CANrx_taskTmr_flushTPDOs() > 0) {
+                command_sent();
+            } else {
+                commandTime_ns.store(0, std::memory_order_relaxed);  // No changed command
+            }
+        }
+        controlLoopWakeup.record(syncLocked ? wait_sync(&pinfo) : wait_rest_of_period(&pinfo));
     }
     app_programEnd();
+    if (syncLocked) {
+        spdlog::info("Control loop locked to SYNC (every {} SYNC, offset {}ms): {} SYNC missed (late control loop), {} periods without SYNC, {} SYNC not fully answered by the drives.",
+                     controlLoopSyncDivider, rtConfig().controlLoopSyncOffset, controlLoopSyncMissed, controlLoopSyncTimeouts, controlLoopSyncLateResponses);
+    }
+    spdlog::info("Control loop active wait: {:.0f} us per period on average ({} {} us), {:.1f}% of a core. Period end jitter: p50 {} us, p99 {} us, p99.9 {} us, max {:.0f} us.",
+                 controlLoopSpin->averageSpin_us(), rtConfig().adaptiveActiveWait ? "adaptive, max" : "fixed", rtConfig().activeWaitTime * 1000,
+                 100. * controlLoopSpin->averageSpin_us() / (rtConfig().controlLoopPeriod * 1000), controlLoopSpin->latenessPercentile_us(0.5),
+                 controlLoopSpin->latenessPercentile_us(0.99), controlLoopSpin->latenessPercentile_us(0.999), controlLoopSpin->maxLateness_us());
+    stack_report("rt_control_thread", &sinfo);
     return NULL;
 }
+/* Triggers the control loop (sync lock), once the drives values are published */
+static void triggerControlLoop() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    controlLoopSyncTime_ns.store((int64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec, std::memory_order_release);
+    sem_post(&controlLoopSyncSem);
+}
+/* rt_thread application code, called each interval after the RPDOs processing (OD locked) ********************************/
+/* With sync lock: whether the control loop is to be triggered in this cycle */
+static bool controlLoopSyncDue(bool_t syncWas) {
+    //No SYNC produced: every cycle
+    if (CO_OD_RAM.communicationCyclePeriod == 0) {
+        return true;
+    }
+    //The SYNC of this cycle is sent at its end (TPDOs batch) and the drives answer it during the next cycles: the control
+    //loop is triggered once all their responses (RPDOs of the drives TPDOs sent on every SYNC) are processed, at the latest
+    //with the next SYNC.
+    static unsigned int syncCount = 0;
+    static bool awaitingResponses = false;
+    bool due = false;
+    if (syncWas) {
+        if (awaitingResponses) {
+            controlLoopSyncLateResponses++;
+            awaitingResponses = false;
+            due = true;
+        }
+        if (++syncCount >= controlLoopSyncDivider) {
+            syncCount = 0;
+            if (Drive::markSyncResponses() > 0) {
+                awaitingResponses = true;
+            } else {
+                due = true;
+            }
+        }
+    } else if (awaitingResponses && Drive::syncResponsesReceived()) {
+        awaitingResponses = false;
+        due = true;
+    }
+    return due;
+}
+static void rt_thread_RT(bool_t syncWas) {
+    app_programRT(syncWas);
+    //Drives values published for the control loop: with sync lock right before triggering it, otherwise once per SYNC
+    //period (every cycle if no SYNC is produced)
+    bool publish = rtConfig().controlLoopSyncLock ? controlLoopSyncDue(syncWas)
+                                                  : (syncWas || CO_OD_RAM.communicationCyclePeriod == 0);
+    if (publish) {
+        Drive::publishSnapshots();
+        if (rtConfig().controlLoopSyncLock) {
+            triggerControlLoop();
+        }
+    }
+}
+/* Timing statistics of rt_thread (taskTmr), called each interval ********************************/
+static void rt_thread_stats(long wakeupLatency_ns, long processing_ns) {
+    static long prevLatency_ns = -1;
+    rtThreadWakeup.record(wakeupLatency_ns);
+    //Nominal interval between the timer expirations: the jitter is the change of latency
+    if (prevLatency_ns >= 0) {
+        rtThreadJitter.record(labs(wakeupLatency_ns - prevLatency_ns));
+    }
+    prevLatency_ns = wakeupLatency_ns;
+    rtThreadCompute.record(processing_ns);
+    //Commands of the control loop not flushed: sent by this interval
+    command_sent();
+    //Single writer of the histogram: also records the delay of the commands flushed by rt_control_thread
+    int64_t delay_ns = commandDelay_ns.exchange(-1, std::memory_order_relaxed);
+    if (delay_ns >= 0) {
+        commandToCAN.record(delay_ns);
+    }
+}
+/* Publishes the delay from the end of the last control loop update to the send of its commands (once), for rt_thread to record */
+static void command_sent() {
+    int64_t t_ns = commandTime_ns.exchange(0, std::memory_order_relaxed);
+    if (t_ns != 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        commandDelay_ns.store((int64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec - t_ns, std::memory_order_relaxed);
+    }
+}
+/* Thread stack usage functions ********************************/
+/* Fills the unused part of the calling thread stack (up to rtConfig().prefaultStackSize) with a known pattern.
+ * Also touches these pages once for all, before the thread runs its loop. */
+static void __attribute__((noinline)) stack_paint(struct stack_info *sinfo) {
+    pthread_attr_t attr;
+    sinfo->stackSize = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &sinfo->stackSize);
+        pthread_attr_destroy(&attr);
+    }
+    //Leave at least half of the stack untouched (small or unknown stack size)
+    size_t paintSize = rtConfig().prefaultStackSize;
+    sinfo->size = (sinfo->stackSize > 0 && sinfo->stackSize / 2 < paintSize) ? sinfo->stackSize / 2 : paintSize;
+    sinfo->bottom = (uint8_t *)alloca(sinfo->size);
+    memset(sinfo->bottom, STACK_PAINT_PATTERN, sinfo->size);
+    //Painted memory is read later on (stack_report): do not let the compiler drop the memset
+    asm volatile("" : : "r"(sinfo->bottom) : "memory");
+}
+/* Logs the stack high-water mark of the calling thread: painted bytes which have been overwritten since stack_paint. */
+static void stack_report(const char *threadName, struct stack_info *sinfo) {
+    size_t untouched = 0;
+    while (untouched < sinfo->size && sinfo->bottom[untouched] == STACK_PAINT_PATTERN) {
+        untouched++;
+    }
+    if (untouched == 0) {
+        spdlog::warn("{} stack: more than {} KB used (stack size {} KB).", threadName, sinfo->size / 1024, sinfo->stackSize / 1024);
+    } else {
+        spdlog::info("{} stack: {} KB used (high-water mark), stack size {} KB.", threadName, (sinfo->size - untouched + 1023) / 1024, sinfo->stackSize / 1024);
+    }
+}
 /* Control thread time functions ********************************/
 static void inc_period(struct period_info *pinfo) {
     //Overall end period time
@@ -390,38 +692,78 @@ static void inc_period(struct period_info *pinfo) {
         pinfo->next_period.tv_sec++;
         pinfo->next_period.tv_nsec -= NSEC_PER_SEC;
     }
-
-    //End period time wo active wait time
-    pinfo->next_period_wo_active_wait.tv_nsec += pinfo->period_wo_active_wait_ns;
-    while (pinfo->next_period_wo_active_wait.tv_nsec >= NSEC_PER_SEC) {
-        /* timespec nsec overflow */
-        pinfo->next_period_wo_active_wait.tv_sec++;
-        pinfo->next_period_wo_active_wait.tv_nsec -= NSEC_PER_SEC;
-    }
 }
 static void periodic_task_init(struct period_info *pinfo) {
-    pinfo->period_ns = controlLoopPeriodInms * NSEC_PER_MSEC;
-    pinfo->period_wo_active_wait_ns = (controlLoopPeriodInms-activeWaitTimeInms) * NSEC_PER_MSEC;
-    pinfo->active_wait_ns = activeWaitTimeInms * NSEC_PER_MSEC;
+    pinfo->period_ns = controlLoopPeriod_ns;
 
-    clock_gettime(CLOCK_MONOTONIC, &(pinfo->next_period_wo_active_wait));
     clock_gettime(CLOCK_MONOTONIC, &(pinfo->next_period));
 }
 //time1-time0 in s
 double diff_ts(struct timespec *time1, struct timespec *time0) {
   return (time1->tv_sec - time0->tv_sec) + (time1->tv_nsec - time0->tv_nsec) / (double)NSEC_PER_SEC;
 }
-static void wait_rest_of_period(struct period_info *pinfo) {
-    inc_period(pinfo);
-
+//Sleeps until the active wait window before target and busy waits the rest. Returns the lateness (ns)
+//record: false for the periods not to account in the active wait statistics (before the start of the control loop)
+static long wait_until(struct timespec *target, bool record) {
+    timespec wakeup = *target;
+    wakeup.tv_nsec -= controlLoopSpin->spinTime();
+    while (wakeup.tv_nsec < 0) {
+        wakeup.tv_sec--;
+        wakeup.tv_nsec += NSEC_PER_SEC;
+    }
+    timespec spinStart, now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    //Overrun (wake-up time already passed): no sleep, so no overshoot to learn from
+    bool overrun = diff_ts(&wakeup, &now) <= 0.;
     /* for simplicity, ignoring possibilities of signal wakes */
-    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &pinfo->next_period_wo_active_wait, NULL);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &spinStart);
+    if (record && !overrun) {
+        controlLoopSpin->sleepOvershoot(diff_ts(&spinStart, &wakeup) * NSEC_PER_SEC);
+    }
     //Wait (busy wait) remaining time of period to account for jitter
+    now = spinStart;
+    while(diff_ts(target, &now)>0.) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+    long lateness = diff_ts(&now, target) * NSEC_PER_SEC;
+    if (record) {
+        controlLoopSpin->periodEnd(diff_ts(&now, &spinStart) * NSEC_PER_SEC, lateness);
+    }
+    return lateness;
+}
+static long wait_rest_of_period(struct period_info *pinfo, bool record) {
+    inc_period(pinfo);
+    return wait_until(&pinfo->next_period, record);
+}
+//Waits for the next SYNC posted by rt_thread (and then for the offset). Returns the lateness vs the post (+ offset).
+//Without SYNC within 1.5 period (CAN not in normal mode, SYNC producer stopped...), returns to run the loop anyway.
+static long wait_sync(struct period_info *pinfo) {
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += pinfo->period_ns + pinfo->period_ns / 2;
+    while (deadline.tv_nsec >= NSEC_PER_SEC) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= NSEC_PER_SEC;
+    }
+    if (sem_timedwait(&controlLoopSyncSem, &deadline) != 0) {
+        if (errno == ETIMEDOUT && controlLoopSyncTimeouts++ == 0) {
+            spdlog::warn("Control loop locked to SYNC: no SYNC for {}ms, running on timeout.", 1.5 * pinfo->period_ns / NSEC_PER_MSEC);
+        }
+        return 0;
+    }
+    //Late control loop: start on the last SYNC
+    while (sem_trywait(&controlLoopSyncSem) == 0) {
+        controlLoopSyncMissed++;
+    }
+    int64_t target_ns = controlLoopSyncTime_ns.load(std::memory_order_acquire) + (int64_t)(rtConfig().controlLoopSyncOffset * NSEC_PER_MSEC);
+    timespec target = {(time_t)(target_ns / NSEC_PER_SEC), (long)(target_ns % NSEC_PER_SEC)};
     timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    while(diff_ts(&pinfo->next_period, &now)>0.) {
-        clock_gettime(CLOCK_MONOTONIC, &now);
+    if (diff_ts(&target, &now) > 0.) {
+        return wait_until(&target);
     }
+    return diff_ts(&now, &target) * NSEC_PER_SEC;
 }
 /* CAN messaging helper functions ********************************/
 
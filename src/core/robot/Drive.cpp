@@ -1,19 +1,65 @@
 #include "Drive.h"
 
+#include <algorithm>
+
+#include "BusLoadPlanner.h"
+#include "SDOWorker.h"
+#include "StartupTrace.h"
+
+std::atomic<Drive *> Drive::instances[DRIVE_MAX_INSTANCES];
+std::atomic<unsigned int> Drive::instancesCount(0);
+std::atomic<uint32_t> Drive::snapshotSeq(0);
+bool Drive::pdoFastStart = false;
+bool Drive::pdoSave = false;
+std::map<int, DrivePDOMapping> Drive::pdoMappings;
+bool Drive::pdoPacking = false;
+
+//Published snapshots are read while the CAN thread may write them (seqlock): both sides access them with relaxed
+//atomic operations, so that this is not a data race and the copy is kept between the sequence fences.
+#define SNAPSHOT_LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define SNAPSHOT_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
 Drive::Drive() {
     statusWord = 0;
     error = 0;
     this->NodeID = -1;
+    registerInstance();
 }
 
 Drive::Drive(int node_id) {
     statusWord = 0;
     error = 0;
     NodeID = node_id;
+    registerInstance();
+}
 
+void Drive::registerInstance() {
+    CO_LOCK_OD();
+    unsigned int count = instancesCount.load(std::memory_order_relaxed);
+    unsigned int i = 0;
+    while (i < count && instances[i].load(std::memory_order_relaxed) != NULL) {
+        i++;
+    }
+    if (i < DRIVE_MAX_INSTANCES) {
+        instances[i].store(this, std::memory_order_release);
+        if (i == count) {
+            instancesCount.store(count + 1, std::memory_order_release);
+        }
+    } else {
+        spdlog::error("Drive {}: more than {} drives, its values will not be updated (DRIVE_MAX_INSTANCES)", NodeID, DRIVE_MAX_INSTANCES);
+    }
+    CO_UNLOCK_OD();
 }
 
 Drive::~Drive() {
+    CO_LOCK_OD();
+    for (unsigned int i = 0; i < instancesCount.load(std::memory_order_relaxed); i++) {
+        if (instances[i].load(std::memory_order_relaxed) == this) {
+            instances[i].store(NULL, std::memory_order_release);
+        }
+    }
+    CO_UNLOCK_OD();
+
     // Needs to undo PDOS
     for (auto p : rpdos) {
         spdlog::debug("Deleting RPDO (COB-ID: 0x{0:x})", p->getCOBID());
@@ -32,32 +78,17 @@ int Drive::getNodeID() {
 
 int Drive::preop() {
     // start drive (Node)
-    std::stringstream sstream;
-    std::vector<std::string> CANCommands;
-    sstream << "[1] " << NodeID << " preop";
-    CANCommands.push_back(sstream.str());
-
-    return sendSDOMessages(CANCommands);
+    return nmtCommand(NodeID, CO_NMT_ENTER_PRE_OPERATIONAL);
 }
 
 int Drive::start() {
     // start drive (Node)
-    std::stringstream sstream;
-    std::vector<std::string> CANCommands;
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-
-    return sendSDOMessages(CANCommands);
+    return nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
 }
 
 int Drive::stop() {
     // stop drive (Node)
-    std::stringstream sstream;
-    std::vector<std::string> CANCommands;
-    sstream << "[1] " << NodeID << " stop";
-    CANCommands.push_back(sstream.str());
-
-    return sendSDOMessages(CANCommands);
+    return nmtCommand(NodeID, CO_NMT_ENTER_STOPPED);
 }
 
 
@@ -86,19 +117,182 @@ bool Drive::setDigitalOut(int digital_out) {
 }
 
 int Drive::getPos() {
-    return actualPos;
+    return snapshot.actualPos;
+}
+
+int Drive::readPos() {
+    CO_LOCK_OD();
+    int pos = actualPos;
+    CO_UNLOCK_OD();
+    return pos;
 }
 
 int Drive::getVel() {
-    return actualVel;
+    return snapshot.actualVel;
 }
 
 int Drive::getTorque() {
-    return actualTor;
+    return snapshot.actualTor;
 }
 
 int Drive::getDigitalIn() {
-    return digitalIn;
+    return snapshot.digitalIn;
+}
+
+void Drive::publishSnapshots() {
+    uint32_t seq = snapshotSeq.load(std::memory_order_relaxed);
+    snapshotSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    unsigned int count = instancesCount.load(std::memory_order_acquire);
+    for (unsigned int k = 0; k < count; k++) {
+        Drive *d = instances[k].load(std::memory_order_acquire);
+        if (d == NULL) {
+            continue;
+        }
+        SNAPSHOT_STORE(d->published.statusWord, d->statusWord);
+        SNAPSHOT_STORE(d->published.errorWord, d->errorWord);
+        SNAPSHOT_STORE(d->published.actualPos, d->actualPos);
+        SNAPSHOT_STORE(d->published.actualVel, d->actualVel);
+        SNAPSHOT_STORE(d->published.actualTor, d->actualTor);
+        SNAPSHOT_STORE(d->published.digitalIn, d->digitalIn);
+        for (unsigned int i = 0; i < d->rpdos.size() && i < DRIVE_SNAPSHOT_RPDOS; i++) {
+            SNAPSHOT_STORE(d->published.rxCount[i], d->rpdos[i]->getRxCount());
+            SNAPSHOT_STORE(d->published.rxTimestamp[i], d->rpdos[i]->getTimestamp());
+        }
+    }
+    snapshotSeq.store(seq + 2, std::memory_order_release);
+}
+
+void Drive::updateSnapshots() {
+    unsigned int count = instancesCount.load(std::memory_order_acquire);
+    for (unsigned int k = 0; k < count; k++) {
+        Drive *d = instances[k].load(std::memory_order_acquire);
+        if (d != NULL) {
+            memcpy(d->previousRxCount, d->snapshot.rxCount, sizeof(d->previousRxCount));
+        }
+    }
+    while (true) {
+        uint32_t seq = snapshotSeq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;  // Publishing in progress
+        }
+        for (unsigned int k = 0; k < count; k++) {
+            Drive *d = instances[k].load(std::memory_order_acquire);
+            if (d == NULL) {
+                continue;
+            }
+            d->snapshot.statusWord = SNAPSHOT_LOAD(d->published.statusWord);
+            d->snapshot.errorWord = SNAPSHOT_LOAD(d->published.errorWord);
+            d->snapshot.actualPos = SNAPSHOT_LOAD(d->published.actualPos);
+            d->snapshot.actualVel = SNAPSHOT_LOAD(d->published.actualVel);
+            d->snapshot.actualTor = SNAPSHOT_LOAD(d->published.actualTor);
+            d->snapshot.digitalIn = SNAPSHOT_LOAD(d->published.digitalIn);
+            for (unsigned int i = 0; i < DRIVE_SNAPSHOT_RPDOS; i++) {
+                d->snapshot.rxCount[i] = SNAPSHOT_LOAD(d->published.rxCount[i]);
+                d->snapshot.rxTimestamp[i] = SNAPSHOT_LOAD(d->published.rxTimestamp[i]);
+            }
+        }
+        //Copy above done before the sequence is read again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshotSeq.load(std::memory_order_relaxed) == seq) {
+            return;
+        }
+    }
+}
+
+unsigned int Drive::markSyncResponses() {
+    unsigned int expected = 0;
+    unsigned int count = instancesCount.load(std::memory_order_acquire);
+    for (unsigned int k = 0; k < count; k++) {
+        Drive *d = instances[k].load(std::memory_order_acquire);
+        if (d == NULL) {
+            continue;
+        }
+        for (unsigned int i = 0; i < d->rpdos.size() && i < DRIVE_SNAPSHOT_RPDOS; i++) {
+            if (d->syncResponse[i]) {
+                d->syncResponseRxCount[i] = d->rpdos[i]->getRxCount();
+                expected++;
+            }
+        }
+    }
+    return expected;
+}
+
+bool Drive::syncResponsesReceived() {
+    unsigned int count = instancesCount.load(std::memory_order_acquire);
+    for (unsigned int k = 0; k < count; k++) {
+        Drive *d = instances[k].load(std::memory_order_acquire);
+        if (d == NULL) {
+            continue;
+        }
+        for (unsigned int i = 0; i < d->rpdos.size() && i < DRIVE_SNAPSHOT_RPDOS; i++) {
+            if (d->syncResponse[i] && d->rpdos[i]->getRxCount() == d->syncResponseRxCount[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+uint64_t Drive::getRxTimestamp(OD_Entry_t entry) {
+    auto it = OD_RPDOs.find(entry);
+    if (it == OD_RPDOs.end()) {
+        return 0;
+    }
+    return it->second->getTimestamp();
+}
+
+int Drive::rpdoIndex(OD_Entry_t entry) {
+    auto it = OD_RPDOs.find(entry);
+    if (it == OD_RPDOs.end()) {
+        return -1;
+    }
+    auto pos = std::find(rpdos.begin(), rpdos.end(), it->second);
+    return (pos != rpdos.end() && pos - rpdos.begin() < DRIVE_SNAPSHOT_RPDOS) ? pos - rpdos.begin() : -1;
+}
+
+bool Drive::isFresh(OD_Entry_t entry) {
+    int i = rpdoIndex(entry);
+    return i >= 0 && snapshot.rxCount[i] != previousRxCount[i];
+}
+
+bool Drive::isFresh() {
+    for (unsigned int i = 0; i < DRIVE_SNAPSHOT_RPDOS; i++) {
+        if (snapshot.rxCount[i] != previousRxCount[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double Drive::age(OD_Entry_t entry) {
+    int i = rpdoIndex(entry);
+    if (i < 0 || snapshot.rxTimestamp[i] == 0) {
+        return -1;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000 + now.tv_nsec - (int64_t)snapshot.rxTimestamp[i]) / 1e9;
+}
+
+std::future<bool> Drive::initPosControlAsync(motorProfile posControlMotorProfile) {
+    return SDOWorker::instance().submit([this, posControlMotorProfile] { return initPosControl(posControlMotorProfile); });
+}
+
+std::future<bool> Drive::initPosControlAsync() {
+    return SDOWorker::instance().submit([this] { return initPosControl(); });
+}
+
+std::future<bool> Drive::initVelControlAsync(motorProfile velControlMotorProfile) {
+    return SDOWorker::instance().submit([this, velControlMotorProfile] { return initVelControl(velControlMotorProfile); });
+}
+
+std::future<bool> Drive::initVelControlAsync() {
+    return SDOWorker::instance().submit([this] { return initVelControl(); });
+}
+
+std::future<bool> Drive::initTorqueControlAsync() {
+    return SDOWorker::instance().submit([this] { return initTorqueControl(); });
 }
 
 DriveState Drive::resetErrors() {
@@ -131,7 +325,14 @@ DriveState Drive::getState() {
 }
 
 int Drive::getStatus() {
-    return statusWord;
+    return snapshot.statusWord;
+}
+
+int Drive::readStatus() {
+    CO_LOCK_OD();
+    int status = statusWord;
+    CO_UNLOCK_OD();
+    return status;
 }
 
 bool Drive::posControlConfirmSP() {
@@ -157,12 +358,19 @@ bool Drive::posControlSetContinuousProfile(bool continuous) {
 }
 
 bool Drive::configureMasterPDOs(){
-    // Set up the PDOs in the OD here
-    for (unsigned int TPDO_Num = 1; TPDO_Num <= TPDO_MappedObjects.size(); TPDO_Num++) {
-        generateEquivalentMasterRPDO(TPDO_MappedObjects[TPDO_Num], TPDO_COBID[TPDO_Num] + NodeID, 0xff);
+    applyPDOMapping();
+
+    // Set up the PDOs in the OD here: only the ones mapped on the drive
+    for (auto &tpdo : TPDO_MappedObjects) {
+        UNSIGNED8 transmissionType = TPDO_TransmissionType.count(tpdo.first) ? TPDO_TransmissionType[tpdo.first] : 0x01;
+        generateEquivalentMasterRPDO(tpdo.second, TPDO_COBID[tpdo.first] + NodeID, 0xff);
+        BusLoadPlanner::setExpectedTransmissionType(TPDO_COBID[tpdo.first] + NodeID, transmissionType);
+        if (rpdos.size() <= DRIVE_SNAPSHOT_RPDOS) {
+            syncResponse[rpdos.size() - 1] = (transmissionType == 0x01);
+        }
     }
-    for (unsigned int RPDO_Num = 1; RPDO_Num <= RPDO_MappedObjects.size(); RPDO_Num++) {
-        generateEquivalentMasterTPDO(RPDO_MappedObjects[RPDO_Num], RPDO_COBID[RPDO_Num] + NodeID, 0xff);
+    for (auto &rpdo : RPDO_MappedObjects) {
+        generateEquivalentMasterTPDO(rpdo.second, RPDO_COBID[rpdo.first] + NodeID, RPDO_TransmissionType.count(rpdo.first) ? RPDO_TransmissionType[rpdo.first] : 0xff);
     }
 
     return true;
@@ -170,83 +378,60 @@ bool Drive::configureMasterPDOs(){
 
 bool Drive::initPDOs() {
     spdlog::debug("Drive::initPDOs");
-
-    // Calculate COB_ID. If TPDO:
-    //int COB_ID = 0x100 * PDO_Num + 0x80 + NodeID;
-    int TPDO_Num = 1;
-    spdlog::debug("Set up STATUS_WORD TPDO on Node {}", NodeID);
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0xFF)) < 0) {
-        spdlog::error("Set up STATUS_WORD TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up ACTUAL_POS and ACTUAL_VEL TPDO on Node {}", NodeID);
-    TPDO_Num = 2;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0x01)) < 0) {
-        spdlog::error("Set up ACTUAL_POS and ACTUAL_VEL TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up ACTUAL_TOR TPDO on Node {}", NodeID);
-    TPDO_Num = 3;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0x01)) < 0) {
-        spdlog::error("Set up ACTUAL_TOR TPDO FAILED on node {}", NodeID);
-        return false;
+    StartupSpan span("Drive::initPDOs (node " + std::to_string(NodeID) + ")");
+    applyPDOMapping();
+
+    for (auto &cobID : TPDO_COBID) {
+        int TPDO_Num = cobID.first;
+        if (TPDO_MappedObjects.count(TPDO_Num) == 0) {
+            spdlog::debug("Disable TPDO {} on Node {}", TPDO_Num, NodeID);
+            if (disablePDO(0x1800 + TPDO_Num - 1, cobID.second + NodeID) < 0) {
+                spdlog::error("Disable TPDO {} FAILED on node {}", TPDO_Num, NodeID);
+                return false;
+            }
+            continue;
+        }
+        int transmissionType = TPDO_TransmissionType.count(TPDO_Num) ? TPDO_TransmissionType[TPDO_Num] : 0x01;
+        spdlog::debug("Set up TPDO {} on Node {} (transmission type 0x{:x})", TPDO_Num, NodeID, transmissionType);
+        if (sendTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, cobID.second + NodeID, transmissionType) < 0) {
+            spdlog::error("Set up TPDO {} FAILED on node {}", TPDO_Num, NodeID);
+            return false;
+        }
     }
 
-    // Calculate COB_ID. If RPDO:
-    //int COB_ID = 0x100 * (PDO_Num+1) + NodeID;
-    spdlog::debug("Set up CONTROL_WORD and DIGITAL_OUT RPDO on Node {}", NodeID);
-    int RPDO_Num = 1;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up CONTROL_WORD and DIGITAL_OUT RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-    spdlog::debug("Set up TARGET_POS RPDO on Node {}", NodeID);
-    RPDO_Num = 2;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up TARGET_POS RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-    spdlog::debug("Set up TARGET_VEL RPDO on Node {}", NodeID);
-    RPDO_Num = 3;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up TARGET_VEL RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-    spdlog::debug("Set up TARGET_TOR RPDO on Node {}", NodeID);
-    RPDO_Num = 4;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up TARGET_TOR RPDO FAILED on node {}", NodeID);
-        return false;
+    for (auto &cobID : RPDO_COBID) {
+        int RPDO_Num = cobID.first;
+        if (RPDO_MappedObjects.count(RPDO_Num) == 0) {
+            spdlog::debug("Disable RPDO {} on Node {}", RPDO_Num, NodeID);
+            if (disablePDO(0x1400 + RPDO_Num - 1, cobID.second + NodeID) < 0) {
+                spdlog::error("Disable RPDO {} FAILED on node {}", RPDO_Num, NodeID);
+                return false;
+            }
+            continue;
+        }
+        // Applied by the drive when received, whatever the rate at which they are sent
+        spdlog::debug("Set up RPDO {} on Node {}", RPDO_Num, NodeID);
+        if (sendRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, cobID.second + NodeID, 0xff) < 0) {
+            spdlog::error("Set up RPDO {} FAILED on node {}", RPDO_Num, NodeID);
+            return false;
+        }
     }
+    savePDOConfig();
     return true;
-    }
+}
 
 bool Drive::setMotorProfile(motorProfile profile) {
     spdlog::debug("Drive::initMotorProfile");
 
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-
-     //Set velocity profile
-    sstream << "[1] " << NodeID << " write 0x6081 0 i32 " << std::dec << profile.profileVelocity;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
+    int ret = 0;
+    //Set velocity profile
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6081, 0, profile.profileVelocity);
     //Set acceleration profile
-    sstream << "[1] " << NodeID << " write 0x6083 0 i32 " << std::dec << profile.profileAcceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6083, 0, profile.profileAcceleration);
     //Set deceleration profile
-    sstream << "[1] " << NodeID << " write 0x6084 0 i32 " << std::dec << profile.profileDeceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6084, 0, profile.profileDeceleration);
 
-    if(sendSDOMessages(CANCommands)<0) {
+    if(ret<0) {
         spdlog::error("Set up Velocity/Acceleration profile failed on node {}", NodeID);
         return false;
     }
@@ -254,271 +439,306 @@ bool Drive::setMotorProfile(motorProfile profile) {
     return true;
 }
 
-std::vector<std::string> Drive::generateTPDOConfigSDO(std::vector<OD_Entry_t> items, int PDO_Num, int COB_ID, int SyncRate) {
-    // TODO: Do a check to make sure that the OD_Entry_t items can be transmitted.
+int Drive::sendTPDOConfigSDO(const std::vector<OD_Entry_t> &items, int PDO_Num, int COB_ID, int SyncRate) {
+    return sendPDOConfigSDO(0x1800 + PDO_Num - 1, 0x1A00 + PDO_Num - 1, items, COB_ID, SyncRate);
+}
 
-    // Calculate COB_ID. If TPDO:
-    //int COB_ID = 0x100 * PDO_Num + 0x80 + NodeID;
+void Drive::generateEquivalentMasterRPDO(std::vector<OD_Entry_t> items, int COB_ID, int RPDOSyncRate) {
+    void *variables[items.size()];
+    UNSIGNED16 variableSize[items.size()];
+    for (uint i = 0; i < items.size(); i++) {
+        variables[i] = OD_MappedObjectAddresses[items[i]];
+        variableSize[i] = OD_DataSize[items[i]];
+    }
+    // Add to the local (CORC-side) Object Dictionary
+    rpdos.push_back(new RPDO(COB_ID, RPDOSyncRate, variables, variableSize, items.size()));
+    for (auto item : items) {
+        OD_RPDOs[item] = rpdos.back();
+    }
+    if (rpdos.size() > DRIVE_SNAPSHOT_RPDOS) {
+        spdlog::warn("Node {}: RPDO (COB-ID 0x{:x}) beyond the {} tracked ones (DRIVE_SNAPSHOT_RPDOS): its values are never reported fresh and their age is -1",
+                     NodeID, COB_ID, DRIVE_SNAPSHOT_RPDOS);
+    }
 
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
+    //spdlog::debug("Master RPDO (COB-ID 0x{0:x}) Setup for Node {}", COB_ID, NodeID);
+}
+
+/**
+ *  \todo Do a check to make sure that the OD_Entry_t items can be Received
+ *
+ */
+int Drive::sendRPDOConfigSDO(const std::vector<OD_Entry_t> &items, int PDO_Num, int COB_ID, int UpdateTiming) {
+    return sendPDOConfigSDO(0x1400 + PDO_Num - 1, 0x1600 + PDO_Num - 1, items, COB_ID, UpdateTiming);
+}
+
+void Drive::generateEquivalentMasterTPDO(std::vector<OD_Entry_t> items, int COB_ID, int TPDOSyncRate) {
+    void *variables[items.size()];
+    UNSIGNED16 variableSize[items.size()];
+    for (uint i = 0; i < items.size(); i++) {
+        variables[i] = OD_MappedObjectAddresses[items[i]];
+        variableSize[i] = OD_DataSize[items[i]];
+    }
+    // Add to the local (CORC-side) Object Dictionary
+    tpdos.push_back(new TPDO(COB_ID, TPDOSyncRate, variables, variableSize, items.size()));
+    //spdlog::debug("Master TPDO (COB-ID 0x{0:x}) Setup for Node {}", COB_ID, NodeID);
+}
 
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int Drive::sendPDOConfigSDO(UNSIGNED16 commIndex, UNSIGNED16 mapIndex, const std::vector<OD_Entry_t> &items, int COB_ID, int transmissionType) {
+    int ret = 0;
+    if (pdoFastStart) {
+        switch (comparePDOConfig(commIndex, mapIndex, items, COB_ID, transmissionType)) {
+            case PDO_CONFIG_IDENTICAL:
+                spdlog::debug("PDO 0x{0:x} (COB-ID 0x{1:x}) already configured on node {2}", commIndex, COB_ID, NodeID);
+                return 0;
+            case PDO_CONFIG_TRANSMISSION_TYPE:
+                // Can be changed while the PDO is enabled
+                pdoConfigChanged = true;
+                return sdoWrite<UNSIGNED8>(NodeID, commIndex, 2, transmissionType);
+            case PDO_CONFIG_DIFFERENT:
+                break;
+        }
+    }
+    pdoConfigChanged = true;
 
     // Disable PDO
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1800 + PDO_Num - 1 << " 1 u32 0x" << std::hex << 0x80000000 + COB_ID;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED32>(NodeID, commIndex, 1, 0x80000000 + COB_ID);
 
     // Set so that there no PDO items, enable mapping change
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1A00 + PDO_Num - 1 << " 0 u8 0";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED8>(NodeID, mapIndex, 0, 0);
 
     // Set the PDO so that it triggers every SYNC Message
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1800 + PDO_Num - 1 << " 2 u8 0x" << SyncRate;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED8>(NodeID, commIndex, 2, transmissionType);
 
     for (unsigned int i = 1; i <= items.size(); i++) {
         // Set transmit parameters
-        sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1A00 + PDO_Num - 1 << " " << i << " u32 0x" << std::hex << OD_Addresses[items[i - 1]][0] * 0x10000 + OD_Addresses[items[i - 1]][1] * 0x100 + OD_DataSize[items[i - 1]]*8;
-        CANCommands.push_back(sstream.str());
-        sstream.str(std::string());
+        ret += sdoWrite<UNSIGNED32>(NodeID, mapIndex, i, pdoMappingEntry(items[i - 1]));
     }
 
     // Sets Number of PDO items to reenable
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1A00 + PDO_Num - 1 << " 0 u8 " << items.size();
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED8>(NodeID, mapIndex, 0, items.size());
 
     // Enable  PDO
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1800 + PDO_Num - 1 << " 1 u32 0x" << std::hex << COB_ID;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED32>(NodeID, commIndex, 1, COB_ID);
 
-    return CANCommands;
+    return ret;
 }
 
-void Drive::generateEquivalentMasterRPDO(std::vector<OD_Entry_t> items, int COB_ID, int RPDOSyncRate) {
-    void *variables[items.size()];
-    UNSIGNED16 variableSize[items.size()];
-    for (uint i = 0; i < items.size(); i++) {
-        variables[i] = OD_MappedObjectAddresses[items[i]];
-        variableSize[i] = OD_DataSize[items[i]];
+Drive::PDOConfigDiff Drive::comparePDOConfig(UNSIGNED16 commIndex, UNSIGNED16 mapIndex, const std::vector<OD_Entry_t> &items, int COB_ID, int transmissionType) {
+    UNSIGNED32 cobID;
+    UNSIGNED8 noOfMappedObjects;
+    UNSIGNED8 type;
+
+    // Enabled (bit 31 clear) with the same COB-ID. Bit 30 (RTR not allowed) is left to the drive.
+    if (sdoRead<UNSIGNED32>(NodeID, commIndex, 1, cobID) != 0 || (cobID & 0xBFFFFFFF) != (UNSIGNED32)COB_ID) {
+        return PDO_CONFIG_DIFFERENT;
     }
-    // Add to the local (CORC-side) Object Dictionary
-    rpdos.push_back(new RPDO(COB_ID, RPDOSyncRate, variables, variableSize, items.size()));
+    if (sdoRead<UNSIGNED8>(NodeID, mapIndex, 0, noOfMappedObjects) != 0 || noOfMappedObjects != items.size()) {
+        return PDO_CONFIG_DIFFERENT;
+    }
+    for (unsigned int i = 1; i <= items.size(); i++) {
+        UNSIGNED32 entry;
+        if (sdoRead<UNSIGNED32>(NodeID, mapIndex, i, entry) != 0 || entry != pdoMappingEntry(items[i - 1])) {
+            return PDO_CONFIG_DIFFERENT;
+        }
+    }
+    if (sdoRead<UNSIGNED8>(NodeID, commIndex, 2, type) != 0 || type != (UNSIGNED8)transmissionType) {
+        return PDO_CONFIG_TRANSMISSION_TYPE;
+    }
+    return PDO_CONFIG_IDENTICAL;
+}
 
-    //spdlog::debug("Master RPDO (COB-ID 0x{0:x}) Setup for Node {}", COB_ID, NodeID);
+bool Drive::savePDOConfig() {
+    if (!pdoSave || !pdoConfigChanged) {
+        return true;
+    }
+    spdlog::info("Saving communication parameters (PDOs) of node {}", NodeID);
+    // "save" signature
+    if (sdoWrite<UNSIGNED32>(NodeID, 0x1010, 2, 0x65766173) != 0) {
+        spdlog::warn("Node {} did not save its communication parameters: PDOs will be configured again on next start", NodeID);
+        return false;
+    }
+    pdoConfigChanged = false;
+    return true;
 }
 
-std::vector<std::string> Drive::generateRPDOConfigSDO(std::vector<OD_Entry_t> items, int PDO_Num, int COB_ID, int UpdateTiming) {
-    /**
-     *  \todo Do a check to make sure that the OD_Entry_t items can be Received
-     *
-     */
+void Drive::setPDOFastStart(bool fastStart, bool save) {
+    pdoFastStart = fastStart;
+    pdoSave = save;
+}
 
+void Drive::setPDOMapping(int nodeID, const DrivePDOMapping &mapping) {
+    pdoMappings[nodeID] = mapping;
+}
 
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
+void Drive::setPDOPacking(bool packing) {
+    pdoPacking = packing;
+}
 
-    // Define stringstream for ease of constructing hex strings
+bool Drive::applyPDOMapping() {
+    if (pdoMappingApplied) {
+        return true;
+    }
+    pdoMappingApplied = true;
+    bool ret = true;
+    auto it = pdoMappings.find(NodeID);
+    if (it == pdoMappings.end()) {
+        it = pdoMappings.find(0);
+    }
+    if (it != pdoMappings.end()) {
+        ret = usePDOMapping(it->second);
+    }
+    if (pdoPacking) {
+        // Values received can be sent with any synchronous PDO, commands keep their own rate
+        packPDOs(TPDO_MappedObjects, TPDO_TransmissionType, 0x01, true);
+        packPDOs(RPDO_MappedObjects, RPDO_TransmissionType, 0xFF, false);
+    }
+    return ret;
+}
 
-    std::stringstream sstream;
-    // Disable PDO
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1400 + PDO_Num - 1 << " 1 u32 0x" << std::hex << 0x80000000 + COB_ID;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+bool Drive::usePDOMapping(const DrivePDOMapping &mapping) {
+    // Check the mapping against what this drive supports before using it
+    for (auto *pdos : {&mapping.TPDO_MappedObjects, &mapping.RPDO_MappedObjects}) {
+        bool isTPDO = (pdos == &mapping.TPDO_MappedObjects);
+        for (auto &pdo : *pdos) {
+            if ((isTPDO ? TPDO_COBID : RPDO_COBID).count(pdo.first) == 0) {
+                spdlog::error("Node {}: no {} {} on this drive. Default PDO mapping used.", NodeID, isTPDO ? "TPDO" : "RPDO", pdo.first);
+                return false;
+            }
+            unsigned int length = 0;
+            for (auto item : pdo.second) {
+                if (OD_Addresses.count(item) == 0 || OD_MappedObjectAddresses.count(item) == 0) {
+                    spdlog::error("Node {}: OD entry {} can't be mapped on this drive. Default PDO mapping used.", NodeID, (int)item);
+                    return false;
+                }
+                length += OD_DataSize[item];
+            }
+            if (pdo.second.empty() || length > 8) {
+                spdlog::error("Node {}: invalid {} {} mapping ({} bytes). Default PDO mapping used.", NodeID, isTPDO ? "TPDO" : "RPDO", pdo.first, length);
+                return false;
+            }
+        }
+    }
 
-    // Set so that there no PDO items, enable mapping change
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1600 + PDO_Num - 1 << " 0 u8 0";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    TPDO_MappedObjects = mapping.TPDO_MappedObjects;
+    RPDO_MappedObjects = mapping.RPDO_MappedObjects;
+    for (auto &t : mapping.TPDO_TransmissionType) {
+        TPDO_TransmissionType[t.first] = t.second;
+    }
+    for (auto &t : mapping.RPDO_TransmissionType) {
+        RPDO_TransmissionType[t.first] = t.second;
+    }
+    spdlog::debug("Node {}: PDO mapping set ({} TPDOs, {} RPDOs)", NodeID, TPDO_MappedObjects.size(), RPDO_MappedObjects.size());
+    return true;
+}
 
-    // Set the PDO so that it triggers every SYNC Message
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1400 + PDO_Num - 1 << " 2 u8 0x" << UpdateTiming;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+bool Drive::packPDOs(std::map<UNSIGNED8, std::vector<OD_Entry_t>> &mappedObjects, std::map<UNSIGNED8, UNSIGNED8> &transmissionTypes, UNSIGNED8 defaultType, bool promoteEventDriven) {
+    struct PDOBin {
+        UNSIGNED8 type;
+        int size;
+        std::vector<OD_Entry_t> items;
+    };
 
-    for (unsigned int i = 1; i <= items.size(); i++) {
-        // Set transmit parameters
-        sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1600 + PDO_Num - 1 << " " << i << " u32 0x" << std::hex << OD_Addresses[items[i - 1]][0] * 0x10000 + OD_Addresses[items[i - 1]][1] * 0x100 + OD_DataSize[items[i - 1]]*8;
-        CANCommands.push_back(sstream.str());
-        sstream.str(std::string());
+    // Objects by transmission type: synchronous ones first, fastest first, then event driven
+    std::map<UNSIGNED8, std::vector<OD_Entry_t>> objectsByType;
+    for (auto &pdo : mappedObjects) {
+        UNSIGNED8 type = transmissionTypes.count(pdo.first) ? transmissionTypes[pdo.first] : defaultType;
+        objectsByType[type].insert(objectsByType[type].end(), pdo.second.begin(), pdo.second.end());
     }
 
-    // Sets Number of PDO items to reenable
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1600 + PDO_Num - 1 << " 0 u8 " << items.size();
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    // Enable  PDO
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << 0x1400 + PDO_Num - 1 << " 1 u32 0x" << std::hex << COB_ID;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    // First fit decreasing into 8 bytes PDOs of the same transmission type. Event driven objects first fill the
+    // room left in the synchronous PDOs if allowed (sent anyway, at no additional frame).
+    std::vector<PDOBin> bins;
+    for (auto &group : objectsByType) {
+        std::vector<OD_Entry_t> &items = group.second;
+        std::stable_sort(items.begin(), items.end(), [this](OD_Entry_t a, OD_Entry_t b) { return OD_DataSize[a] > OD_DataSize[b]; });
+        bool eventDriven = group.first > 240;
+        for (auto item : items) {
+            int size = OD_DataSize[item];
+            PDOBin *bin = nullptr;
+            for (auto &b : bins) {
+                if ((b.type == group.first || (eventDriven && promoteEventDriven && b.type <= 240)) && b.size + size <= 8) {
+                    bin = &b;
+                    break;
+                }
+            }
+            if (bin == nullptr) {
+                bins.push_back({group.first, 0, {}});
+                bin = &bins.back();
+            }
+            bin->size += size;
+            bin->items.push_back(item);
+        }
+    }
+    if (bins.size() >= mappedObjects.size()) {
+        return false;
+    }
 
-    return CANCommands;
+    spdlog::info("Node {}: {} PDOs packed into {}", NodeID, mappedObjects.size(), bins.size());
+    mappedObjects.clear();
+    transmissionTypes.clear();
+    for (unsigned int i = 0; i < bins.size(); i++) {
+        mappedObjects[i + 1] = bins[i].items;
+        transmissionTypes[i + 1] = bins[i].type;
+    }
+    return true;
 }
 
-void Drive::generateEquivalentMasterTPDO(std::vector<OD_Entry_t> items, int COB_ID, int TPDOSyncRate) {
-    void *variables[items.size()];
-    UNSIGNED16 variableSize[items.size()];
-    for (uint i = 0; i < items.size(); i++) {
-        variables[i] = OD_MappedObjectAddresses[items[i]];
-        variableSize[i] = OD_DataSize[items[i]];
+int Drive::disablePDO(UNSIGNED16 commIndex, int COB_ID) {
+    if (pdoFastStart) {
+        UNSIGNED32 cobID;
+        if (sdoRead<UNSIGNED32>(NodeID, commIndex, 1, cobID) == 0 && (cobID & 0x80000000)) {
+            return 0;
+        }
     }
-    // Add to the local (CORC-side) Object Dictionary
-    tpdos.push_back(new TPDO(COB_ID, TPDOSyncRate, variables, variableSize, items.size()));
-    //spdlog::debug("Master TPDO (COB-ID 0x{0:x}) Setup for Node {}", COB_ID, NodeID);
+    pdoConfigChanged = true;
+    return sdoWrite<UNSIGNED32>(NodeID, commIndex, 1, 0x80000000 + COB_ID);
 }
 
-std::vector<std::string> Drive::generatePosControlConfigSDO(motorProfile positionProfile) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-    // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-    //enable profile position mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 1";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+int Drive::sendPosControlConfigSDO(motorProfile positionProfile) {
+    int ret = sendPosControlConfigSDO();
 
     //Set velocity profile
-    sstream << "[1] " << NodeID << " write 0x6081 0 i32 " << std::dec << positionProfile.profileVelocity;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6081, 0, positionProfile.profileVelocity);
     //Set acceleration profile
-    sstream << "[1] " << NodeID << " write 0x6083 0 i32 " << std::dec << positionProfile.profileAcceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6083, 0, positionProfile.profileAcceleration);
     //Set deceleration profile
-    sstream << "[1] " << NodeID << " write 0x6084 0 i32 " << std::dec << positionProfile.profileDeceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6084, 0, positionProfile.profileDeceleration);
 
-    return CANCommands;
+    return ret;
 }
-std::vector<std::string> Drive::generatePosControlConfigSDO() {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int Drive::sendPosControlConfigSDO() {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
     //enable profile position mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 1";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 1);
 
-    return CANCommands;
+    return ret;
 }
 
-std::vector<std::string> Drive::generateVelControlConfigSDO(motorProfile velocityProfile) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-    // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-    //enable profile Velocity mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 3";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+int Drive::sendVelControlConfigSDO(motorProfile velocityProfile) {
+    int ret = sendVelControlConfigSDO();
 
     //Set acceleration profile
-    sstream << "[1] " << NodeID << " write 0x6083 0 i32 " << std::dec << velocityProfile.profileAcceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6083, 0, velocityProfile.profileAcceleration);
     //Set deceleration profile
-    sstream << "[1] " << NodeID << " write 0x6084 0 i32 " << std::dec << velocityProfile.profileDeceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6084, 0, velocityProfile.profileDeceleration);
 
-    return CANCommands;
+    return ret;
 }
-std::vector<std::string> Drive::generateVelControlConfigSDO() {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int Drive::sendVelControlConfigSDO() {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
     //enable profile Velocity mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 3";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 3);
 
-    return CANCommands;
+    return ret;
 }
 
-std::vector<std::string> Drive::generateTorqueControlConfigSDO() {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int Drive::sendTorqueControlConfigSDO() {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
     //enable Torque Control mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 4";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    return CANCommands;
-}
-
-int Drive::sendSDOMessages(std::vector<std::string> messages) {
-    int successfulMessages = 0;
-    for (auto strCommand : messages) {
-        spdlog::trace(strCommand);
-
-#ifndef NOROBOT
-        // explicitly cast c++ string to from const char* to char* for use by cancomm function
-        char *SDO_Message = (char *)(strCommand.c_str());
-        char returnMessage[STRING_BUFFER_SIZE];
-        cancomm_socketFree(SDO_Message, returnMessage);
-        std::string retMsg = returnMessage;
-
-        // Because returnMessage includes sequence it is possible value is "[1] OK".
-        // Therefore it is checked if return message includes the string "OK".
-        // Another option would be erasing the sequence value before returning in cancomm_socketFree
-        if (retMsg.find("OK") != std::string::npos) {
-            successfulMessages++;
-        }
-        else {
-            std::string errormsg = "sendSDOMessage: ERROR: " + strCommand;
-            if(retMsg.find("0x")!=retMsg.npos) {
-                std::string error_code = retMsg.substr(retMsg.find("0x"), retMsg.npos);
-                errormsg += " => " +  SDO_Standard_Error[error_code] + " (" + error_code + ")";
-            }
-            else {
-                errormsg += " => " + retMsg;
-            }
-            spdlog::error(errormsg);
-        }
-        spdlog::trace(retMsg);
-#else
-        spdlog::trace("VCAN OK no reply.");
-        successfulMessages++;
-#endif
-    }
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 4);
 
-    return successfulMessages-messages.size();
+    return ret;
 }
-
-
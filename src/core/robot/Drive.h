@@ -20,42 +20,16 @@
 #include <CO_command.h>
 #include <string.h>
 
+#include <atomic>
+#include <future>
 #include <map>
 #include <sstream>
 #include <vector>
 
 #include "logging.h"
 #include "RPDO.h"
+#include "SDO.h"
 #include "TPDO.h"
-/**
- * Map of standard SDOs return error codes
- */
-static std::map<std::string, std::string> SDO_Standard_Error = {
-    {"0x05030000", "Toggle bit not changed"},
-    {"0x05040000", "SDO protocol timed out"},
-    {"0x05040001", "Client/server command specifier not valid or unknown"},
-    {"0x05040002", "Invalid block size (block mode only)"},
-    {"0x05040003", "Invalid sequence number (block mode only)"},
-    {"0x05040004", "CRC error (block mode only)"},
-    {"0x05040005", "Out of memory"},
-    {"0x06010000", "Access to this object is not supported"},
-    {"0x06010002", "Attempt to write to a Read_Only parameter"},
-    {"0x06020000", "The object is not found in the object directory"},
-    {"0x06040041", "The object can not be mapped into the PDO"},
-    {"0x06040042", "The number and/or length of mapped objects would exceed the PDO length"},
-    {"0x06040043", "General parameter incompatibility"},
-    {"0x06040047", "General internal error in device"},
-    {"0x06060000", "Access interrupted due to hardware error"},
-    {"0x06070010", "Data type or parameter length do not agree or are unknown"},
-    {"0x06070012", "Data type does not agree, parameter length too great"},
-    {"0x06070013", "Data type does not agree, parameter length too short"},
-    {"0x06090011", "Sub-index not present"},
-    {"0x06090030", "General value range error"},
-    {"0x06090031", "Value range error: parameter value too great"},
-    {"0x06090032", "Value range error: parameter value too small"},
-    {"0x060A0023", "Resource not available"},
-    {"0x08000021", "Access not possible due to local application"},
-    {"0x08000022", "Access not possible due to current device status"}};
 
 /**
  * An enum type.
@@ -98,6 +72,23 @@ enum OD_Entry_t {
     DIGITAL_OUT = 15
 };
 
+/**
+ * \brief Values received from a drive, as published by the CAN thread once per SYNC (see Drive::publishSnapshots)
+ */
+#define DRIVE_SNAPSHOT_RPDOS 4 /*!< Number of (master) RPDOs of a drive whose reception is tracked (isFresh(), age()), a warning is logged for further ones */
+#define DRIVE_MAX_INSTANCES 32 /*!< Maximum number of drives whose values are published to the control thread */
+#define DRIVE_CACHE_LINE 64
+struct DriveSnapshot {
+    UNSIGNED16 statusWord = 0;
+    UNSIGNED16 errorWord = 0;
+    INTEGER32 actualPos = 0;
+    INTEGER32 actualVel = 0;
+    INTEGER16 actualTor = 0;
+    UNSIGNED16 digitalIn = 0;
+    uint32_t rxCount[DRIVE_SNAPSHOT_RPDOS] = {0};      //!< Messages received on each RPDO of the drive (Drive::rpdos order)
+    uint64_t rxTimestamp[DRIVE_SNAPSHOT_RPDOS] = {0};  //!< Kernel receive time of the last message of each RPDO (ns, CLOCK_MONOTONIC)
+};
+
 /**
  * \brief struct to hold desired velocity, acceleration and deceleration values for a
  *     drives motor controller profile.
@@ -108,6 +99,19 @@ struct motorProfile {
     int profileDeceleration;
 };
 
+/**
+ * \brief PDOs mapping of a drive, e.g. loaded from the robot YAML file (see Drive::setPDOMapping()).
+ *     PDOs are identified by their number (1 to 4): a PDO number not in the maps is not used (disabled on the drive).
+ *     TPDO_*: drive TPDOs (values received by CORC), RPDO_*: drive RPDOs (commands sent by CORC).
+ *     Transmission types: 1-240 sent every N SYNC, 0xFF event driven (drive TPDOs) or sent when changed (commands).
+ */
+struct DrivePDOMapping {
+    std::map<UNSIGNED8, std::vector<OD_Entry_t>> TPDO_MappedObjects;
+    std::map<UNSIGNED8, std::vector<OD_Entry_t>> RPDO_MappedObjects;
+    std::map<UNSIGNED8, UNSIGNED8> TPDO_TransmissionType;
+    std::map<UNSIGNED8, UNSIGNED8> RPDO_TransmissionType;
+};
+
 /**
  * @ingroup Robot
  * \brief Abstract class describing a Drive used to communicate with a CANbus device. Note that many functions are implemented according to the CiA 402 Standard (but can be overridden)
@@ -129,16 +133,21 @@ class Drive {
     std::vector<TPDO *> tpdos;
 
     /**
-        * \brief Generates the list of commands required to configure TPDOs on the drives
+     * \brief Map between the OD entries received from the drive and the (master) RPDO they are mapped on
+     *
+     */
+    std::map<OD_Entry_t, RPDO *> OD_RPDOs;
+
+    /**
+        * \brief Configures a TPDO on the drive (through SDO writes)
         *
         * \param items A list of OD_Entry_t items which are to be configured with this TPDO
         * \param PDO_Num The number/index of this PDO
         * \param COB_ID the COB-ID of the PDO
         * \param SyncRate The rate at which this PDO transmits (e.g. number of Sync Messages. 0xFF represents internal trigger event)
-        * \param sub_idx The register sub index
-        * \return std::string
+        * \return int -number_of_unsuccesfull SDO writes (0 means OK for all)
         */
-    std::vector<std::string> generateTPDOConfigSDO(std::vector<OD_Entry_t> items, int PDO_Num, int COB_ID, int SyncRate);
+    int sendTPDOConfigSDO(const std::vector<OD_Entry_t> &items, int PDO_Num, int COB_ID, int SyncRate);
 
     /**
         * \brief Creates a RPDO in the Local Object Dictionary for the equivalent TPDO on the drive
@@ -151,16 +160,15 @@ class Drive {
 
 
     /**
-        * \brief Generates the list of commands required to configure RPDOs on the drives
+        * \brief Configures a RPDO on the drive (through SDO writes)
         *
         * \param items A list of OD_Entry_t items which are to be configured with this RPDO
         * \param PDO_Num The number/index of this PDO
         * \param COB_ID the COB-ID of the PDO
         * \param UpdateTiming 0-240 represents hold until next sync message, 0xFF represents immediate update
-        * \param sub_idx The register sub index
-        * \return std::string
+        * \return int -number_of_unsuccesfull SDO writes (0 means OK for all)
         */
-    std::vector<std::string> generateRPDOConfigSDO(std::vector<OD_Entry_t> items, int PDO_Num, int COB_ID,int UpdateTiming);
+    int sendRPDOConfigSDO(const std::vector<OD_Entry_t> &items, int PDO_Num, int COB_ID, int UpdateTiming);
 
     /**
         * \brief Creates a TPDO in the Local Object Dictionary for the equivalent RPDO on the drive
@@ -171,9 +179,51 @@ class Drive {
         */
     void generateEquivalentMasterTPDO(std::vector<OD_Entry_t> items, int COB_ID, int TPDOSyncRate);
 
+    /**
+        * \brief Configures a PDO on the drive (through SDO writes). Used by sendTPDOConfigSDO() and sendRPDOConfigSDO().
+        *
+        * With PDO fast start (see setPDOFastStart()), the configuration held by the drive is read back first
+        * (comparePDOConfig()) and only what differs is written.
+        *
+        * \param commIndex Index of the PDO communication parameter (0x1400 or 0x1800 + PDO_Num - 1)
+        * \param mapIndex Index of the PDO mapping parameter (0x1600 or 0x1A00 + PDO_Num - 1)
+        * \param items A list of OD_Entry_t items which are to be mapped on this PDO
+        * \param COB_ID the COB-ID of the PDO
+        * \param transmissionType Transmission type of the PDO (e.g. number of Sync Messages, 0xFF for event driven)
+        * \return int -number_of_unsuccesfull SDO writes (0 means OK for all)
+        */
+    int sendPDOConfigSDO(UNSIGNED16 commIndex, UNSIGNED16 mapIndex, const std::vector<OD_Entry_t> &items, int COB_ID, int transmissionType);
+
+    /**
+     * \brief Difference between the configuration of a PDO held by the drive and the expected one
+     *
+     */
+    enum PDOConfigDiff {
+        PDO_CONFIG_IDENTICAL = 0,         /*!< Nothing to write */
+        PDO_CONFIG_TRANSMISSION_TYPE = 1, /*!< Same COB-ID and mapping, only the transmission type differs */
+        PDO_CONFIG_DIFFERENT = 2          /*!< COB-ID or mapping differ (or could not be read): full configuration */
+    };
+
+    /**
+        * \brief Reads back the configuration of a PDO from the drive (SDO reads, stops at the first difference)
+        * and compares it to the one sendPDOConfigSDO() would write
+        *
+        * \return PDOConfigDiff
+        */
+    PDOConfigDiff comparePDOConfig(UNSIGNED16 commIndex, UNSIGNED16 mapIndex, const std::vector<OD_Entry_t> &items, int COB_ID, int transmissionType);
+
+    /**
+        * \brief Saves the communication parameters of the drive (0x1010 sub 2, which include the PDOs configuration)
+        * if PDO save is enabled (see setPDOFastStart()) and a PDO configuration was written. Called at the end of initPDOs().
+        *
+        * \return true if successful or nothing to save
+        * \return false if the drive refused to save
+        */
+    bool savePDOConfig();
+
     /**
        *
-       * \brief  Generates the list of commands required to configure Position control in CANopen motor drive
+       * \brief  Configures Position control in CANopen motor drive (through SDO writes)
        *
        *
        * \param Profile Velocity, value used by position mode motor trajectory generator.
@@ -183,7 +233,7 @@ class Drive {
        * NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
        *           https://www.can-cia.org/can-knowledge/canopen/cia402/
        */
-    std::vector<std::string> generatePosControlConfigSDO(motorProfile positionProfile);
+    int sendPosControlConfigSDO(motorProfile positionProfile);
 
     /**
        *
@@ -193,11 +243,11 @@ class Drive {
        * NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
        *           https://www.can-cia.org/can-knowledge/canopen/cia402/
        */
-    std::vector<std::string> generatePosControlConfigSDO();
+    int sendPosControlConfigSDO();
 
     /**
        *
-       * \brief  Generates the list of commands required to configure Velocity control in CANopen motor drive
+       * \brief  Configures Velocity control in CANopen motor drive (through SDO writes)
        *
        *
        * \param Profile Velocity, value used by Velocity mode motor trajectory generator.
@@ -209,7 +259,7 @@ class Drive {
        * NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
        *           https://www.can-cia.org/can-knowledge/canopen/cia402/
        */
-    std::vector<std::string> generateVelControlConfigSDO(motorProfile velocityProfile);
+    int sendVelControlConfigSDO(motorProfile velocityProfile);
 
     /**
        *
@@ -219,23 +269,17 @@ class Drive {
        * NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
        *           https://www.can-cia.org/can-knowledge/canopen/cia402/
        */
-    std::vector<std::string> generateVelControlConfigSDO();
+    int sendVelControlConfigSDO();
 
     /**
        *
-       * \brief  Generates the list of commands required to configure Torque control in CANopen motor drive
+       * \brief  Start the drive node and configures Torque control in CANopen motor drive (through SDO writes)
        *
        * NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
        *           https://www.can-cia.org/can-knowledge/canopen/cia402/
        */
-    std::vector<std::string> generateTorqueControlConfigSDO();
+    int sendTorqueControlConfigSDO();
 
-    /**
-     * \brief Send a list (vector) of properly formatted SDO Messages
-     *
-     * \return int -number_of_unsuccesfull messages (0 means OK for all). vcan will always return 0 (no reply check).
-     */
-    int sendSDOMessages(std::vector<std::string> messages);
 
 
     /**
@@ -258,6 +302,28 @@ class Drive {
         {3, {TARGET_VEL}},
         {4, {TARGET_TOR}}};
 
+    /**
+     * \brief Map between the TPDO Number and their transmission type on the drive (0x01: every SYNC, 0xFF: event driven)
+     *
+     */
+    std::map<UNSIGNED8, UNSIGNED8> TPDO_TransmissionType = {
+        {1, 0xFF},
+        {2, 0x01},
+        {3, 0x01},
+        {4, 0xFF}};
+
+    /**
+     * \brief Map between the RPDO Number and the transmission type of the equivalent master TPDO
+     *        (0xFF: sent when changed, at the end of the control loop period, N: sent every N SYNC).
+     *        RPDOs are always applied by the drive as soon as received.
+     *
+     */
+    std::map<UNSIGNED8, UNSIGNED8> RPDO_TransmissionType = {
+        {1, 0xFF},
+        {2, 0xFF},
+        {3, 0xFF},
+        {4, 0xFF}};
+
     /**
      * \brief Map between the RPDO Number and their base COB-ID (actualy is base COB-ID + Node_ID)
      *
@@ -345,6 +411,98 @@ class Drive {
     INTEGER16 targetTor=0;
     UNSIGNED16 digitalIn=0;
     UNSIGNED16 digitalOut=0;
+
+    /**
+     * \brief Drive values published by the CAN thread (published) and copy used by the control thread (snapshot).
+     *        published is padded on both sides: the lines written by the CAN thread are not shared with other members
+     *        (C++14 new does not honour over-aligned types, so alignas would not guarantee it).
+     *
+     */
+    char publishedPadBefore[DRIVE_CACHE_LINE];
+    DriveSnapshot published;
+    char publishedPadAfter[DRIVE_CACHE_LINE];
+    DriveSnapshot snapshot;
+    uint32_t previousRxCount[DRIVE_SNAPSHOT_RPDOS] = {0};  //!< snapshot.rxCount of the previous updateSnapshots(), for isFresh()
+    bool syncResponse[DRIVE_SNAPSHOT_RPDOS] = {false};      //!< RPDOs the drive sends on every SYNC (drive TPDO transmission type 1)
+    uint32_t syncResponseRxCount[DRIVE_SNAPSHOT_RPDOS] = {0};  //!< Their messages count when the last SYNC was sent (see markSyncResponses())
+
+    /**
+     * \brief Index in rpdos (and DriveSnapshot rxCount, rxTimestamp) of the RPDO an entry is mapped on, -1 if none
+     *
+     */
+    int rpdoIndex(OD_Entry_t entry);
+
+    /**
+     * \brief All existing drives and sequence counter of the seqlock protecting their published snapshots (odd while writing)
+     *
+     * Fixed array (never reallocated): slots are filled (or cleared on destruction) under the OD lock, which
+     * publishSnapshots() holds, and read lock-free by updateSnapshots(). Empty slots are NULL.
+     */
+    static std::atomic<Drive *> instances[DRIVE_MAX_INSTANCES];
+    static std::atomic<unsigned int> instancesCount;
+    static std::atomic<uint32_t> snapshotSeq;
+
+    /**
+     * \brief Registers this drive in instances (constructors)
+     *
+     */
+    void registerInstance();
+
+    /**
+     * \brief PDO configuration options at startup (see setPDOFastStart()) and whether this drive PDOs configuration was changed
+     *
+     */
+    static bool pdoFastStart;
+    static bool pdoSave;
+    bool pdoConfigChanged = false;
+
+    /**
+     * \brief PDOs mappings set by setPDOMapping(), by node ID (0: all drives), and whether it was applied to this drive
+     *
+     */
+    static std::map<int, DrivePDOMapping> pdoMappings;
+    static bool pdoPacking;
+    bool pdoMappingApplied = false;
+
+    /**
+     * \brief Replaces the default PDOs mapping of the drive by the one set with setPDOMapping(), if any, and packs
+     * it if enabled (setPDOPacking()). Done once: called by configureMasterPDOs() and initPDOs().
+     *
+     * \return false if the mapping set is not valid for this drive (default mapping kept)
+     */
+    bool applyPDOMapping();
+
+    /**
+     * \brief Uses a PDOs mapping if valid for this drive (PDO numbers, mappable objects, at most 8 bytes per PDO)
+     *
+     */
+    bool usePDOMapping(const DrivePDOMapping &mapping);
+
+    /**
+     * \brief Merges the mapped objects of PDOs with the same transmission type into as few 8 bytes PDOs as possible
+     * (first fit decreasing, using OD_DataSize). The PDOs are renumbered from 1.
+     *
+     * \param mappedObjects PDOs mapped objects (TPDO_MappedObjects or RPDO_MappedObjects)
+     * \param transmissionTypes PDOs transmission types (TPDO_TransmissionType or RPDO_TransmissionType)
+     * \param defaultType Transmission type of a PDO without one in transmissionTypes
+     * \param promoteEventDriven Event driven objects can be mapped on the synchronous PDOs (room left)
+     * \return true if the PDOs were packed (fewer PDOs), false if left unchanged
+     */
+    bool packPDOs(std::map<UNSIGNED8, std::vector<OD_Entry_t>> &mappedObjects, std::map<UNSIGNED8, UNSIGNED8> &transmissionTypes, UNSIGNED8 defaultType, bool promoteEventDriven);
+
+    /**
+     * \brief Disables a PDO on the drive (through SDO write), if not already disabled with PDO fast start
+     *
+     */
+    int disablePDO(UNSIGNED16 commIndex, int COB_ID);
+
+    /**
+     * \brief Value of a PDO mapping parameter entry for an OD entry (index, sub-index, length in bits)
+     *
+     */
+    UNSIGNED32 pdoMappingEntry(OD_Entry_t item) {
+        return OD_Addresses[item][0] * 0x10000 + OD_Addresses[item][1] * 0x100 + OD_DataSize[item] * 8;
+    }
     /**
      * \brief Current error state of the drive
      *
@@ -383,6 +541,64 @@ class Drive {
        */
     virtual ~Drive();
 
+    /**
+       * \brief Publishes the values received from all drives (status, position, velocity...) for the control thread.
+       *
+       * Must be called from the CAN thread, with OD locked, after RPDOs processing. Never blocks.
+       */
+    static void publishSnapshots();
+
+    /**
+       * \brief Copies the last published values of all drives into their snapshot, which is used by getPos(), getVel()...
+       *
+       * Lock-free (seqlock): all drives values come from the same SYNC period. Called by Robot::updateRobot().
+       */
+    static void updateSnapshots();
+
+    /**
+       * \brief Records the messages count of the RPDOs all drives send on every SYNC, when a SYNC is sent: see
+       * syncResponsesReceived().
+       *
+       * Must be called from the CAN thread, with OD locked.
+       * \return Number of RPDOs expected in response to the SYNC
+       */
+    static unsigned int markSyncResponses();
+
+    /**
+       * \brief Whether all the RPDOs expected in response to the last SYNC (see markSyncResponses()) were received and
+       * processed.
+       *
+       * Must be called from the CAN thread, with OD locked, after RPDOs processing.
+       */
+    static bool syncResponsesReceived();
+
+    /**
+       * \brief Sets how the PDOs of all drives are configured by initPDOs(). Default: every PDO is written, nothing is saved.
+       *
+       * \param fastStart Read back the PDOs configuration of the drive and only write what differs from the expected one
+       * (a drive already holding the configuration, e.g. since the last run, is not reconfigured)
+       * \param save Save the communication parameters of the drive (0x1010 sub 2) when its PDOs configuration was written,
+       * so that the configuration survives a power cycle of the drive and the next start is fast
+       */
+    static void setPDOFastStart(bool fastStart, bool save = false);
+
+    /**
+       * \brief Sets the PDOs mapping (mapped objects and transmission types) used instead of the default one
+       * (TPDO_MappedObjects, RPDO_MappedObjects...) by configureMasterPDOs() and initPDOs(). To call before these.
+       *
+       * \param nodeID Node ID of the drive, 0 for all drives (a drive specific mapping has precedence)
+       * \param mapping The PDOs mapping: only the mapped PDOs are configured (on the drive and in CORC)
+       */
+    static void setPDOMapping(int nodeID, const DrivePDOMapping &mapping);
+
+    /**
+       * \brief Enables the automatic packing of the PDOs mapping of all drives: the objects mapped on PDOs with the same
+       * transmission type are merged into fewer PDOs (up to 8 bytes each), and the event driven objects received from
+       * the drive fill the room left in its synchronous PDOs. Fewer frames for the same values. To call before
+       * configureMasterPDOs() and initPDOs().
+       */
+    static void setPDOPacking(bool packing);
+
     /**
        * \brief Initialises the drive (SDO start message)
        *
@@ -420,21 +636,31 @@ class Drive {
     virtual bool setDigitalOut(int digital_out);
 
     /**
-           * \brief Initialises a standard set of PDOs for the use of the drive. These are:
+           * \brief Initialises the PDOs of the drive (through SDO writes): each PDO of TPDO_MappedObjects and RPDO_MappedObjects,
+           * with its transmission type. PDOs not mapped are disabled. The default mapping is:
            *
            *   TPDO1: COB-ID 180+{NODE-ID}: Status Word (0x6041), Send on Internal Event Trigger
            *   TPDO2: COB-ID 280+{NODE-ID}: Actual Position (0x6064), Actual Velocity (0x606C), Sent every SYNC Message
-           *   TPDO3: COB-ID 380+{NODE-ID}: Actual Torque (0x607C), Sent every SYNC MEssage
+           *   TPDO3: COB-ID 380+{NODE-ID}: Actual Torque (0x6077), Sent every SYNC MEssage
+           *   TPDO4: COB-ID 480+{NODE-ID}: Digital Inputs (0x60FD), Send on Internal Event Trigger
+           *
+           *   RPDO1: COB-ID 200+{NODE-ID}: Control Word (0x6040), Digital Outputs (0x60FE), Applied immediately when received
+           *   RPDO2: COB-ID 300+{NODE-ID}: Target Position (0x607A), Applied immediately when received
+           *   RPDO3: COB-ID 400+{NODE-ID}: Target Velocity (0x60FF), Applied immediately when received
+           *   RPDO4: COB-ID 500+{NODE-ID}: Target Torque (0x6071), Applied immediately when received
            *
-           *   RPDO3: COB-ID 300+{NODE-ID}: Target Position (0x607A), Applied immediately when received
-           *   RPDO4: COB-ID 400+{NODE-ID}: Target Velocity (0x60FF), Applied immediately when received
-           *   RPDO5: COB-ID 500+{NODE-ID}: Target Torque (0x6071), Applied immediately when received
+           * and can be changed with setPDOMapping() (e.g. from the robot YAML file).
            *
            * \return true
            * \return false
            */
     virtual bool initPDOs();
 
+    /**
+           * \brief Creates the master (CORC side) PDOs equivalent to the mapped PDOs of the drive
+           *
+           * \return true
+           */
     bool configureMasterPDOs();
 
     /**
@@ -479,6 +705,19 @@ class Drive {
            */
     virtual bool initTorqueControl() { return false; };
 
+    /**
+           * Asynchronous versions of initPosControl(), initVelControl() and initTorqueControl(): the SDOs are issued by the
+           * SDO worker thread (see SDOWorker.h). For a control mode change from the control loop, which polls the result
+           * (e.g. result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) instead of blocking on the bus.
+           *
+           * \return The result of the init*Control() call once completed
+           */
+    std::future<bool> initPosControlAsync(motorProfile posControlMotorProfile);
+    std::future<bool> initPosControlAsync();
+    std::future<bool> initVelControlAsync(motorProfile velControlMotorProfile);
+    std::future<bool> initVelControlAsync();
+    std::future<bool> initTorqueControlAsync();
+
     /**
            * Updates the internal representation of the state of the drive
            *
@@ -486,6 +725,15 @@ class Drive {
            */
     virtual int getStatus();
 
+    /**
+           * Returns the last status word (0x6041) received from the drive, read directly (OD locked) instead of from the
+           * snapshot of the last robot update. For blocking code waiting on the drive outside of the control loop
+           * updates (e.g. enabling the drives at initialisation).
+           *
+           * \return The last received value of the status word (0x6041)
+           */
+    int readStatus();
+
     /**
            * Writes the desired position to the Target Position of the motor drive (0x607A)
            *
@@ -517,6 +765,14 @@ class Drive {
            */
     virtual int getPos();
 
+    /**
+           * Returns the last position (0x6064) received from the drive, read directly (OD locked) instead of from the
+           * snapshot of the last robot update (see readStatus()).
+           *
+           * \return The last received position from the motor drive
+           */
+    int readPos();
+
     /**
            * Returns the current velocity from the motor drive (0x606C)
            * Returns 0 if NODEID is 5 or 6: ankles. They have no OD entry.
@@ -537,6 +793,31 @@ class Drive {
            */
     virtual int getDigitalIn();
 
+    /**
+           * Returns the kernel receive time of the last value of an entry sent by the drive (e.g. ACTUAL_POS).
+           * Can be compared to clock_gettime(CLOCK_MONOTONIC) to get the age of the value.
+           * \return Receive time in ns (CLOCK_MONOTONIC), 0 if entry is not mapped or not received yet
+           */
+    virtual uint64_t getRxTimestamp(OD_Entry_t entry);
+
+    /**
+           * \brief Whether a new value of an entry (e.g. ACTUAL_POS) has been received since the previous
+           * control loop update (Robot::updateRobot()). Mapped values of a drive which stopped transmitting are not fresh.
+           * \return true if received, false otherwise or if the entry is not mapped
+           */
+    virtual bool isFresh(OD_Entry_t entry);
+
+    /**
+           * \brief Whether any value has been received from the drive since the previous control loop update: false for a silent drive
+           */
+    virtual bool isFresh();
+
+    /**
+           * \brief Age of the value of an entry used by the control loop (snapshot of the last update): time since its reception
+           * \return Age in s, -1 if the entry is not mapped or not received yet
+           */
+    virtual double age(OD_Entry_t entry = ACTUAL_POS);
+
     // Drive State Modifiers
     /**
            * \brief Clears errors (and changes the state of the drive to "disabled".
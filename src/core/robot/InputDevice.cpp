@@ -7,4 +7,35 @@ InputDevice::InputDevice() {
 
 InputDevice::~InputDevice() {
     // Does nothing
-}
\ No newline at end of file
+}
+
+void InputDevice::trackRPDO(RPDO *rpdo) {
+    trackedRPDOs.push_back(rpdo);
+    rxCounts.push_back(rpdo->getRxCount());
+}
+
+void InputDevice::updateFreshness() {
+    fresh = true;
+    for (unsigned int i = 0; i < trackedRPDOs.size(); i++) {
+        uint32_t count = trackedRPDOs[i]->getRxCount();
+        fresh &= (count != rxCounts[i]);
+        rxCounts[i] = count;
+    }
+}
+
+double InputDevice::age() {
+    uint64_t oldest = UINT64_MAX;
+    for (auto rpdo : trackedRPDOs) {
+        uint64_t t = rpdo->getTimestamp();
+        oldest = t < oldest ? t : oldest;
+    }
+    if (oldest == UINT64_MAX) {
+        return 0;
+    }
+    if (oldest == 0) {
+        return -1;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000 + now.tv_nsec - (int64_t)oldest) / 1e9;
+}
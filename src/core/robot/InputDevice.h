@@ -15,6 +15,7 @@
 #ifndef InputDevice_H_INCLUDED
 #define InputDevice_H_INCLUDED
 #include <iostream>
+#include <vector>
 
 #include "logging.h"
 #include "RPDO.h"
@@ -38,5 +39,37 @@ class InputDevice {
     virtual void updateInput() = 0;
 
     virtual bool configureMasterPDOs() =0;
+
+    /**
+     * @brief Updates the reception state of the RPDOs tracked with trackRPDO(). Called by Robot::updateRobot() before updateInput().
+     *
+     */
+    void updateFreshness();
+
+    /**
+     * @brief Whether a new message has been received on every tracked RPDO since the previous update (i.e. a complete new reading).
+     * Always true for devices without tracked RPDO (not read through CAN).
+     *
+     */
+    bool isFresh() { return fresh; }
+
+    /**
+     * @brief Time since the reception of the oldest of the last messages of the tracked RPDOs, in s.
+     * -1 if not all received yet, 0 for devices without tracked RPDO.
+     *
+     */
+    double age();
+
+   protected:
+    /**
+     * @brief Tracks the reception of an RPDO of the device (for isFresh() and age()). To call in configureMasterPDOs().
+     *
+     */
+    void trackRPDO(RPDO *rpdo);
+
+   private:
+    std::vector<RPDO *> trackedRPDOs;
+    std::vector<uint32_t> rxCounts;  //!< Messages count of the tracked RPDOs at the last update
+    bool fresh = true;
 };
 #endif
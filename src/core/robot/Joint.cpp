@@ -171,7 +171,7 @@ setMovementReturnCode_t Joint::setTorque(double torque) {
 
 // Updating functions to access joint-level commands
 void Joint::setPositionOffset(double qcalib = 0) {
-    q0 = driveUnitToJointPosition(drive->getPos()) - qcalib;
+    q0 = driveUnitToJointPosition(drive->readPos()) - qcalib;
     calibrated = true;
 }
 
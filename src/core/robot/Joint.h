@@ -92,10 +92,11 @@ class Joint {
     Drive *drive;
 
     /**
-      * \brief The current mode of the drive (if actuated joint)
+      * \brief The current mode of the drive (if actuated joint). Atomic: set by setMode(), possibly on the SDO worker
+      * thread (see Robot::switchControlMode()), while read by the control thread.
       *
       */
-    ControlMode driveMode = CM_UNCONFIGURED;
+    std::atomic<ControlMode> driveMode{CM_UNCONFIGURED};
 
     /**
      * @brief Indicates whether a calibration has been performed on this joint yet.
@@ -398,11 +399,19 @@ class Joint {
     void setPositionOffset(double qcalib);
 
     /**
-     * \brief get the drive status word value
+     * \brief get the drive status word value, as last received (see Drive::readStatus()): can be polled while waiting
+     * for the drive, without robot update
      *
      * \return int The current status word of the drive
      */
-    int getDriveStatus() { return drive->getStatus(); }
+    int getDriveStatus() { return drive->readStatus(); }
+
+    /**
+     * \brief Whether a new position has been received from the drive since the previous robot update (see Drive::isFresh()).
+     * Always true for non actuated joints.
+     *
+     */
+    bool isFresh() { return !actuated || drive == NULL || drive->isFresh(ACTUAL_POS); }
 
     /**
          * \brief Start the associated drive CAN node (will start produce PDOs)
@@ -1,7 +1,54 @@
 #include "Robot.h"
 
+#include <chrono>
+
+#include "SDO.h"
+#include "SDOWorker.h"
+#include "StartupTrace.h"
+
 short int sign(double val) { return (val > 0) ? 1 : ((val < 0) ? -1 : 0); }
 
+namespace {
+/**
+ * \brief Reads a list of drive PDOs (tpdo or rpdo of a pdo_mapping entry): PDO number is the position in the list.
+ * Each PDO is {objects: [OD entries names], sync: SYNC divider (0: event driven / when changed)}.
+ */
+bool loadPDOList(const YAML::Node &list, std::map<UNSIGNED8, std::vector<OD_Entry_t>> &mappedObjects, std::map<UNSIGNED8, UNSIGNED8> &transmissionTypes) {
+    const std::map<std::string, OD_Entry_t> entries = {
+        {"STATUS_WORD", STATUS_WORD}, {"ERROR_WORD", ERROR_WORD}, {"ACTUAL_POS", ACTUAL_POS}, {"ACTUAL_VEL", ACTUAL_VEL},
+        {"ACTUAL_TOR", ACTUAL_TOR}, {"DIGITAL_IN", DIGITAL_IN}, {"CONTROL_WORD", CONTROL_WORD}, {"TARGET_POS", TARGET_POS},
+        {"TARGET_VEL", TARGET_VEL}, {"TARGET_TOR", TARGET_TOR}, {"DIGITAL_OUT", DIGITAL_OUT}};
+    if (!list.IsSequence()) {
+        return false;
+    }
+    for (unsigned int n = 0; n < list.size(); n++) {
+        if (!list[n]["objects"] || !list[n]["objects"].IsSequence()) {
+            return false;
+        }
+        std::vector<OD_Entry_t> items;
+        for (auto name : list[n]["objects"]) {
+            auto e = entries.find(name.as<std::string>());
+            if (e == entries.end()) {
+                spdlog::error("pdo_mapping: unknown OD entry {}", name.as<std::string>());
+                return false;
+            }
+            items.push_back(e->second);
+        }
+        int sync = list[n]["sync"] ? list[n]["sync"].as<int>() : 0;
+        if (sync < 0 || sync > 240) {
+            spdlog::error("pdo_mapping: invalid sync divider {} (0 to 240)", sync);
+            return false;
+        }
+        // Empty PDO: not used
+        if (items.size() > 0) {
+            mappedObjects[n + 1] = items;
+            transmissionTypes[n + 1] = (sync == 0) ? 0xFF : sync;
+        }
+    }
+    return true;
+}
+}  // namespace
+
 Robot::Robot(std::string robot_name, std::string yaml_config_file): robotName(robot_name) {
     spdlog::debug("Robot ({}) object created", robotName);
 }
@@ -27,6 +74,29 @@ bool Robot::initialiseFromYAML(std::string yaml_config_file) {
             }
             else {
                 spdlog::info("Loading robot parameters from {}.", baseDirectory + relativeFilePath + yaml_config_file);
+                //Drives PDOs configuration at startup (common to all robots)
+                if(params[robotName]["pdo_fast_start"]) {
+                    bool save = params[robotName]["pdo_save"] && params[robotName]["pdo_save"].as<bool>();
+                    Drive::setPDOFastStart(params[robotName]["pdo_fast_start"].as<bool>(), save);
+                }
+                if(params[robotName]["pdo_packing"]) {
+                    Drive::setPDOPacking(params[robotName]["pdo_packing"].as<bool>());
+                }
+                //Drives PDOs mapping: 'drives' for all drives, 'drive_<node ID>' for a specific one
+                if(params[robotName]["pdo_mapping"]) {
+                    for (auto d : params[robotName]["pdo_mapping"]) {
+                        std::string name = d.first.as<std::string>();
+                        int nodeID = (name == "drives") ? 0 : (name.compare(0, 6, "drive_") == 0 ? atoi(name.c_str() + 6) : -1);
+                        DrivePDOMapping mapping;
+                        if (nodeID < 0 || !d.second["tpdo"] || !d.second["rpdo"] ||
+                            !loadPDOList(d.second["tpdo"], mapping.TPDO_MappedObjects, mapping.TPDO_TransmissionType) ||
+                            !loadPDOList(d.second["rpdo"], mapping.RPDO_MappedObjects, mapping.RPDO_TransmissionType)) {
+                            spdlog::error("Invalid pdo_mapping {}: default drives PDO mapping used.", name);
+                            continue;
+                        }
+                        Drive::setPDOMapping(nodeID, mapping);
+                    }
+                }
                 //Attempt to load parameters from YAML file (delegated to each custom robot implementation)
                 return loadParametersFromYAML(params);
             }
@@ -43,15 +113,91 @@ bool Robot::initialiseFromYAML(std::string yaml_config_file) {
 }
 
 bool Robot::initialise() {
+    // Start the SDO worker now rather than on a first control mode change from the control loop
+    SDOWorker::instance();
+
+    StartupSpan span("Robot::initialiseNetwork");
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
     if (initialiseNetwork()) {
+        spdlog::info("Network initialised in {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count());
         return true;
     }
     return false;
 }
 
 
+ControlModeTransition Robot::switchControlMode(ControlMode mode, double retryDelay) {
+    if (controlModeStep == CMS_FAILED && retryDelay >= 0 &&
+        std::chrono::steady_clock::now() - controlModeFailureTime >= std::chrono::duration<double>(retryDelay)) {
+        spdlog::warn("Retrying control mode {} configuration", mode);
+        controlModeStep = CMS_IDLE;
+    }
+    switch (controlModeStep) {
+        case CMS_IDLE:
+            if (mode == controlModeActive) {
+                return CMT_DONE;
+            }
+            spdlog::debug("Switching control mode to {} (non-blocking)", mode);
+            controlModeRequested = mode;
+            controlModeActive = CM_UNCONFIGURED;
+            controlModeConfigured = SDOWorker::instance().submit([this, mode] { return configureControlMode(mode); });
+            controlModeStep = CMS_CONFIGURING;
+            return CMT_PENDING;
+
+        case CMS_CONFIGURING:
+            if (controlModeConfigured.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return CMT_PENDING;
+            }
+            if (!controlModeConfigured.get()) {
+                spdlog::error("Failed to configure control mode {}", controlModeRequested);
+                controlModeFailureTime = std::chrono::steady_clock::now();
+                controlModeStep = CMS_FAILED;
+                return CMT_FAILED;
+            }
+            for (auto p : joints) {
+                p->readyToSwitchOn();
+            }
+            controlModeSwitchOnTime = std::chrono::steady_clock::now();
+            controlModeStep = CMS_SWITCHING_ON;
+            return CMT_PENDING;
+
+        case CMS_SWITCHING_ON:
+            // Let the switch on command go before enabling
+            if (std::chrono::steady_clock::now() - controlModeSwitchOnTime < std::chrono::milliseconds(10)) {
+                return CMT_PENDING;
+            }
+            for (auto p : joints) {
+                p->enable();
+            }
+            controlModeStep = CMS_IDLE;
+            controlModeActive = controlModeRequested;
+            controlModeSwitched(controlModeRequested);
+            return (mode == controlModeRequested) ? CMT_DONE : CMT_PENDING;
+
+        case CMS_FAILED:
+            return CMT_FAILED;
+    }
+    return CMT_FAILED;
+}
+
+void Robot::clearControlModeFailure() {
+    if (controlModeStep == CMS_FAILED) {
+        controlModeStep = CMS_IDLE;
+    }
+}
+
+bool Robot::configureControlMode(ControlMode mode) {
+    std::vector<std::function<bool()>> sequences;
+    for (auto p : joints) {
+        sequences.push_back([p, mode] { return p->setMode(mode) == mode; });
+    }
+    return sdoRunParallel(sequences);
+}
+
+
 bool Robot::disable() {
     spdlog::info("Disabling robot...");
+    controlModeActive = CM_UNCONFIGURED;
     for (auto p : joints) {
         p->disable();
     }
@@ -60,13 +206,27 @@ bool Robot::disable() {
 
 void Robot::updateRobot() {
 
+    //Get a coherent copy of the latest values published by all drives
+    Drive::updateSnapshots();
+
     //Retrieve latest values from hardware
     for (auto joint : joints)
         joint->updateValue();
     for (auto input : inputs ){
+        input->updateFreshness();
         input->updateInput();
     }
 
+    //Which joints and inputs received new values this period
+    jointsFreshMask_ = 0;
+    for (unsigned int i = 0; i < joints.size() && i < 64; i++) {
+        jointsFreshMask_ |= (uint64_t)joints[i]->isFresh() << i;
+    }
+    inputsFreshMask_ = 0;
+    for (unsigned int i = 0; i < inputs.size() && i < 64; i++) {
+        inputsFreshMask_ |= (uint64_t)inputs[i]->isFresh() << i;
+    }
+
     //Update local copies of joint values
     if((unsigned int)jointPositions_.size()!=joints.size()) {
         jointPositions_ = Eigen::VectorXd::Zero(joints.size());
@@ -116,6 +276,14 @@ Eigen::VectorXd& Robot::getVelocity() {
     return jointVelocities_;
 }
 
+bool Robot::allFresh() {
+    unsigned int nJoints = joints.size() < 64 ? joints.size() : 64;
+    unsigned int nInputs = inputs.size() < 64 ? inputs.size() : 64;
+    uint64_t allJoints = nJoints == 64 ? UINT64_MAX : ((uint64_t)1 << nJoints) - 1;
+    uint64_t allInputs = nInputs == 64 ? UINT64_MAX : ((uint64_t)1 << nInputs) - 1;
+    return jointsFreshMask_ == allJoints && inputsFreshMask_ == allInputs;
+}
+
 Eigen::VectorXd& Robot::getTorque() {
     //Initialise vector if not already done
     if((unsigned int)jointTorques_.size()!=joints.size()) {
@@ -20,6 +20,8 @@
  */
 #ifndef ROBOT_H_INCLUDED
 #define ROBOT_H_INCLUDED
+#include <chrono>
+#include <future>
 #include <vector>
 #define EIGEN_RUNTIME_NO_MALLOC //! Flag preventing Eigen to do dynaic allocation (can be bad in RT). See https://github.com/stulp/tutorials/blob/master/test.md for details.
 #include <Eigen/Dense>
@@ -37,6 +39,16 @@
 
 short int sign(double val);
 
+/**
+ * \brief Progress of a non-blocking control mode change, see Robot::switchControlMode()
+ *
+ */
+enum ControlModeTransition {
+    CMT_PENDING = 0, /*!< Drives being configured (SDOs on the SDO worker thread) or switched on */
+    CMT_DONE = 1,    /*!< Joints enabled in the requested mode */
+    CMT_FAILED = -1  /*!< Drives configuration failed (error logged), until clearControlModeFailure() */
+};
+
 /**
  * @ingroup Robot
  * \brief Abstract Class representing a robot. Includes vectors of Joint and InputDevice.
@@ -56,10 +68,21 @@ class Robot {
     std::vector<Joint *> joints;
     std::vector<InputDevice *> inputs;
 
+    /** Non-blocking control mode change state (see switchControlMode()) */
+    enum { CMS_IDLE, CMS_CONFIGURING, CMS_SWITCHING_ON, CMS_FAILED } controlModeStep = CMS_IDLE;
+    ControlMode controlModeRequested = CM_UNCONFIGURED;
+    ControlMode controlModeActive = CM_UNCONFIGURED; //!< Mode last enabled by switchControlMode(), reset by disable()
+    std::future<bool> controlModeConfigured;
+    std::chrono::steady_clock::time_point controlModeSwitchOnTime;
+    std::chrono::steady_clock::time_point controlModeFailureTime;
+
     Eigen::VectorXd jointPositions_;
     Eigen::VectorXd jointVelocities_;
     Eigen::VectorXd jointTorques_;
 
+    uint64_t jointsFreshMask_ = 0;
+    uint64_t inputsFreshMask_ = 0;
+
    public:
     /** @name Constructors and Destructors */
     //@{
@@ -173,6 +196,29 @@ class Robot {
     */
     Eigen::VectorXd& getTorque();
 
+    /**
+    * \brief Joints which received new values during the last control period, as of the last updateRobot()
+    * (see Joint::isFresh()): bit i for joints[i] (first 64 joints). Allows to skip computations when nothing new
+    * arrived, or to detect a silent drive within one period.
+    *
+    * \return uint64_t the freshness mask
+    */
+    uint64_t getJointsFreshMask() { return jointsFreshMask_; }
+
+    /**
+    * \brief Input devices which received a complete new reading during the last control period (see InputDevice::isFresh()):
+    * bit i for inputs[i] (first 64 inputs)
+    *
+    * \return uint64_t the freshness mask
+    */
+    uint64_t getInputsFreshMask() { return inputsFreshMask_; }
+
+    /**
+    * \brief Whether all joints and inputs received new values during the last control period
+    *
+    */
+    bool allFresh();
+
     /**
     * \brief print out status of robot and all of its joints
     *
@@ -212,6 +258,49 @@ class Robot {
     */
     virtual bool initTorqueControl() { return false; };
 
+    /**
+    * @brief Non-blocking change of control mode, to use from the control loop (state entry()/during()) instead of
+    * initPositionControl(), initVelocityControl() or initTorqueControl() which block on the drives SDOs.
+    *
+    * The first call starts the drives configuration (configureControlMode() on the SDO worker thread), the following
+    * calls advance the transition: joints are set ready to switch on once configured, and enabled 10ms later.
+    * Call it every iteration until it returns CMT_DONE or CMT_FAILED. A transition to another mode still
+    * pending is completed first. Once enabled, calls with the same mode return CMT_DONE straight away (no SDO), so
+    * it can be called on every iteration. Only the changes made through this method are tracked: mixing it with
+    * the blocking init*Control() methods is not supported.
+    *
+    * A failed configuration is not retried by default: CMT_FAILED is returned, for any mode, until
+    * clearControlModeFailure(), or until retryDelay passed if given.
+    *
+    * @param mode Requested control mode
+    * @param retryDelay Time after which a failed configuration is attempted again (s, logged), negative for never
+    * @return ControlModeTransition CMT_PENDING until the joints are enabled in this mode
+    */
+    ControlModeTransition switchControlMode(ControlMode mode, double retryDelay = -1);
+
+    /**
+    * @brief Clears a failed control mode change (see switchControlMode()), so that the next switchControlMode() call
+    * configures the drives again.
+    */
+    void clearControlModeFailure();
+
+   protected:
+    /**
+    * @brief Configure the drives of all joints for a control mode (blocking SDOs). Called by switchControlMode()
+    * on the SDO worker thread. Default sets the mode of each joint (Joint::setMode(mode)), all joints concurrently.
+    *
+    * @return true If successful
+    * @return false If unsuccesful
+    */
+    virtual bool configureControlMode(ControlMode mode);
+
+    /**
+    * @brief Called by switchControlMode() (control thread) once the joints are enabled in the new mode. Default does nothing.
+    */
+    virtual void controlModeSwitched(ControlMode mode) {};
+
+   public:
+
     /**
     * @brief Set the target positions for each of the joints
     *
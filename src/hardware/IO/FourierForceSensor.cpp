@@ -14,6 +14,7 @@ bool FourierForceSensor::configureMasterPDOs() {
                            (void *)&rawData[1],};
 
     rpdo = new RPDO(0x180+sensorNodeID, 0xff, dataEntry, dataSize, 2);
+    trackRPDO(rpdo);
 
     return true;
 }
@@ -64,16 +65,10 @@ bool FourierForceSensor::sendInternalCalibrateSDOMessage() {
 
     spdlog::debug("[FourierForceSensor::sendInternalCalibrateSDOMessage]: Force Sensor with nodeID {} Internal calibration", sensorNodeID);
 
-    std::stringstream sstream;
-    char returnMessage[STRING_BUFFER_SIZE];
-
-    sstream << "[1] " << sensorNodeID << " read 0x7050 255 i8";
-    std::string strCommand = sstream.str();
-    char *SDO_Message = (char *)(strCommand.c_str());
-    cancomm_socketFree(SDO_Message, returnMessage);
-    std::string retMsg = returnMessage;
-    spdlog::debug(retMsg);
-    if (retMsg.find("ERROR") != std::string::npos) {
+    // Reading this object triggers the calibration: its value (and length) does not matter
+    UNSIGNED8 data[8];
+    UNSIGNED32 length = 0;
+    if (sdoUpload(sensorNodeID, 0x7050, 255, data, sizeof(data), &length) != 0) {
         spdlog::error("[X2ForceSensor::calibrate]: Force Sensor {} error occured during zeroing", sensorNodeID);
         return false;
     }
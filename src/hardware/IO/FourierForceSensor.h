@@ -15,6 +15,7 @@
 #include "InputDevice.h"
 #include <CANopen.h>
 #include <CO_command.h>
+#include "SDO.h"
 #include <sstream>
 #include <numeric>
 
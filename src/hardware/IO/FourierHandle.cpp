@@ -14,6 +14,7 @@ bool FourierHandle::configureMasterPDOs() {
                           (void *)&rawData_[3],};
 
     rpdo_ = new RPDO(0x180+sensorNodeID_, 0xff, dataEntry, dataSize, 4);
+    trackRPDO(rpdo_);
 
     return true;
 }
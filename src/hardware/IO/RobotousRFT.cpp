@@ -47,6 +47,8 @@ bool RobotousRFT::configureMasterPDOs() {
                           (void *)&rawData[15]};
     rpdo1 = new RPDO(responseID1, 0xff, dataEntryH, dataSize, lengthData);
     rpdo2 = new RPDO(responseID2, 0xff, dataEntryL, dataSize, lengthData);
+    trackRPDO(rpdo1);
+    trackRPDO(rpdo2);
 
     return true;
 }
@@ -1,5 +1,7 @@
 #include "TechnaidIMU.h"
 
+#include "RTConfig.h"
+
 TechnaidIMU::TechnaidIMU(IMUParameters imuParameters)
         : canChannel_(imuParameters.canChannel),
           serialNo_(imuParameters.serialNo),
@@ -342,6 +344,8 @@ bool TechnaidIMU::checkCommunication() {
 
 void * TechnaidIMU::updateHelper(void *This) {
 
+    // Not a real-time task: do not inherit the policy and CPUs of the (control) thread which created it
+    applyNonRTThreadConfig("technaid_imu");
     ((TechnaidIMU *)This)->update();
     return NULL;
 
@@ -21,7 +21,7 @@ bool CopleyDrive::init() {
 bool CopleyDrive::initPosControl(motorProfile posControlMotorProfile) {
     spdlog::debug("Node     ID {} Initialising Position Control", NodeID);
 
-    sendSDOMessages(generatePosControlConfigSDO(posControlMotorProfile));
+    sendPosControlConfigSDO(posControlMotorProfile);
     /**
      * \todo Move jointMinMap and jointMaxMap to set additional parameters (bit 5 in 0x6041 makes updates happen immediately)
      *
@@ -36,62 +36,47 @@ bool CopleyDrive::initVelControl(motorProfile velControlMotorProfile) {
      * \todo Tune velocity loop gain index 0x2381 to optimize V control
      *
     */
-    sendSDOMessages(generateVelControlConfigSDO(velControlMotorProfile));
+    sendVelControlConfigSDO(velControlMotorProfile);
     return true;
 }
 
 bool CopleyDrive::initTorqueControl() {
     spdlog::debug("NodeID {} Initialising Torque Control", NodeID);
-    sendSDOMessages(generateTorqueControlConfigSDO());
+    sendTorqueControlConfigSDO();
 
     return true;
 }
 
-std::vector<std::string> CopleyDrive::generatePosControlConfigSDO(motorProfile positionProfile) {
-    return Drive::generatePosControlConfigSDO(positionProfile); /*<!execute base class function*/
+int CopleyDrive::sendPosControlConfigSDO(motorProfile positionProfile) {
+    return Drive::sendPosControlConfigSDO(positionProfile); /*<!execute base class function*/
 };
 
-std::vector<std::string> CopleyDrive::generateVelControlConfigSDO(motorProfile velocityProfile) {
-    return Drive::generateVelControlConfigSDO(velocityProfile); /*<!execute base class function*/
+int CopleyDrive::sendVelControlConfigSDO(motorProfile velocityProfile) {
+    return Drive::sendVelControlConfigSDO(velocityProfile); /*<!execute base class function*/
 };
 
-std::vector<std::string> CopleyDrive::generateTorqueControlConfigSDO() {
-    return Drive::generateTorqueControlConfigSDO(); /*<!execute base class function*/
+int CopleyDrive::sendTorqueControlConfigSDO() {
+    return Drive::sendTorqueControlConfigSDO(); /*<!execute base class function*/
 }
 
-std::vector<std::string> CopleyDrive::generatePositionOffsetSDO(int offset) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-
+int CopleyDrive::sendPositionOffsetSDO(int offset) {
     // set mode of operation
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 6";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 6);
     // set the home offset
-    sstream << "[1] " << NodeID << " write 0x607C 0 i32 "<< std::dec << offset;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x607C, 0, offset);
     // set homing method to 0
-    sstream << "[1] " << NodeID << " write 0X6098 0 i8 0";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6098, 0, 0);
     // set control word to start homing
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x0f";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x0f);
     // set control word to start homing
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x1f";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-    return CANCommands;
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x1f);
+    return ret;
 }
 
 bool CopleyDrive::setPositionOffset(int offset) {
     spdlog::debug("NodeID {} Setting Position Offset", NodeID);
 
-    sendSDOMessages(generatePositionOffsetSDO(offset));
+    sendPositionOffsetSDO(offset);
 
     return true;
 
@@ -101,14 +86,7 @@ bool CopleyDrive::setPositionOffset(int offset) {
 bool CopleyDrive::setTrackingWindow(INTEGER32 window) {
     spdlog::debug("NodeID {} Tracking Window", NodeID);
 
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-    sstream << "[1] " << NodeID << " write 0x2120 0 i32 " << std::dec << window;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    sendSDOMessages(CANCommands);
+    sdoWrite<INTEGER32>(NodeID, 0x2120, 0, window);
 
     return true;
 }
@@ -116,14 +94,7 @@ bool CopleyDrive::setTrackingWindow(INTEGER32 window) {
 bool CopleyDrive::setFaultMask(UNSIGNED32 mask) {
     spdlog::debug("NodeID {} Fault mask set to {0:x}", NodeID, mask);
 
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-    sstream << "[1] " << NodeID << " write 0x2182 0 i32 " << std::dec << mask;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    sendSDOMessages(CANCommands);
+    sdoWrite<INTEGER32>(NodeID, 0x2182, 0, mask);
 
     return true;
 }
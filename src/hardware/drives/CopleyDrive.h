@@ -74,7 +74,7 @@ class CopleyDrive : public Drive {
     bool initTorqueControl();
     /**
           * \brief Overloaded method from Drive, specifically for Copley Drive implementation.
-          *     Generates the list of commands required to configure Position control in CANopen motor drive
+          *     Configures (through SDO writes) Position control in CANopen motor drive
           *
           * /param Profile Velocity, value used by position mode motor trajectory generator.
           *            Units: 0.1 counts/sec
@@ -92,10 +92,10 @@ class CopleyDrive : public Drive {
           *
           */
 
-    std::vector<std::string> generatePosControlConfigSDO(motorProfile positionProfile);
+    int sendPosControlConfigSDO(motorProfile positionProfile);
     /**
           * \brief Overloaded method from Drive, specifically for Copley Drive implementation.
-          *     Generates the list of commands required to configure Velocity control in CANopen motor drive
+          *     Configures (through SDO writes) Velocity control in CANopen motor drive
           *
           * /param Profile Acceleration, value Velocity mode motor trajectory generator will attempt to achieve.
           *            Units: 10 counts/sec^2
@@ -109,25 +109,25 @@ class CopleyDrive : public Drive {
           *           https://www.can-cia.org/can-knowledge/canopen/cia402/
           *
           */
-    std::vector<std::string> generateVelControlConfigSDO(motorProfile velocityProfile);
+    int sendVelControlConfigSDO(motorProfile velocityProfile);
     /**
           * \brief Overloaded method from Drive, specifically for Copley Drive implementation.
-          *     Generates the list of commands required to configure Torque control in CANopen motor drive
+          *     Configures (through SDO writes) Torque control in CANopen motor drive
           *
           *    NOTE: More details on params and profiles can be found in the CANopne CiA 402 series specifications:
           *           https://www.can-cia.org/can-knowledge/canopen/cia402/
           *
           */
-    std::vector<std::string> generateTorqueControlConfigSDO();
+    int sendTorqueControlConfigSDO();
 
     /**
-          * \brief Generates the SDO commands to set the current position as offset
+          * \brief Sends the SDO writes setting the current position as offset
           *
           * /param offset, joint position value to be at the homing position [encoder count]
           *
           *
           */
-    std::vector<std::string> generatePositionOffsetSDO(int offset);
+    int sendPositionOffsetSDO(int offset);
 
     /**
           * \brief Set the current position as offset
@@ -13,6 +13,7 @@ KincoDrive::KincoDrive(int NodeID, bool with_DIO_config) : Drive::Drive(NodeID)
     if(with_DIO_config) {
         OD_Addresses[DIGITAL_IN] = {0x2010, 0x0A};
         OD_Addresses[DIGITAL_OUT] = {0x2010, 0x0E};
+        TPDO_TransmissionType[4] = 0x01;
     }
     //Remove any DIO configuration
     else {
@@ -65,7 +66,7 @@ bool KincoDrive::posControlConfirmSP() {
 bool KincoDrive::initPosControl(motorProfile posControlMotorProfile) {
     spdlog::debug("NodeID {} Initialising Position Control", NodeID);
 
-    sendSDOMessages(generatePosControlConfigSDO(posControlMotorProfile));
+    sendPosControlConfigSDO(posControlMotorProfile);
     /**
      * \todo Move jointMinMap and jointMaxMap to set additional parameters (bit 5 in 0x6041 makes updates happen immediately)
      *
@@ -75,7 +76,7 @@ bool KincoDrive::initPosControl(motorProfile posControlMotorProfile) {
 bool KincoDrive::initPosControl() {
     spdlog::debug("NodeID {} Initialising Position Control", NodeID);
 
-    sendSDOMessages(Drive::generatePosControlConfigSDO());
+    Drive::sendPosControlConfigSDO();
     return true;
 }
 bool KincoDrive::initVelControl(motorProfile velControlMotorProfile) {
@@ -86,7 +87,7 @@ bool KincoDrive::initVelControl(motorProfile velControlMotorProfile) {
      * \todo Tune velocity loop gain index 0x2381 to optimize V control
      *
     */
-    sendSDOMessages(generateVelControlConfigSDO(velControlMotorProfile));
+    sendVelControlConfigSDO(velControlMotorProfile);
     return true;
 }
 
@@ -98,250 +99,126 @@ bool KincoDrive::initVelControl() {
      * \todo Tune velocity loop gain index 0x2381 to optimize V control
      *
     */
-    sendSDOMessages(Drive::generateVelControlConfigSDO());
+    Drive::sendVelControlConfigSDO();
     return true;
 }
 
 bool KincoDrive::initTorqueControl() {
     spdlog::debug("NodeID {} Initialising Torque Control", NodeID);
-    sendSDOMessages(generateTorqueControlConfigSDO());
+    sendTorqueControlConfigSDO();
 
     return true;
 }
 
 bool KincoDrive::resetError(){
     spdlog::debug("NodeID {} reset error", NodeID);
-    sendSDOMessages(generateResetErrorSDO());
+    sendResetErrorSDO();
     return true;
 }
 
-bool KincoDrive::initPDOs() {
-    spdlog::debug("KincoDrive::initPDOs");
-
-    spdlog::debug("Set up STATUS_WORD TPDO on Node {}", NodeID);
-    int TPDO_Num = 1;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0xFF)) < 0) {
-        spdlog::error("Set up STATUS_WORD TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up ACTUAL_POS and ACTUAL_VEL TPDO on Node {}", NodeID);
-    TPDO_Num = 2;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0x01)) < 0) {
-        spdlog::error("Set up ACTUAL_POS and ACTUAL_VEL TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up ACTUAL_TOR TPDO on Node {}", NodeID);
-    TPDO_Num = 3;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0x01)) < 0) {
-        spdlog::error("Set up ACTUAL_TOR TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up DIGITAL_IN RPDO on Node {}", NodeID);
-    TPDO_Num = 4;
-    if (sendSDOMessages(generateTPDOConfigSDO(TPDO_MappedObjects[TPDO_Num], TPDO_Num, TPDO_COBID[TPDO_Num] + NodeID, 0x01)) < 0) {
-        spdlog::error("Set up DIGITAL_IN TPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up CONTROL_WORD and DIGITAL_OUT RPDO on Node {}", NodeID);
-    int RPDO_Num = 1;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up CONTROL_WORD and DIGITAL_OUT RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up TARGET_POS RPDO on Node {}", NodeID);
-    RPDO_Num = 2;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up TARGET_POS RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up TARGET_VEL RPDO on Node {}", NodeID);
-    RPDO_Num = 3;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up ARGET_VEL RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    spdlog::debug("Set up TARGET_TOR RPDO on Node {}", NodeID);
-    RPDO_Num = 4;
-    if (sendSDOMessages(generateRPDOConfigSDO(RPDO_MappedObjects[RPDO_Num], RPDO_Num, RPDO_COBID[RPDO_Num] + NodeID, 0xff)) < 0) {
-        spdlog::error("Set up TARGET_TOR RPDO FAILED on node {}", NodeID);
-        return false;
-    }
-
-    return true;
-}
-
-std::vector<std::string> KincoDrive::generatePosControlConfigSDO(motorProfile positionProfile) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int KincoDrive::sendPosControlConfigSDO(motorProfile positionProfile) {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
 
     //Set control word to power up (enable)
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x0f";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x0f);
 
     //enable profile position mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 1";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 1);
 
     //Set velocity profile
-    sstream << "[1] " << NodeID << " write 0x6081 0 i32 " << std::dec << positionProfile.profileVelocity;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6081, 0, positionProfile.profileVelocity);
 
     //Set acceleration profile
-    sstream << "[1] " << NodeID << " write 0x6083 0 i32 " << std::dec << positionProfile.profileAcceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6083, 0, positionProfile.profileAcceleration);
 
     //Set deceleration profile
-    sstream << "[1] " << NodeID << " write 0x6084 0 i32 " << std::dec << positionProfile.profileDeceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6084, 0, positionProfile.profileDeceleration);
 
     //Set instant position mode; important for kinco
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x103f";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x103f);
 
-    return CANCommands;
+    return ret;
 }
-std::vector<std::string> KincoDrive::generateVelControlConfigSDO(motorProfile velocityProfile) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int KincoDrive::sendVelControlConfigSDO(motorProfile velocityProfile) {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
 
     //Set control word to power up (enable)
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x0f";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x0f);
 
     //enable profile Velocity mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 3";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 3);
 
     //Set velocity loop gain
-    sstream << "[1] " << NodeID << " write 0x60F9 1 u16 " << std::dec << 100;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x60F9, 1, 100);
 
     //Set acceleration profile
-    sstream << "[1] " << NodeID << " write 0x6083 0 i32 " << std::dec << velocityProfile.profileAcceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6083, 0, velocityProfile.profileAcceleration);
 
     //Set deceleration profile
-    sstream << "[1] " << NodeID << " write 0x6084 0 i32 " << std::dec << velocityProfile.profileDeceleration;
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER32>(NodeID, 0x6084, 0, velocityProfile.profileDeceleration);
 
-    return CANCommands;
+    return ret;
 }
-std::vector<std::string> KincoDrive::generateTorqueControlConfigSDO() {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int KincoDrive::sendTorqueControlConfigSDO() {
     // start drive
-    sstream << "[1] " << NodeID << " start";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = nmtCommand(NodeID, CO_NMT_ENTER_OPERATIONAL);
     //enable Torque Control mode
-    sstream << "[1] " << NodeID << " write 0x6060 0 i8 4";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<INTEGER8>(NodeID, 0x6060, 0, 4);
 
-    return CANCommands;
+    return ret;
 }
 
-std::vector<std::string> KincoDrive::generateResetErrorSDO() {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-
+int KincoDrive::sendResetErrorSDO() {
     // shutdown
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x06";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    int ret = sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x06);
 
     // reset fault
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x80";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x80);
 
     // reset fault
-    sstream << "[1] " << NodeID << " write 0x6040 0 u16 0x06";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
+    ret += sdoWrite<UNSIGNED16>(NodeID, 0x6040, 0, 0x06);
 
-    return CANCommands;
+    return ret;
 }
 
-std::vector<std::string> KincoDrive::readSDOMessage(int address, int datetype) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
+int KincoDrive::readSDOMessage(int address, int datetype, int &value) {
+    int ret;
     // read message from drive
-    sstream.str(std::string());
-
     switch (datetype) {
-        case 1:
-            sstream << "[1] " << NodeID << " read 0x" << std::hex << address << " 0 u8";
-            break;
-        case 2:
-            sstream << "[1] " << NodeID << " read 0x" << std::hex << address << " 0 u16";
+        case 2: {
+            UNSIGNED16 v = 0;
+            ret = sdoRead<UNSIGNED16>(NodeID, address, 0, v);
+            value = v;
             break;
-        case 3:
-            sstream << "[1] " << NodeID << " read 0x" << std::hex << address << " 0 i8";
+        }
+        case 3: {
+            INTEGER8 v = 0;
+            ret = sdoRead<INTEGER8>(NodeID, address, 0, v);
+            value = v;
             break;
-        case 4:
-            sstream << "[1] " << NodeID << " read 0x" << std::hex << address << " 0 i32";
+        }
+        case 4: {
+            INTEGER32 v = 0;
+            ret = sdoRead<INTEGER32>(NodeID, address, 0, v);
+            value = v;
             break;
-        default:
-            sstream << "[1] " << NodeID << " read 0x" << std::hex << address << " 0 u8";
+        }
+        case 1:
+        default: {
+            UNSIGNED8 v = 0;
+            ret = sdoRead<UNSIGNED8>(NodeID, address, 0, v);
+            value = v;
             break;
+        }
     }
+    spdlog::debug("NodeID {} read 0x{:x}: {}", NodeID, address, value);
 
-    std::cout << sstream.str() << "\n";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    sendSDOMessages(CANCommands);
-    return CANCommands;
+    return ret;
 }
 
-std::vector<std::string> KincoDrive::writeSDOMessage(int address, int value) {
-    // Define Vector to be returned as part of this method
-    std::vector<std::string> CANCommands;
-    // Define stringstream for ease of constructing hex strings
-    std::stringstream sstream;
-    // read message from drive
-    sstream.str(std::string());
-    sstream << "[1] " << NodeID << " write 0x" << std::hex << address << " 0 i32 0x" << std::hex << value;
-    std::cout << sstream.str() << "\n";
-    CANCommands.push_back(sstream.str());
-    sstream.str(std::string());
-
-    return CANCommands;
+int KincoDrive::writeSDOMessage(int address, int value) {
+    spdlog::debug("NodeID {} write 0x{:x}: 0x{:x}", NodeID, address, value);
+    return sdoWrite<INTEGER32>(NodeID, address, 0, value);
 }
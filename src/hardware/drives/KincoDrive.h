@@ -109,17 +109,27 @@ class KincoDrive : public Drive {
         */
     bool posControlConfirmSP();
 
-    bool initPDOs();
-
     bool resetError();
 
-    std::vector<std::string> writeSDOMessage(int address, int value);
-    std::vector<std::string> readSDOMessage(int address, int len);
+    /**
+     * \brief Writes an i32 value to (sub-index 0 of) an object of the drive
+     *
+     * \return int 0 on success
+     */
+    int writeSDOMessage(int address, int value);
+    /**
+     * \brief Reads (sub-index 0 of) an object of the drive
+     *
+     * \param datatype 1: u8, 2: u16, 3: i8, 4: i32
+     * \param value Read value
+     * \return int 0 on success
+     */
+    int readSDOMessage(int address, int datatype, int &value);
 
-    std::vector<std::string> generatePosControlConfigSDO(motorProfile positionProfile);
-    std::vector<std::string> generateVelControlConfigSDO(motorProfile velocityProfile);
-    std::vector<std::string> generateTorqueControlConfigSDO();
-    std::vector<std::string> generateResetErrorSDO();
+    int sendPosControlConfigSDO(motorProfile positionProfile);
+    int sendVelControlConfigSDO(motorProfile velocityProfile);
+    int sendTorqueControlConfigSDO();
+    int sendResetErrorSDO();
 };
 
 #endif
@@ -65,12 +65,13 @@ bool RobotM1::initialiseJoints() {
 }
 
 bool RobotM1::initialiseNetwork() {
-    bool status;
+    //Configure the drives concurrently (one SDO channel per node)
+    std::vector<std::function<bool()>> sequences;
     for (auto joint : joints) {
-        status = joint->initNetwork();
-        if (!status)
-            return false;
+        sequences.push_back([joint] { return joint->initNetwork(); });
     }
+    if (!sdoRunParallel(sequences))
+        return false;
     //Give time to drives PDO initialisation
     //TODO: Parameterize the number of PDOs for situations like the one below
     // spdlog::debug("...");
@@ -195,9 +196,8 @@ bool RobotM1::initMonitoring() {
 
     // Pause for a bit to let commands go
     usleep(2000);
-    for (auto p : joints) {
-        ((JointM1 *)p)->disable();
-    }
+    // Robot::disable(): also forgets the mode enabled by switchControlMode()
+    disable();
     return returnValue;
 }
 
@@ -267,6 +267,34 @@ bool RobotM1::initTorqueControl() {
     return returnValue;
 }
 
+bool RobotM1::configureControlMode(ControlMode mode) {
+    bool returnValue = true;
+    for (auto p : joints) {
+        ControlMode set;
+        if (mode == CM_POSITION_CONTROL || mode == CM_VELOCITY_CONTROL) {
+            set = ((JointM1 *)p)->setMode(mode, posControlMotorProfile);
+        } else {
+            set = ((JointM1 *)p)->setMode(mode);
+        }
+        if (set != mode) {
+            // Something bad happened if were are here
+            spdlog::debug("Something bad happened.");
+            returnValue = false;
+        }
+    }
+    return returnValue;
+}
+
+void RobotM1::controlModeSwitched(ControlMode mode) {
+    if (mode == CM_POSITION_CONTROL) {
+        this->mode = 1;
+    } else if (mode == CM_VELOCITY_CONTROL) {
+        this->mode = 2;
+    } else if (mode == CM_TORQUE_CONTROL) {
+        this->mode = 3;
+    }
+}
+
 setMovementReturnCode_t RobotM1::applyPosition(JointVec positions) {
     int i = 0;
     setMovementReturnCode_t returnValue = SUCCESS;  //TODO: proper return error code (not only last one)
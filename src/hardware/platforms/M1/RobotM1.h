@@ -128,6 +128,22 @@ public:
        */
     bool initTorqueControl();
 
+   protected:
+    /**
+       * \brief Sets the joint drive in a control mode (blocking SDOs), with the position motor profile
+       * for position and velocity control (as initPositionControl() and initVelocityControl()).
+       *
+       * \return true If joint is successfully configured
+       * \return false  If joint fails the configuration
+       */
+    bool configureControlMode(ControlMode mode) override;
+
+    /**
+       * \brief Records the new control mode (see mode) once switchControlMode() completed.
+       */
+    void controlModeSwitched(ControlMode mode) override;
+
+   public:
     /**
        * \brief Send a stop command to joint drive.
        *
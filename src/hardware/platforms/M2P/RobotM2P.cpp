@@ -74,12 +74,13 @@ bool RobotM2P::initialiseJoints() {
 bool RobotM2P::initialiseNetwork() {
     spdlog::debug("RobotM2P::initialiseNetwork()");
 
-    bool status;
+    //Configure the drives concurrently (one SDO channel per node)
+    std::vector<std::function<bool()>> sequences;
     for (auto joint : joints) {
-        status = joint->initNetwork();
-        if (!status)
-            return false;
+        sequences.push_back([joint] { return joint->initNetwork(); });
     }
+    if (!sdoRunParallel(sequences))
+        return false;
     //Give time to drives PDO initialisation
     spdlog::debug("...");
     for (int i = 0; i < 5; i++) {
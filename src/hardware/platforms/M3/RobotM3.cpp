@@ -96,12 +96,13 @@ bool RobotM3::initialiseJoints() {
 bool RobotM3::initialiseNetwork() {
     spdlog::debug("RobotM3::initialiseNetwork()");
 
-    bool status;
+    //Configure the drives concurrently (one SDO channel per node)
+    std::vector<std::function<bool()>> sequences;
     for (auto joint : joints) {
-        status = joint->initNetwork();
-        if (!status)
-            return false;
+        sequences.push_back([joint] { return joint->initNetwork(); });
     }
+    if (!sdoRunParallel(sequences))
+        return false;
     //Give time to drives PDO initialisation
     spdlog::debug("...");
     for (int i = 0; i < 5; i++) {
@@ -1,5 +1,7 @@
 #include "X2Robot.h"
 
+#include "StartupTrace.h"
+
 /**
  * An enum type.
  * Joint Index for the 4 joints (note, CANopen NODEID = this + 1)
@@ -158,121 +160,91 @@ void X2Robot::resetErrors() {
 
 bool X2Robot::initPositionControl() {
     spdlog::debug("Initialising Position Control on all joints ");
-    bool returnValue = true;
-    for (auto p : joints) {
-        if (p->setMode(CM_POSITION_CONTROL, posControlMotorProfile) != CM_POSITION_CONTROL) {
-            // Something back happened if were are here
-            spdlog::error("Something bad happened");
-            returnValue = false;
-        }
-        // Put into ReadyToSwitchOn()
-        p->readyToSwitchOn();
-    }
-
-    // Pause for a bit to let commands go
-    usleep(2000);
-    for (auto p : joints) {
-        p->enable();
-    }
-
-#ifdef SIM
-    controllerSwitchMsg_.request.start_controllers = {"position_controller"};
-    controllerSwitchMsg_.request.stop_controllers = {"velocity_controller", "torque_controller"};
-    controllerSwitchMsg_.request.strictness = 1;
-    controllerSwitchMsg_.request.start_asap = true;
-    controllerSwitchMsg_.request.timeout = 0.0;
-
-    if (controllerSwitchClient_.call(controllerSwitchMsg_)) {
-        spdlog::info("Switched to position controller");
-    } else {
-        spdlog::error("Failed switching to position controller");
-        returnValue = false;
-    }
-#endif
-
-    if(returnValue) controlMode = ControlMode::CM_POSITION_CONTROL;
-
-    return returnValue;
+    return initControlMode(CM_POSITION_CONTROL, 2000);
 }
 
 bool X2Robot::initVelocityControl() {
     spdlog::debug("Initialising Velocity Control on all joints ");
-    bool returnValue = true;
+    return initControlMode(CM_VELOCITY_CONTROL, 10000);
+}
+
+bool X2Robot::initTorqueControl() {
+    spdlog::debug("Initialising Torque Control on all joints ");
+    return initControlMode(CM_TORQUE_CONTROL, 2000);
+}
+
+bool X2Robot::initControlMode(ControlMode mode, useconds_t switchOnDelay) {
+    bool returnValue = configureControlMode(mode);
+
+    // Put into ReadyToSwitchOn()
     for (auto p : joints) {
-        if (p->setMode(CM_VELOCITY_CONTROL, velControlMotorProfile) != CM_VELOCITY_CONTROL) {
-            // Something back happened if were are here
-            spdlog::error("Something bad happened");
-            returnValue = false;
-        }
-        // Put into ReadyToSwitchOn()
         p->readyToSwitchOn();
     }
 
     // Pause for a bit to let commands go
-    usleep(10000);
+    usleep(switchOnDelay);
     for (auto p : joints) {
         p->enable();
     }
 
-#ifdef SIM
-    controllerSwitchMsg_.request.start_controllers = {"velocity_controller"};
-    controllerSwitchMsg_.request.stop_controllers = {"position_controller", "torque_controller"};
-    controllerSwitchMsg_.request.strictness = 1;
-    controllerSwitchMsg_.request.start_asap = true;
-    controllerSwitchMsg_.request.timeout = 0.0;
-
-    if (controllerSwitchClient_.call(controllerSwitchMsg_)) {
-        spdlog::info("Switched to velocity controller");
-    } else {
-        spdlog::error("Failed switching to velocity controller");
-        returnValue = false;
-    }
-#endif
-
-    if(returnValue) controlMode = ControlMode::CM_VELOCITY_CONTROL;
+    if(returnValue) controlMode = mode;
 
     return returnValue;
 }
 
-bool X2Robot::initTorqueControl() {
-    spdlog::debug("Initialising Torque Control on all joints ");
-    bool returnValue = true;
-    for (auto p : joints) {
-        if (p->setMode(CM_TORQUE_CONTROL) != CM_TORQUE_CONTROL) {
-            // Something back happened if were are here
-            spdlog::error("Something bad happened");
-            returnValue = false;
-        }
-        // Put into ReadyToSwitchOn()
-        p->readyToSwitchOn();
+bool X2Robot::configureControlMode(ControlMode mode) {
+    if (mode != CM_POSITION_CONTROL && mode != CM_VELOCITY_CONTROL && mode != CM_TORQUE_CONTROL) {
+        spdlog::error("Unsupported control mode {}", mode);
+        return false;
     }
 
-    // Pause for a bit to let commands go
-    usleep(2000);
+    // All drives at once
+    std::vector<std::function<bool()>> sequences;
     for (auto p : joints) {
-        p->enable();
+        sequences.push_back([this, p, mode] {
+            ControlMode set;
+            if (mode == CM_POSITION_CONTROL) {
+                set = p->setMode(mode, posControlMotorProfile);
+            } else if (mode == CM_VELOCITY_CONTROL) {
+                set = p->setMode(mode, velControlMotorProfile);
+            } else {
+                set = p->setMode(mode);
+            }
+            if (set != mode) {
+                // Something back happened if were are here
+                spdlog::error("Something bad happened");
+                return false;
+            }
+            return true;
+        });
     }
+    bool returnValue = sdoRunParallel(sequences);
 
 #ifdef SIM
-    controllerSwitchMsg_.request.start_controllers = {"torque_controller"};
-    controllerSwitchMsg_.request.stop_controllers = {"position_controller", "velocity_controller"};
+    std::vector<std::string> controllers = {"position_controller", "velocity_controller", "torque_controller"};
+    std::string controller = controllers[mode - CM_POSITION_CONTROL];
+    controllers.erase(controllers.begin() + (mode - CM_POSITION_CONTROL));
+    controllerSwitchMsg_.request.start_controllers = {controller};
+    controllerSwitchMsg_.request.stop_controllers = controllers;
     controllerSwitchMsg_.request.strictness = 1;
     controllerSwitchMsg_.request.start_asap = true;
     controllerSwitchMsg_.request.timeout = 0.0;
 
     if (controllerSwitchClient_.call(controllerSwitchMsg_)) {
-        spdlog::info("Switched to torque controller");
+        spdlog::info("Switched to {}", controller);
     } else {
-        spdlog::error("Failed switching to torque controller");
+        spdlog::error("Failed switching to {}", controller);
         returnValue = false;
     }
 #endif
 
-    if(returnValue) controlMode = ControlMode::CM_TORQUE_CONTROL;
-
     return returnValue;
 }
 
+void X2Robot::controlModeSwitched(ControlMode mode) {
+    controlMode = mode;
+}
+
 setMovementReturnCode_t X2Robot::setPosition(Eigen::VectorXd positions) {
     int i = 0;
     setMovementReturnCode_t returnValue = SUCCESS;
@@ -336,6 +308,24 @@ setMovementReturnCode_t X2Robot::setVelocity(Eigen::VectorXd velocities) {
     return returnValue;
 }
 
+void X2Robot::setZeroCommand() {
+    for (auto p : joints) {
+        if (((X2Joint *)p)->setTorque(0) == INCORRECT_MODE) {
+            ((X2Joint *)p)->setVelocity(0);
+        }
+    }
+
+#ifdef SIM
+    if (controlMode == CM_VELOCITY_CONTROL) {
+        velocityCommandMsg_.data = std::vector<double>(X2_NUM_JOINTS, 0);
+        velocityCommandPublisher_.publish(velocityCommandMsg_);
+    } else {
+        torqueCommandMsg_.data = std::vector<double>(X2_NUM_JOINTS, 0);
+        torqueCommandPublisher_.publish(torqueCommandMsg_);
+    }
+#endif
+}
+
 setMovementReturnCode_t X2Robot::setTorque(Eigen::VectorXd torques) {
     int i = 0;
     setMovementReturnCode_t returnValue = SUCCESS;
@@ -367,6 +357,7 @@ setMovementReturnCode_t X2Robot::setTorque(Eigen::VectorXd torques) {
 }
 
 bool X2Robot::calibrateForceSensors() {
+    StartupSpan span("X2Robot::calibrateForceSensors");
     int numberOfSuccess = 0;
     for (int i = 0; i < X2_NUM_FORCE_SENSORS + X2_NUM_GRF_SENSORS; i++) {
         if (forceSensors[i]->calibrate()) numberOfSuccess++;
@@ -503,6 +494,7 @@ void X2Robot::updateGeneralizedAcceleration() {
 
 bool X2Robot::homing(std::vector<int> homingDirection, float thresholdTorque, float delayTime,
                      float homingSpeed, float maxTime) {
+    StartupSpan span("X2Robot::homing");
     std::vector<bool> success(X2_NUM_JOINTS, false);
     std::chrono::steady_clock::time_point time0;
     signal(SIGINT, signalHandler); // check if ctrl + c is pressed
@@ -624,14 +616,12 @@ bool X2Robot::initialiseJoints() {
 bool X2Robot::initialiseNetwork() {
     spdlog::debug("X2Robot::initialiseNetwork()");
 
-    bool status;
+    //Configure the drives concurrently (one SDO channel per node)
+    std::vector<std::function<bool()>> sequences;
     for (auto joint : joints) {
-        status = joint->initNetwork();
-        if (!status)
-            return false;
+        sequences.push_back([joint] { return joint->initNetwork(); });
     }
-
-    return true;
+    return sdoRunParallel(sequences);
 }
 
 bool X2Robot::initialiseInputs() {
@@ -141,6 +141,11 @@ private:
     RobotParameters x2Parameters;
     ControlMode controlMode;
 
+    /**
+     * \brief Blocking change of control mode: configure the drives, switch on and enable after switchOnDelay (in us).
+     */
+    bool initControlMode(ControlMode mode, useconds_t switchOnDelay);
+
     double dt_ = 0.003; // 0.003 todo: pass this information from main
 
     //Todo: generalise sensors
@@ -323,6 +328,23 @@ public:
    */
     bool initTorqueControl();
 
+protected:
+    /**
+       * \brief Sets all joints drives in a control mode, with the X2 motor profiles (blocking SDOs).
+       * Also switches the simulation controller (SIM).
+       *
+       * \return true If all joints are successfully configured
+       * \return false  If some or all joints fail the configuration
+   */
+    bool configureControlMode(ControlMode mode) override;
+
+    /**
+       * \brief Records the new control mode (see getControlMode()) once switchControlMode() completed.
+   */
+    void controlModeSwitched(ControlMode mode) override;
+
+public:
+
     /**
       * \brief For each joint, move through(send appropriate commands to joints) the currently
       * generated trajectory of the TrajectoryGenerator object - this assumes the trajectory and robot is in position control.
@@ -356,6 +378,13 @@ public:
     */
     setMovementReturnCode_t setTorque(Eigen::VectorXd torques);
 
+    /**
+    * \brief Set a zero target torque or velocity to each joint, in the control mode this joint is in. To use while
+    * a control mode change is in progress (see switchControlMode()), when the joints may be in different modes.
+    * Joints in position control are left unchanged.
+    */
+    void setZeroCommand();
+
 
     /**
     * \brief Get the latest joints position
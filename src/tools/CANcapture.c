@@ -0,0 +1,150 @@
+/**
+ * \file CANcapture.c
+ * \brief Capture the CAN frames of an interface into a binary capture file
+ * (format in CO_canCapture.h), to be replayed with CANreplay.
+ *
+ * Frames are timed by the kernel (SO_TIMESTAMPNS). Frames sent by the host
+ * (e.g. by CORC on the same interface) are flagged as sent: a replay of the
+ * received frames only then reproduces the traffic of the other nodes (the
+ * drives) for the application under test.
+ *
+ * In-process captures, with the frames of the stack only, are made by CORC
+ * itself when built with CAN_CAPTURE (see CMakeLists.txt).
+ *
+ * Usage: CANcapture [-i interface (can0)] [-d duration in s (until ctrl+c)] file
+ *
+ * \version 0.1
+ * \copyright Copyright (c) 2020
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <net/if.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/can/raw.h>
+
+#include "CO_canCapture.h"
+
+static volatile sig_atomic_t endCapture = 0;
+static void sigHandler(int sig) {
+    endCapture = 1;
+}
+
+static uint64_t realtimeNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    const char *interface = "can0";
+    double duration = 0;
+    struct sockaddr_can addr;
+    struct sigaction sa;
+    struct timeval timeout = {0, 100000};
+    uint64_t start, frames = 0, sent = 0;
+    int opt, fd, on = 1;
+    FILE *f;
+
+    while ((opt = getopt(argc, argv, "i:d:")) != -1) {
+        switch (opt) {
+            case 'i':
+                interface = optarg;
+                break;
+            case 'd':
+                duration = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-i interface] [-d duration_s] file\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Usage: %s [-i interface] [-d duration_s] file\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = if_nametoindex(interface);
+    if (addr.can_ifindex == 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Can't open CAN interface %s\n", interface);
+        return EXIT_FAILURE;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+    /* Periodic wake-up to check the duration and ctrl+c */
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    f = fopen(argv[optind], "wb");
+    if (f == NULL) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    start = realtimeNow();
+    CO_CANcaptureWriteHeader(f, start);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigHandler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    printf("Capturing %s to %s (ctrl+c to stop)\n", interface, argv[optind]);
+
+    while (!endCapture) {
+        struct can_frame frame;
+        struct iovec iov = {&frame, sizeof(frame)};
+        char control[CMSG_SPACE(sizeof(struct timespec))];
+        struct msghdr hdr;
+        struct cmsghdr *cmsg;
+        uint64_t time = 0;
+
+        if (duration > 0 && realtimeNow() - start >= duration * 1e9) {
+            break;
+        }
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &hdr, 0) != sizeof(frame)) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("recvmsg");
+                break;
+            }
+            continue;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                time = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+            }
+        }
+        if (time == 0) {
+            time = realtimeNow();
+        }
+        /* MSG_DONTROUTE: frame sent from this host (local loopback) */
+        if (hdr.msg_flags & MSG_DONTROUTE) {
+            sent++;
+        }
+        CO_CANcaptureWriteRecord(f, &frame, time > start ? time - start : 0, (hdr.msg_flags & MSG_DONTROUTE) ? CO_CAN_CAPTURE_TX : 0);
+        frames++;
+    }
+
+    fclose(f);
+    close(fd);
+    printf("%llu frames captured (%llu sent by this host) in %.3f s\n", (unsigned long long)frames,
+           (unsigned long long)sent, (realtimeNow() - start) / 1e9);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,260 @@
+/**
+ * \file CANreplay.c
+ * \brief Replay a binary CAN capture (CO_canCapture.h, made by CORC with
+ * CAN_CAPTURE or by CANcapture) onto a CAN interface, at the original timing
+ * or accelerated, for repeatable benchmarks of the stack and the control loop
+ * without the robot.
+ *
+ * By default only the frames received by the capturing node are replayed (the
+ * traffic of the drives and other nodes): CORC run on the same interface sends
+ * its own frames. Use -a to replay all of them (e.g. to feed a monitor).
+ *
+ * Typical use, on a virtual CAN interface:
+ *   sudo modprobe vcan
+ *   sudo ip link add dev vcan0 type vcan
+ *   sudo ip link set up vcan0
+ *   ./CORC_app -can vcan0 &
+ *   ./CANreplay -i vcan0 logs/CORC_can_capture.bin
+ *
+ * The whole file is loaded before the replay starts. Frames are sent at
+ * absolute deadlines (clock_nanosleep): lateness does not accumulate, and is
+ * reported at the end. Run as root with -p for a SCHED_FIFO replay thread.
+ *
+ * Usage: CANreplay [-i interface (vcan0)] [-s speed factor (1, 0: as fast as possible)]
+ *                  [-a] [-n loops (1)] [-p priority] [-l] file
+ *        -l lists the frames as text instead of sending them.
+ *
+ * \version 0.1
+ * \copyright Copyright (c) 2020
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/can/raw.h>
+
+#include "CO_canCapture.h"
+
+typedef struct {
+    uint64_t time_ns;
+    struct can_frame frame;
+    uint8_t flags;
+} replayFrame_t;
+
+static volatile sig_atomic_t endReplay = 0;
+static void sigHandler(int sig) {
+    endReplay = 1;
+}
+
+static uint64_t monotonicNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compareLateness(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void listFrames(const CO_CANcaptureHeader_t *header, const replayFrame_t *frames, size_t n) {
+    time_t start = header->startRealtime_ns / 1000000000ULL;
+    size_t i;
+    int j;
+
+    printf("# Capture started %s", ctime(&start));
+    for (i = 0; i < n; i++) {
+        const struct can_frame *frame = &frames[i].frame;
+        printf("(%.6f) %s %03X", frames[i].time_ns / 1e9, (frames[i].flags & CO_CAN_CAPTURE_TX) ? "tx" : "rx",
+               frame->can_id & CAN_EFF_MASK);
+        if (frame->can_id & CAN_RTR_FLAG) {
+            printf("#R%d\n", frame->can_dlc);
+            continue;
+        }
+        printf("#");
+        for (j = 0; j < frame->can_dlc && j < 8; j++) {
+            printf("%02X", frame->data[j]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *interface = "vcan0";
+    double speed = 1;
+    int allFrames = 0, list = 0, loops = 1, priority = 0;
+    CO_CANcaptureHeader_t header;
+    replayFrame_t *frames = NULL;
+    size_t n = 0, size = 0, nSent = 0, nReplayed = 0, i;
+    uint64_t *lateness, retries = 0, start, end;
+    struct sockaddr_can addr;
+    struct sigaction sa;
+    int opt, fd, loop, ret;
+    FILE *f;
+
+    while ((opt = getopt(argc, argv, "i:s:an:p:l")) != -1) {
+        switch (opt) {
+            case 'i':
+                interface = optarg;
+                break;
+            case 's':
+                speed = atof(optarg);
+                break;
+            case 'a':
+                allFrames = 1;
+                break;
+            case 'n':
+                loops = atoi(optarg);
+                break;
+            case 'p':
+                priority = atoi(optarg);
+                break;
+            case 'l':
+                list = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-i interface] [-s speed] [-a] [-n loops] [-p priority] [-l] file\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc || speed < 0 || loops < 1) {
+        fprintf(stderr, "Usage: %s [-i interface] [-s speed] [-a] [-n loops] [-p priority] [-l] file\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Load the capture */
+    f = fopen(argv[optind], "rb");
+    if (f == NULL) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if (CO_CANcaptureReadHeader(f, &header) != 0) {
+        fprintf(stderr, "%s: not a CAN capture file (or unsupported version)\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    for (;;) {
+        if (n == size) {
+            size = size ? 2 * size : 4096;
+            frames = realloc(frames, size * sizeof(replayFrame_t));
+            if (frames == NULL) {
+                fprintf(stderr, "Out of memory\n");
+                return EXIT_FAILURE;
+            }
+        }
+        ret = CO_CANcaptureReadRecord(f, &frames[n].frame, &frames[n].time_ns, &frames[n].flags);
+        if (ret <= 0) {
+            if (ret < 0) {
+                fprintf(stderr, "%s: truncated after %zu frames\n", argv[optind], n);
+            }
+            break;
+        }
+        n++;
+    }
+    fclose(f);
+
+    if (list) {
+        listFrames(&header, frames, n);
+        return EXIT_SUCCESS;
+    }
+    for (i = 0; i < n; i++) {
+        if (allFrames || !(frames[i].flags & CO_CAN_CAPTURE_TX)) {
+            nSent++;
+        }
+    }
+    if (nSent == 0) {
+        fprintf(stderr, "No frame to replay (%zu frames sent by the capturing node: use -a)\n", n);
+        return EXIT_FAILURE;
+    }
+    lateness = malloc(nSent * sizeof(uint64_t));
+
+    fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = if_nametoindex(interface);
+    if (addr.can_ifindex == 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Can't open CAN interface %s\n", interface);
+        return EXIT_FAILURE;
+    }
+    /* Nothing to receive */
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+
+    if (priority > 0) {
+        struct sched_param param = {.sched_priority = priority};
+        if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+            perror("sched_setscheduler (are you root?)");
+        }
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigHandler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("Replaying %zu of %zu frames (%.3f s) on %s, speed %s%g, %d loop(s)\n", nSent, n,
+           n ? frames[n - 1].time_ns / 1e9 : 0., interface, speed > 0 ? "x" : "max ", speed, loops);
+    start = monotonicNow();
+    for (loop = 0; loop < loops && !endReplay; loop++) {
+        uint64_t loopStart = monotonicNow();
+        size_t k = 0;
+        for (i = 0; i < n && !endReplay; i++) {
+            uint64_t deadline, now;
+            if (!allFrames && (frames[i].flags & CO_CAN_CAPTURE_TX)) {
+                continue;
+            }
+            deadline = loopStart + (speed > 0 ? (uint64_t)(frames[i].time_ns / speed) : 0);
+            if (speed > 0) {
+                struct timespec ts = {deadline / 1000000000ULL, deadline % 1000000000ULL};
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !endReplay) {
+                }
+            }
+            /* Interface queue full: wait for room (accelerated replays) */
+            while (write(fd, &frames[i].frame, sizeof(struct can_frame)) != sizeof(struct can_frame)) {
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                if (errno != ENOBUFS && errno != EAGAIN && errno != EINTR) {
+                    perror("write");
+                    endReplay = 1;
+                    break;
+                }
+                retries++;
+                if (poll(&pfd, 1, 1) < 0 || endReplay) {
+                    break;
+                }
+            }
+            now = monotonicNow();
+            if (loop == 0 && k < nSent) {
+                lateness[k++] = now > deadline ? now - deadline : 0;
+            }
+            nReplayed++;
+        }
+    }
+    end = monotonicNow();
+    close(fd);
+
+    printf("%zu frames replayed in %.3f s (%.0f frames/s), %llu retries on a full queue\n", nReplayed, (end - start) / 1e9,
+           nReplayed / ((end - start) / 1e9), (unsigned long long)retries);
+    if (speed > 0 && nReplayed > 0) {
+        size_t m = nReplayed < nSent ? nReplayed : nSent;
+        double sum = 0;
+        for (i = 0; i < m; i++) {
+            sum += lateness[i];
+        }
+        qsort(lateness, m, sizeof(uint64_t), compareLateness);
+        printf("Lateness (first loop): mean %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", sum / m / 1e3,
+               lateness[m / 2] / 1e3, lateness[(size_t)(m * 0.99)] / 1e3, lateness[m - 1] / 1e3);
+    }
+    free(lateness);
+    free(frames);
+    return EXIT_SUCCESS;
+}
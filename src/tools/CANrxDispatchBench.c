@@ -0,0 +1,135 @@
+/**
+ * \file CANrxDispatchBench.c
+ * \brief Microbenchmark of the CAN receive dispatch (CO_CANrxDispatch) against
+ * the former linear search of rxArray, as the number of registered RPDOs grows.
+ *
+ * The CAN module is prepared without a socket, so no CAN interface is required:
+ * receive buffers are laid out as in CO_init (NMT, SYNC, RPDOs, SDO server,
+ * SDO client, heartbeat consumers) and frames cycling over all RPDO COB-IDs are
+ * dispatched in a tight loop.
+ *
+ * Usage: CANrxDispatchBench [iterations]
+ *
+ * \version 0.1
+ * \copyright Copyright (c) 2020
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "CO_driver.h"
+#include "CO_Emergency.h"
+
+#define NODE_ID 100
+#define MAX_RPDO 512
+#define NO_HB_CONS 4
+
+/* Stubs for the functions CO_driver.c expects from the rest of the stack */
+void CO_errorReport(CO_EM_t *em, const uint8_t errorBit, const uint16_t errorCode, const uint32_t infoCode) {}
+void CO_errExit(char const *msg) {
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+static volatile uint32_t received = 0;
+static void rxCallback(void *object, const CO_CANrxMsg_t *message) {
+    received++;
+}
+
+/* Former CO_CANrxWait search, kept as reference */
+static void linearDispatch(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg) {
+    CO_CANrx_t *buffer = &CANmodule->rxArray[0];
+    int i;
+    for (i = CANmodule->rxSize; i > 0; i--) {
+        if (((rcvMsg->ident ^ buffer->ident) & buffer->mask) == 0U) {
+            if (buffer->pFunct != NULL) {
+                buffer->pFunct(buffer->object, rcvMsg);
+            }
+            return;
+        }
+        buffer++;
+    }
+}
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* RPDO COB-IDs as generated for drives: TPDO1..4 of consecutive nodes */
+static uint16_t rpdoCOBID(int i) {
+    return (uint16_t)(0x180 + 0x100 * (i % 4) + 1 + i / 4);
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = (argc > 1) ? atol(argv[1]) : 2000000;
+    int nRPDOs[] = {4, 8, 16, 32, 64, 128, 256, 512};
+    unsigned int k;
+
+    printf("%8s %8s %14s %14s %8s\n", "RPDOs", "rxSize", "linear ns/fr", "indexed ns/fr", "speedup");
+    for (k = 0; k < sizeof(nRPDOs) / sizeof(nRPDOs[0]); k++) {
+        int nRPDO = nRPDOs[k];
+        uint16_t rxSize = (uint16_t)(2 + nRPDO + 2 + NO_HB_CONS);
+        CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)calloc(1, sizeof(CO_CANmodule_t));
+        CO_CANrx_t *rxArray = (CO_CANrx_t *)calloc(rxSize, sizeof(CO_CANrx_t));
+        CO_CANtx_t txArray[1];
+        CO_CANrxMsg_t *frames = (CO_CANrxMsg_t *)calloc(nRPDO, sizeof(CO_CANrxMsg_t));
+        uint16_t idx = 0;
+        double t0, tLinear, tIndexed;
+        long n;
+        int i;
+
+        /* Skip socket creation: filters are only kept in memory */
+        CANmodule->wasConfigured = 1;
+        CANmodule->fd = -1;
+        CANmodule->filter = (struct can_filter *)calloc(rxSize, sizeof(struct can_filter));
+        CANmodule->rxMasked = (uint16_t *)calloc(rxSize, sizeof(uint16_t));
+        if (CO_CANmodule_init(CANmodule, 1, rxArray, rxSize, txArray, 1, 1000) != CO_ERROR_NO) {
+            CO_errExit("CO_CANmodule_init failed");
+        }
+
+        /* Same layout as CO_init */
+        CO_CANrxBufferInit(CANmodule, idx++, 0x000, 0x7FF, 0, CANmodule, rxCallback);
+        CO_CANrxBufferInit(CANmodule, idx++, 0x080, 0x7FF, 0, CANmodule, rxCallback);
+        for (i = 0; i < nRPDO; i++) {
+            CO_CANrxBufferInit(CANmodule, idx++, rpdoCOBID(i), 0x7FF, 0, CANmodule, rxCallback);
+            frames[i].ident = rpdoCOBID(i);
+            frames[i].DLC = 8;
+        }
+        CO_CANrxBufferInit(CANmodule, idx++, 0x600 + NODE_ID, 0x7FF, 0, CANmodule, rxCallback);
+        CO_CANrxBufferInit(CANmodule, idx++, 0x580 + 1, 0x7FF, 0, CANmodule, rxCallback);
+        for (i = 0; i < NO_HB_CONS; i++) {
+            CO_CANrxBufferInit(CANmodule, idx++, 0x700 + 1 + i, 0x7FF, 0, CANmodule, rxCallback);
+        }
+
+        received = 0;
+        t0 = now_s();
+        for (n = 0; n < iterations; n++) {
+            linearDispatch(CANmodule, &frames[n % nRPDO]);
+        }
+        tLinear = now_s() - t0;
+
+        t0 = now_s();
+        for (n = 0; n < iterations; n++) {
+            CO_CANrxDispatch(CANmodule, &frames[n % nRPDO]);
+        }
+        tIndexed = now_s() - t0;
+
+        if (received != 2 * iterations) {
+            fprintf(stderr, "Dispatch mismatch: %u callbacks for %ld frames\n", received, 2 * iterations);
+            return EXIT_FAILURE;
+        }
+
+        printf("%8d %8d %14.1f %14.1f %7.1fx\n", nRPDO, rxSize,
+               tLinear * 1e9 / iterations, tIndexed * 1e9 / iterations, tLinear / tIndexed);
+
+        CO_CANmodule_disable(CANmodule);
+        free(frames);
+        free(rxArray);
+        free(CANmodule);
+    }
+    return EXIT_SUCCESS;
+}
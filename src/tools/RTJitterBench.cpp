@@ -0,0 +1,191 @@
+/**
+ * \file RTJitterBench.cpp
+ * \brief Wake-up jitter of a periodic thread, as the control loop (rt_control_thread: absolute
+ * clock_nanosleep on CLOCK_MONOTONIC), with and without the real-time settings of RTConfig:
+ * SCHED_FIFO priority, CPU affinity, mlockall and stack prefaulting.
+ *
+ * With -spin or -adaptive, the loop sleeps until a spin window before the end of the period and busy
+ * waits the rest, as wait_rest_of_period: fixed window (RTConfig activeWaitTime) or sized online by AdaptiveSpin.
+ * The latency is then the one of the end of the wait, and the CPU time spent spinning is reported.
+ *
+ * Optional background load runs on SCHED_OTHER threads: CPU hogs and a thread allocating,
+ * touching and freeing memory (page faults, memory pressure).
+ *
+ * Usage: RTJitterBench [-t seconds] [-p period_us] [-fifo priority] [-cpu n] [-mlock]
+ *                      [-prefault kb] [-load threads] [-spin us | -adaptive max_us]
+ *
+ * \version 0.1
+ * \copyright Copyright (c) 2021
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AdaptiveSpin.h"
+
+#define NSEC_PER_SEC 1000000000L
+
+static std::atomic<bool> stopLoad(false);
+
+static void cpuHog() {
+    volatile unsigned long n = 0;
+    while (!stopLoad) {
+        n++;
+    }
+}
+
+static void memoryChurn() {
+    while (!stopLoad) {
+        size_t size = 16 * 1024 * 1024;
+        char *p = (char *)malloc(size);
+        if (p != NULL) {
+            memset(p, 1, size);
+            free(p);
+        }
+    }
+}
+
+static void __attribute__((noinline)) prefaultStack(size_t size) {
+    volatile char *stack = (volatile char *)alloca(size);
+    for (size_t i = 0; i < size; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    double duration = 10;
+    long period_ns = 2000000;
+    int fifoPriority = 0;
+    int cpu = -1;
+    bool lockMemory = false;
+    size_t prefault = 0;
+    int loadThreads = 0;
+    long spin_ns = -1;
+    bool adaptive = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-mlock") {
+            lockMemory = true;
+        } else if (i + 1 < argc && arg == "-t") {
+            duration = atof(argv[++i]);
+        } else if (i + 1 < argc && arg == "-p") {
+            period_ns = atol(argv[++i]) * 1000;
+        } else if (i + 1 < argc && arg == "-fifo") {
+            fifoPriority = atoi(argv[++i]);
+        } else if (i + 1 < argc && arg == "-cpu") {
+            cpu = atoi(argv[++i]);
+        } else if (i + 1 < argc && arg == "-prefault") {
+            prefault = atol(argv[++i]) * 1024;
+        } else if (i + 1 < argc && arg == "-load") {
+            loadThreads = atoi(argv[++i]);
+        } else if (i + 1 < argc && (arg == "-spin" || arg == "-adaptive")) {
+            spin_ns = atol(argv[++i]) * 1000;
+            adaptive = (arg == "-adaptive");
+        } else {
+            fprintf(stderr, "Usage: %s [-t seconds] [-p period_us] [-fifo priority] [-cpu n] [-mlock] [-prefault kb] [-load threads] [-spin us | -adaptive max_us]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        perror("mlockall");
+        return EXIT_FAILURE;
+    }
+
+    /* Background load (SCHED_OTHER, created before the periodic thread settings) */
+    std::vector<std::thread> load;
+    for (int i = 0; i < loadThreads; i++) {
+        load.emplace_back(cpuHog);
+    }
+    if (loadThreads > 0) {
+        load.emplace_back(memoryChurn);
+    }
+
+    long noPeriods = (long)(duration * NSEC_PER_SEC / period_ns);
+    std::vector<double> latencies(noPeriods);
+    AdaptiveSpin spin(spin_ns > 0 ? spin_ns : 0, adaptive);
+    std::thread periodic([&] {
+        if (fifoPriority > 0) {
+            struct sched_param param;
+            param.sched_priority = fifoPriority;
+            if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+                fprintf(stderr, "SCHED_FIFO failed (are you root?)\n");
+            }
+        }
+        if (cpu >= 0) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpu, &cpuset);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+                fprintf(stderr, "CPU affinity failed\n");
+            }
+        }
+        if (prefault > 0) {
+            prefaultStack(prefault);
+        }
+
+        struct timespec next, now;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        for (long n = 0; n < noPeriods; n++) {
+            next.tv_nsec += period_ns;
+            while (next.tv_nsec >= NSEC_PER_SEC) {
+                next.tv_sec++;
+                next.tv_nsec -= NSEC_PER_SEC;
+            }
+            if (spin_ns < 0) {
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+                clock_gettime(CLOCK_MONOTONIC, &now);
+            } else {
+                struct timespec wakeup = next, spinStart;
+                wakeup.tv_nsec -= spin.spinTime();
+                while (wakeup.tv_nsec < 0) {
+                    wakeup.tv_sec--;
+                    wakeup.tv_nsec += NSEC_PER_SEC;
+                }
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL);
+                clock_gettime(CLOCK_MONOTONIC, &spinStart);
+                spin.sleepOvershoot((spinStart.tv_sec - wakeup.tv_sec) * NSEC_PER_SEC + (spinStart.tv_nsec - wakeup.tv_nsec));
+                now = spinStart;
+                while ((now.tv_sec - next.tv_sec) * NSEC_PER_SEC + (now.tv_nsec - next.tv_nsec) < 0) {
+                    clock_gettime(CLOCK_MONOTONIC, &now);
+                }
+                spin.periodEnd((now.tv_sec - spinStart.tv_sec) * NSEC_PER_SEC + (now.tv_nsec - spinStart.tv_nsec),
+                               (now.tv_sec - next.tv_sec) * NSEC_PER_SEC + (now.tv_nsec - next.tv_nsec));
+            }
+            latencies[n] = ((now.tv_sec - next.tv_sec) * NSEC_PER_SEC + (now.tv_nsec - next.tv_nsec)) / 1000.;
+        }
+    });
+    periodic.join();
+    stopLoad = true;
+    for (auto &t : load) {
+        t.join();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (double l : latencies) {
+        sum += l;
+    }
+    long overruns = std::count_if(latencies.begin(), latencies.end(), [&](double l) { return l > period_ns / 1000.; });
+    printf("%ld periods of %ld us, %s prio %d, cpu %d, mlock %s, prefault %zu KB, load %d\n", noPeriods, period_ns / 1000,
+           fifoPriority > 0 ? "FIFO" : "OTHER", fifoPriority, cpu, lockMemory ? "yes" : "no", prefault / 1024, loadThreads);
+    printf("wake-up latency (us): min %.1f  avg %.1f  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f  (%ld > period)\n",
+           latencies.front(), sum / noPeriods, latencies[noPeriods / 2], latencies[(long)(noPeriods * 0.99)],
+           latencies[(long)(noPeriods * 0.999)], latencies.back(), overruns);
+    if (spin_ns >= 0) {
+        printf("%s spin (max %ld us): %.1f us per period on average, %.1f%% of a core\n", adaptive ? "adaptive" : "fixed",
+               spin_ns / 1000, spin.averageSpin_us(), 100. * spin.averageSpin_us() * 1000 / period_ns);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/**
+ * \file SDOcommandBench.cpp
+ * \brief Host-side cost of the SDO writes issued by a drive initialisation: text commands
+ * (as formerly built by Drive and parsed by cancomm_socketFree) against binary writes
+ * (cancomm_sdoWrite, as used by sdoWrite<T>).
+ *
+ * The SDO client transfer itself (sdoClientDownload) is stubbed out: the measured time is
+ * only the cost added on top of the CAN transfers, i.e. excluding the bus round-trips and the
+ * SDO client polling. No CAN interface is required.
+ *
+ * Usage: SDOcommandBench [iterations]
+ *
+ * \version 0.1
+ * \copyright Copyright (c) 2020
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CANopen.h"
+#include "CO_command.h"
+extern "C" {
+#include "CO_master.h"
+}
+
+#define NODE_ID 3
+
+/* Stubs for the SDO client and the rest of the stack */
+static CO_t COstub;
+static CO_SDOclient_t SDOclientStub;
+CO_t *CO = &COstub;
+static volatile uint8_t sink;
+static long noTransfers = 0;
+
+extern "C" {
+int sdoClientDownload(CO_SDOclient_t *SDOclient, uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                      uint8_t *dataTx, uint32_t dataTxLen, uint32_t *SDOabortCode,
+                      uint16_t SDOtimeoutTime, uint8_t blockTransferEnable) {
+    sink = dataTx[dataTxLen - 1];
+    noTransfers++;
+    *SDOabortCode = 0;
+    return 0;
+}
+int sdoClientUpload(CO_SDOclient_t *SDOclient, uint8_t nodeID, uint16_t idx, uint8_t subidx,
+                    uint8_t *dataRx, uint32_t dataRxSize, uint32_t *dataRxLen, uint32_t *SDOabortCode,
+                    uint16_t SDOtimeoutTime, uint8_t blockTransferEnable) {
+    *dataRxLen = 0;
+    *SDOabortCode = 0;
+    return 0;
+}
+CO_SDOclient_t *sdoClientChannel(uint8_t nodeID) {
+    return &SDOclientStub;
+}
+uint8_t CO_sendNMTcommand(CO_t *CO, uint8_t command, uint8_t nodeID) {
+    return 0;
+}
+void CO_errExit(char const *msg) {
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+/* Little endian host (as CO_SDO.c with CO_LITTLE_ENDIAN) */
+void CO_memcpySwap2(void *dest, const void *src) { memcpy(dest, src, 2); }
+void CO_memcpySwap4(void *dest, const void *src) { memcpy(dest, src, 4); }
+void CO_memcpySwap8(void *dest, const void *src) { memcpy(dest, src, 8); }
+}
+
+/* One SDO write of a drive initialisation */
+typedef struct {
+    uint16_t index;
+    uint8_t subIndex;
+    uint8_t length;
+    uint32_t value;
+} write_t;
+
+/* SDO writes of Drive::initPDOs with the default mappings (3 TPDOs, 4 RPDOs) */
+static std::vector<write_t> initPDOsWrites() {
+    const std::vector<std::vector<uint32_t>> tpdos = {{0x60410010}, {0x60640020, 0x606C0020}, {0x60770010}};
+    const std::vector<std::vector<uint32_t>> rpdos = {{0x60400010, 0x60FE0110}, {0x607A0020}, {0x60FF0020}, {0x60710010}};
+    std::vector<write_t> writes;
+    for (int t = 0; t < 2; t++) {
+        const std::vector<std::vector<uint32_t>> &pdos = (t == 0) ? tpdos : rpdos;
+        uint16_t comm = (t == 0) ? 0x1800 : 0x1400;
+        uint16_t map = (t == 0) ? 0x1A00 : 0x1600;
+        uint32_t cobBase = (t == 0) ? 0x180 : 0x200;
+        for (unsigned int n = 0; n < pdos.size(); n++) {
+            uint32_t COB_ID = cobBase + 0x100 * n + NODE_ID;
+            writes.push_back({(uint16_t)(comm + n), 1, 4, 0x80000000 + COB_ID});
+            writes.push_back({(uint16_t)(map + n), 0, 1, 0});
+            writes.push_back({(uint16_t)(comm + n), 2, 1, 0xFF});
+            for (unsigned int i = 0; i < pdos[n].size(); i++) {
+                writes.push_back({(uint16_t)(map + n), (uint8_t)(i + 1), 4, pdos[n][i]});
+            }
+            writes.push_back({(uint16_t)(map + n), 0, 1, (uint32_t)pdos[n].size()});
+            writes.push_back({(uint16_t)(comm + n), 1, 4, COB_ID});
+        }
+    }
+    return writes;
+}
+
+/* Former Drive::generate*ConfigSDO + sendSDOMessages path */
+__attribute__((noinline)) static int textWrites(const std::vector<write_t> &writes) {
+    std::vector<std::string> CANCommands;
+    std::stringstream sstream;
+    for (auto &w : writes) {
+        sstream << "[1] " << NODE_ID << " write 0x" << std::hex << w.index << " " << std::dec << (int)w.subIndex
+                << (w.length == 4 ? " u32 0x" : " u8 0x") << std::hex << w.value;
+        CANCommands.push_back(sstream.str());
+        sstream.str(std::string());
+    }
+    int successfulMessages = 0;
+    for (auto strCommand : CANCommands) {
+        char *SDO_Message = (char *)(strCommand.c_str());
+        char returnMessage[STRING_BUFFER_SIZE];
+        cancomm_socketFree(SDO_Message, returnMessage);
+        std::string retMsg = returnMessage;
+        if (retMsg.find("OK") != std::string::npos) {
+            successfulMessages++;
+        }
+    }
+    return successfulMessages - CANCommands.size();
+}
+
+/* sdoWrite<T> path (same conversion as in SDO.h) */
+__attribute__((noinline)) static int binaryWrites(const std::vector<write_t> &writes) {
+    int ret = 0;
+    for (auto &w : writes) {
+        uint8_t data[4];
+        uint32_t abortCode;
+        for (unsigned int i = 0; i < w.length; i++) {
+            data[i] = (uint8_t)(w.value >> (8 * i));
+        }
+        if (cancomm_sdoWrite(NODE_ID, w.index, w.subIndex, data, w.length, &abortCode) != 0 || abortCode != 0) {
+            ret--;
+        }
+    }
+    return ret;
+}
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = (argc > 1) ? atol(argv[1]) : 2000;
+    std::vector<write_t> writes = initPDOsWrites();
+    double t0, tText, tBinary;
+    long n;
+
+    COstub.SDOclient[0] = &SDOclientStub;
+
+    /* Both paths must issue the same transfers */
+    noTransfers = 0;
+    if (textWrites(writes) != 0 || noTransfers != (long)writes.size()) {
+        fprintf(stderr, "Text commands failed (%ld/%zu transfers)\n", noTransfers, writes.size());
+        return EXIT_FAILURE;
+    }
+    noTransfers = 0;
+    if (binaryWrites(writes) != 0 || noTransfers != (long)writes.size()) {
+        fprintf(stderr, "Binary writes failed (%ld/%zu transfers)\n", noTransfers, writes.size());
+        return EXIT_FAILURE;
+    }
+
+    t0 = now_s();
+    for (n = 0; n < iterations; n++) {
+        textWrites(writes);
+    }
+    tText = now_s() - t0;
+
+    t0 = now_s();
+    for (n = 0; n < iterations; n++) {
+        binaryWrites(writes);
+    }
+    tBinary = now_s() - t0;
+
+    printf("%zu SDO writes per Drive::initPDOs (transfers excluded)\n", writes.size());
+    printf("%-8s %14s %14s\n", "", "us per init", "ns per SDO");
+    printf("%-8s %14.2f %14.1f\n", "text", tText * 1e6 / iterations, tText * 1e9 / iterations / writes.size());
+    printf("%-8s %14.2f %14.1f\n", "binary", tBinary * 1e6 / iterations, tBinary * 1e9 / iterations / writes.size());
+    printf("speedup  %13.1fx\n", tText / tBinary);
+    return EXIT_SUCCESS;
+}